@@ -11,6 +11,7 @@ set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -D_SILENCE_CXX17_ADAPTOR_TYPEDEFS_DEPREC
 add_subdirectory(${PROJECT_SOURCE_DIR}/extern/fwenh/extern/glbinding)
 
 set(VISCOM_DO_PROFILING ON CACHE BOOL "Turn on profiling.")
+set(VISCOM_OGL_CALL_STATISTICS ON CACHE BOOL "Count OpenGL calls and check for errors periodically.")
 
 file(GLOB_RECURSE SHADER_FILES_ENH ${PROJECT_SOURCE_DIR}/extern/fwenh/resources/shader/*.*)
 list(FILTER SHADER_FILES_ENH EXCLUDE REGEX ".*\.gen$")
@@ -51,7 +52,42 @@ list(APPEND ENH_INCLUDE_DIRS
 list(APPEND ENH_LIBS glbinding)
 # list(APPEND ENH_LIBS glbinding glbinding-aux)
 list(APPEND COMPILE_TIME_DEFS $<$<CONFIG:DebugOpenGLCalls>:VISCOM_OGL_DEBUG_MSGS> GLFW_INCLUDE_NONE _SILENCE_CXX17_ADAPTOR_TYPEDEFS_DEPRECATION_WARNING)
+list(APPEND COMPILE_TIME_DEFS ENH_SHADER_DIRECTORY="${PROJECT_SOURCE_DIR}/extern/fwenh/resources/shader")
 
 if (VISCOM_DO_PROFILING)
     list(APPEND COMPILE_TIME_DEFS ENABLE_PROFILING)
 endif()
+
+if (VISCOM_OGL_CALL_STATISTICS)
+    list(APPEND COMPILE_TIME_DEFS ENABLE_GL_CALL_STATISTICS)
+endif()
+
+set(VISCOM_ENH_BUILD_TOOLS OFF CACHE BOOL "Build the headless command line tools of the enh classes (needs EGL).")
+
+# Adds the headless tools and the image difference test of the post-processing effects (enh_precision_test, needs
+# enable_testing() in the parent project). The core has no library target, so its sources, include directories and
+# libraries are passed in: enh_add_headless_tools(CORE_SOURCES ... CORE_INCLUDE_DIRS ... CORE_LIBS ...).
+function(enh_add_headless_tools)
+    if (NOT VISCOM_ENH_BUILD_TOOLS)
+        return()
+    endif()
+    cmake_parse_arguments(TOOLS "" "" "CORE_SOURCES;CORE_INCLUDE_DIRS;CORE_LIBS" ${ARGN})
+    find_package(OpenGL REQUIRED COMPONENTS EGL)
+
+    set(ENH_TOOLS_DIR ${PROJECT_SOURCE_DIR}/extern/fwenh/tools)
+    file(GLOB TOOLS_COMMON_FILES ${ENH_TOOLS_DIR}/common/*.h ${ENH_TOOLS_DIR}/common/*.cpp)
+    file(GLOB BENCHMARK_FILES ${ENH_TOOLS_DIR}/benchmark/*.h ${ENH_TOOLS_DIR}/benchmark/*.cpp)
+
+    file(GLOB REPLAY_FILES ${ENH_TOOLS_DIR}/replay/*.h ${ENH_TOOLS_DIR}/replay/*.cpp)
+    set(ENH_TESTS_DIR ${PROJECT_SOURCE_DIR}/extern/fwenh/tests)
+
+    add_executable(enh_benchmark ${BENCHMARK_FILES} ${TOOLS_COMMON_FILES} ${SRC_FILES_ENH} ${TOOLS_CORE_SOURCES})
+    add_executable(enh_replay ${REPLAY_FILES} ${TOOLS_COMMON_FILES} ${SRC_FILES_ENH} ${TOOLS_CORE_SOURCES})
+    add_executable(enh_precision_test ${ENH_TESTS_DIR}/PostProcessingPrecisionTest.cpp ${SRC_FILES_ENH} ${TOOLS_CORE_SOURCES})
+    add_test(NAME enh_precision_test COMMAND enh_precision_test ${ENH_TESTS_DIR}/reference)
+    foreach(TOOL enh_benchmark enh_replay enh_precision_test)
+        target_include_directories(${TOOL} PRIVATE ${ENH_INCLUDE_DIRS} ${TOOLS_CORE_INCLUDE_DIRS} ${ENH_TOOLS_DIR}/common)
+        target_compile_definitions(${TOOL} PRIVATE ${COMPILE_TIME_DEFS})
+        target_link_libraries(${TOOL} PRIVATE ${ENH_LIBS} ${TOOLS_CORE_LIBS} OpenGL::EGL)
+    endforeach()
+endfunction()
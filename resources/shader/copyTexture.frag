@@ -0,0 +1,10 @@
+#version 430 core
+
+uniform sampler2D sourceTex;
+
+in vec2 texCoord;
+out vec4 outputColor;
+
+void main() {
+    outputColor = texture(sourceTex, texCoord);
+}
@@ -0,0 +1,55 @@
+// Gathering of the near and far fields, expects the samplers cocTex, colorTex and colorMulCoCFarTex to be declared.
+
+// Holds the bokeh tap sets with 8, 24 and 48 taps consecutively, all sets cover the same radius of 6 * CoC pixels
+// (see DepthOfField::RecalcBokeh).
+layout(std140) uniform dofBokehBuffer
+{
+    vec4 bokehTaps[80];
+};
+
+// Selects the smallest tap set whose outer ring is not sparser than the one of the 48 tap set at the maximum CoC.
+int bokehTapCount(float coc)
+{
+    if (coc < 1.0f / 3.0f) return 8;
+    if (coc < 2.0f / 3.0f) return 24;
+    return 48;
+}
+
+int bokehFirstTap(int tapCount)
+{
+    if (tapCount == 8) return 0;
+    if (tapCount == 24) return 8;
+    return 32;
+}
+
+vec4 calcNear(vec2 texCoord, vec4 color, float cocNearBlurred, int tapCount, vec2 pixelSize)
+{
+    vec4 result = color;
+    int firstTap = bokehFirstTap(tapCount);
+
+    for (int i = 0; i < tapCount; i++) {
+        vec2 offset = cocNearBlurred * bokehTaps[firstTap + i].xy * pixelSize;
+        result += texture(colorTex, texCoord + offset);
+    }
+
+    return result / float(tapCount + 1);
+}
+
+vec4 calcFar(vec2 texCoord, ivec2 iTexCoord, float cocFar, int tapCount, vec2 pixelSize)
+{
+    vec4 result = texelFetch(colorMulCoCFarTex, iTexCoord, 0);
+    float weightsSum = 0.0;
+    int firstTap = bokehFirstTap(tapCount);
+
+    for (int i = 0; i < tapCount; i++) {
+        vec2 offset = clamp(cocFar, 0.0, 1.0) * bokehTaps[firstTap + i].xy * pixelSize;
+
+        float coc = clamp(texture(cocTex, texCoord + offset).y, 0.0, 1.0);
+        vec4 color = texture(colorMulCoCFarTex, texCoord + offset);
+
+        result += coc * color;
+        weightsSum += coc;
+    }
+
+    return result / weightsSum;
+}
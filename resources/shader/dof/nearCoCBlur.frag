@@ -6,20 +6,22 @@ in vec2 texCoord;
 
 layout(location = 0) out vec4 cocResult; // 2 channels
 
+// box filter over 13 texels with bilinear taps (see SeparableKernel::Box).
+#include "../gaussian_blur.glsl"
+
 void main()
 {
 #ifdef HORIZONTAL
-    const ivec2 direction = ivec2(1, 0);
+    vec2 offset = vec2(1.0 / textureSize(cocTex, 0).x, 0);
 #endif
 #ifdef VERTICAL
-    const ivec2 direction = ivec2(0, 1);
+    vec2 offset = vec2(0, 1.0 / textureSize(cocTex, 0).y);
 #endif
 
-    ivec2 iTexCoord = ivec2(texCoord * vec2(textureSize(cocTex, 0)));
-    cocResult.xy = texelFetch(cocTex, iTexCoord, 0).xy;
-    for (int i = -6; i <= 6; i++) {
-        ivec2 iCurrCoord = iTexCoord + i * direction;
-        cocResult.x += texelFetch(cocTex, iCurrCoord, 0).x;
+    cocResult.y = texelFetch(cocTex, ivec2(texCoord * vec2(textureSize(cocTex, 0))), 0).y;
+    cocResult.x = 0.0f;
+    for (int i = 0; i < NUM_TAPS; ++i) {
+        vec2 texOffset = blurTaps[i].y * offset;
+        cocResult.x += blurTaps[i].x * (texture(cocTex, texCoord + texOffset).x + texture(cocTex, texCoord - texOffset).x);
     }
-    cocResult.x /= 13.0f;
 }
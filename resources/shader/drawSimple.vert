@@ -1,6 +1,7 @@
 #version 330
 #extension GL_ARB_separate_shader_objects : require
 
+// quantized position, see SimpleVertex in SimpleMeshRenderer.cpp.
 layout(location = 0) in vec4 position;
 
 uniform mat4 vpMatrix;
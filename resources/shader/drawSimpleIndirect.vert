@@ -0,0 +1,34 @@
+#version 430
+#extension GL_ARB_shader_draw_parameters : require
+
+// quantized position, see SimpleVertex in SimpleMeshRenderer.cpp.
+layout(location = 0) in vec4 position;
+
+struct SimpleInstance
+{
+    mat4 modelMatrix;
+    vec4 color;
+    float pointSize;
+};
+
+layout(std430) buffer simpleInstanceBuffer
+{
+    SimpleInstance instances[];
+};
+
+uniform mat4 vpMatrix;
+
+layout(location = 0) out vec3 vPos;
+layout(location = 1) flat out vec4 vColor;
+
+void main()
+{
+    // the draw commands base instance points to the first instance of the commands shape.
+    SimpleInstance inst = instances[gl_BaseInstanceARB + gl_InstanceID];
+    vec4 posV4 = inst.modelMatrix * vec4(position.xyz, 1);
+    vPos = vec3(posV4);
+    vColor = inst.color;
+
+    gl_Position = vpMatrix * posV4;
+    gl_PointSize = inst.pointSize;
+}
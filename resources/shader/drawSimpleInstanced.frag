@@ -0,0 +1,11 @@
+#version 430
+
+layout(location = 0) in vec3 vPos;
+layout(location = 1) flat in vec4 vColor;
+
+layout(location = 0) out vec4 outputColor;
+
+void main()
+{
+    outputColor = vColor;
+}
@@ -1,17 +1,21 @@
-// blur algorithm from:
-// https://software.intel.com/en-us/blogs/2014/07/15/an-investigation-of-fast-real-time-gpu-based-image-blur-algorithms
-const float weights[2] = float[] (0.44908, 0.05092);
-const float offsets[2] = float[] (0.53805, 2.06278);
+// Separable blur with bilinear taps, the weights and offsets (in texels) are generated by SeparableKernel
+// and NUM_TAPS selects the permutation. Each tap combines two texels by linear filtering and is sampled
+// on both sides of the center, the center texel is split between the first taps.
+layout(std140) uniform blurKernelBuffer
+{
+    // (weight, offset, 0, 0)
+    vec4 blurTaps[NUM_TAPS];
+};
 
-vec3 gaussianBlur(vec2 p, vec2 offset, sampler2D blurTexture)
+vec3 gaussianBlur(vec2 p, vec2 texelOffset, sampler2D blurTexture)
 {
     vec3 result = vec3(0.0f);
 
-    for (int i = 0; i < 2; ++i) {
-        vec2 texOffset = offsets[i] * offset;
+    for (int i = 0; i < NUM_TAPS; ++i) {
+        vec2 texOffset = blurTaps[i].y * texelOffset;
         vec3 color = texture(blurTexture, p + texOffset).xyz +
             texture(blurTexture, p - texOffset).xyz;
-        result += weights[i] * color;
+        result += blurTaps[i].x * color;
     }
 
     return result;
@@ -0,0 +1,12 @@
+#version 330 core
+
+// Draws a triangle covering the viewport without vertex attributes, see ScreenQuad::Draw().
+
+out vec2 texCoord;
+
+void main()
+{
+    vec2 position = vec2(float((gl_VertexID & 1) << 2) - 1.0, float((gl_VertexID & 2) << 1) - 1.0);
+    texCoord = 0.5 * position + 0.5;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
@@ -2,7 +2,6 @@
 #version 330 core
 
 uniform sampler2D sourceTex;
-uniform float bloomWidth;
 
 in vec2 texCoord;
 out vec4 outColor;
@@ -11,10 +10,10 @@ out vec4 outColor;
 
 void main() {
 #ifdef HORIZONTAL
-    vec2 offset = vec2(bloomWidth/textureSize(sourceTex, 0).x, 0);
+    vec2 offset = vec2(1.0 / textureSize(sourceTex, 0).x, 0);
 #endif
 #ifdef VERTICAL
-    vec2 offset = vec2(0, bloomWidth/textureSize(sourceTex, 0).y);
+    vec2 offset = vec2(0, 1.0 / textureSize(sourceTex, 0).y);
 #endif
 
     vec3 blurColor = gaussianBlur(texCoord, offset, sourceTex);
@@ -2,6 +2,11 @@
 
 #include "../bicubic_sampling.glsl"
 
+#ifdef TONEMAP
+// the bloom is tone-mapped in the same pass, see BloomEffect::SetTonemapping.
+#include "filmicCurve.glsl"
+#endif
+
 uniform sampler2D sourceTex;
 uniform sampler2D blurTex[3];
 uniform float bloomIntensity;
@@ -28,8 +33,16 @@ void main() {
 
     outColor = originalColor;
     outColor.rgb -= glare;
+#ifdef DUAL_FILTER
+    outColor.rgb += bloomIntensity * sampleBiCubic(blurTex[0], texCoord).rgb;
+#else
     for (int i = 0; i < 3; i++) {
         vec4 passSmple = sampleBiCubic(blurTex[i], texCoord);
         outColor.rgb += bloomIntensity * w[i] * passSmple.rgb / 12.0;
     }
+#endif
+
+#ifdef TONEMAP
+    outColor.rgb = filmicTonemap(outColor.rgb);
+#endif
 }
@@ -0,0 +1,29 @@
+#version 330 core
+
+uniform sampler2D sourceTex;
+uniform float bloomWidth;
+
+in vec2 texCoord;
+
+layout(location = 0) out vec4 dsResult;
+
+vec3 fetchSource(vec2 coord) {
+    vec3 color = texture(sourceTex, coord).rgb;
+#ifdef GLARE
+    color = max(color - vec3(1.0), 0.0);
+#endif
+    return color;
+}
+
+// Dual filter down sampling, the diagonal taps each average a 2x2 texel block of the source.
+void main() {
+    vec2 offset = bloomWidth / vec2(textureSize(sourceTex, 0));
+
+    vec3 result = 4.0 * fetchSource(texCoord);
+    result += fetchSource(texCoord + vec2(-offset.x, -offset.y));
+    result += fetchSource(texCoord + vec2( offset.x, -offset.y));
+    result += fetchSource(texCoord + vec2(-offset.x,  offset.y));
+    result += fetchSource(texCoord + vec2( offset.x,  offset.y));
+
+    dsResult = vec4(result / 8.0, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+uniform sampler2D sourceTex;
+uniform sampler2D addTex;
+uniform float bloomWidth;
+
+in vec2 texCoord;
+
+layout(location = 0) out vec4 usResult;
+
+// Dual filter up sampling (tent filter) of the next smaller level added to the down sampled level of this size.
+void main() {
+    vec2 offset = bloomWidth / vec2(textureSize(sourceTex, 0));
+
+    vec3 result = texture(sourceTex, texCoord + vec2(-offset.x, 0.0)).rgb;
+    result += texture(sourceTex, texCoord + vec2( offset.x, 0.0)).rgb;
+    result += texture(sourceTex, texCoord + vec2(0.0, -offset.y)).rgb;
+    result += texture(sourceTex, texCoord + vec2(0.0,  offset.y)).rgb;
+    result += 2.0 * texture(sourceTex, texCoord + 0.5 * vec2(-offset.x, -offset.y)).rgb;
+    result += 2.0 * texture(sourceTex, texCoord + 0.5 * vec2( offset.x, -offset.y)).rgb;
+    result += 2.0 * texture(sourceTex, texCoord + 0.5 * vec2(-offset.x,  offset.y)).rgb;
+    result += 2.0 * texture(sourceTex, texCoord + 0.5 * vec2( offset.x,  offset.y)).rgb;
+
+    usResult = vec4(result / 12.0 + texelFetch(addTex, ivec2(gl_FragCoord.xy), 0).rgb, 1.0);
+}
@@ -1,22 +1,6 @@
 #version 430 core
 
-struct FilmicParams
-{
-    float sStrength;
-    float linStrength;
-    float linAngle;
-    float toeStrength;
-    float toeNumerator;
-    float toeDenominator;
-    float white;
-    float exposure;
-};
-
-
-layout(std140) uniform filmicBuffer
-{
-    FilmicParams filmicParams;
-};
+#include "filmicCurve.glsl"
 
 uniform sampler2D sourceTex;
 
@@ -43,20 +27,7 @@ vec3 yuv2Rgb(vec3 c)
     return result;
 }
 
-vec3 Uncharted2Tonemap(vec3 x)
-{
-    vec3 Ax = filmicParams.sStrength*x;
-    float toeAngle = filmicParams.toeNumerator / filmicParams.toeDenominator;
-    return ((x*(Ax + filmicParams.linAngle*filmicParams.linStrength) + filmicParams.toeStrength*filmicParams.toeNumerator)
-        / (x*(Ax + filmicParams.linStrength) + filmicParams.toeStrength*filmicParams.toeDenominator)) - toeAngle;
-}
-
 void main() {
     vec4 rgbaVal = texture(sourceTex, texCoord);
-
-    vec3 curr = 2.0f * Uncharted2Tonemap(filmicParams.exposure*rgbaVal.rgb);
-    vec3 whiteScale = 1.0f / Uncharted2Tonemap(vec3(filmicParams.white));
-    vec3 color = curr*whiteScale;
-
-    outputColor = vec4(color, rgbaVal.a);
+    outputColor = vec4(filmicTonemap(rgbaVal.rgb), rgbaVal.a);
 }
@@ -0,0 +1,63 @@
+// filmic curve shared by filmic.frag and the fused bloom tone-mapping in combineBloom.frag.
+
+struct FilmicParams
+{
+    float sStrength;
+    float linStrength;
+    float linAngle;
+    float toeStrength;
+    float toeNumerator;
+    float toeDenominator;
+    float white;
+    float exposure;
+};
+
+
+layout(std140) uniform filmicBuffer
+{
+    FilmicParams filmicParams;
+};
+
+#ifdef AUTO_EXPOSURE
+// written by adaptExposure.comp.
+layout(std430) buffer exposureBuffer
+{
+    float averageLuminance;
+    float adaptedLuminance;
+    float exposure;
+} autoExposure;
+#endif
+
+#ifdef LUT
+// the LUT holds the curve for log2 shaped exposed colors, see FilmicTMOperator::UpdateLUT.
+uniform sampler3D lutTex;
+#define LUT_MIN_LOG -12.0
+#define LUT_MAX_LOG 6.0
+#endif
+
+vec3 Uncharted2Tonemap(vec3 x)
+{
+    vec3 Ax = filmicParams.sStrength*x;
+    float toeAngle = filmicParams.toeNumerator / filmicParams.toeDenominator;
+    return ((x*(Ax + filmicParams.linAngle*filmicParams.linStrength) + filmicParams.toeStrength*filmicParams.toeNumerator)
+        / (x*(Ax + filmicParams.linStrength) + filmicParams.toeStrength*filmicParams.toeDenominator)) - toeAngle;
+}
+
+vec3 filmicTonemap(vec3 hdrColor)
+{
+    float exposure = filmicParams.exposure;
+#ifdef AUTO_EXPOSURE
+    // the manual exposure acts as exposure compensation.
+    exposure *= autoExposure.exposure;
+#endif
+
+#ifdef LUT
+    vec3 lutCoord = clamp((log2(exposure*hdrColor) - LUT_MIN_LOG) / (LUT_MAX_LOG - LUT_MIN_LOG), 0.0, 1.0);
+    float lutSize = float(textureSize(lutTex, 0).x);
+    return texture(lutTex, lutCoord * ((lutSize - 1.0) / lutSize) + 0.5 / lutSize).rgb;
+#else
+    vec3 curr = 2.0f * Uncharted2Tonemap(exposure*hdrColor);
+    vec3 whiteScale = 1.0f / Uncharted2Tonemap(vec3(filmicParams.white));
+    return curr*whiteScale;
+#endif
+}
@@ -12,9 +12,14 @@
 #include <glbinding/gl/gl.h>
 #include <glbinding/Binding.h>
 #include <glbinding/Meta.h>
+#include "enh/gfx/gl/GLCallStatistics.h"
 #include "enh/gfx/gl/GLTexture.h"
+#include "enh/gfx/gl/ProgramBinaryCache.h"
+#include "enh/core/profiler.h"
 
 void ecb(const glbinding::FunctionCall & call) {
+    ENH_PROFILE_COUNT(GL_CALLS, 1);
+
     std::stringstream callOut;
     callOut << call.function->name() << "(";
     for (unsigned i = 0; i < call.parameters.size(); ++i) {
@@ -41,8 +46,30 @@ void ecb(const glbinding::FunctionCall & call) {
 
 namespace viscom::enh {
 
+    /** The directory the program binaries are cached in. */
+    constexpr const char* PROGRAM_BINARY_DIRECTORY = "shader_cache";
+#ifdef ENH_SHADER_DIRECTORY
+    /** The default directory of the enh shaders, set by the build. */
+    constexpr const char* SHADER_DIRECTORY = ENH_SHADER_DIRECTORY;
+#else
+    constexpr const char* SHADER_DIRECTORY = "extern/fwenh/resources/shader";
+#endif
+
     ApplicationNodeBase::ApplicationNodeBase(ApplicationNodeInternal* appNode) :
-        viscom::ApplicationNodeBase{ appNode }
+        ApplicationNodeBase{ appNode, false }
+    {
+    }
+
+    /**
+     *  Creates the node.
+     *  @param appNode the internal node of the core.
+     *  @param generateSimpleMeshes whether the simple meshes are generated instead of loaded from the core resources,
+     *      the enh classes use no other part of the core node, so headless hosts may pass no internal node then.
+     */
+    ApplicationNodeBase::ApplicationNodeBase(ApplicationNodeInternal* appNode, bool generateSimpleMeshes) :
+        viscom::ApplicationNodeBase{ appNode },
+        renderTargetPool_{ &glStateCache_ },
+        shaderDirectory_{ SHADER_DIRECTORY }
     {
         {
             using namespace glbinding;
@@ -51,10 +78,12 @@ namespace viscom::enh {
 #ifdef VISCOM_OGL_DEBUG_MSGS
             setCallbackMaskExcept(CallbackMask::After | CallbackMask::ParametersAndReturnValue, { "glGetError" });
             setAfterCallback(ecb);
+#elif defined(ENABLE_GL_CALL_STATISTICS)
+            GLCallStatistics::Get().Install();
 #endif // VISCOM_OGL_DEBUG_MSGS
         }
 
-        simpleMeshes_ = std::make_unique<SimpleMeshRenderer>(this);
+        simpleMeshes_ = std::make_unique<SimpleMeshRenderer>(this, generateSimpleMeshes);
 
         cubicWeightsTexture_ = std::make_unique<GLTexture>(256, TextureDescriptor{ 12, gl::GL_RGB32F, gl::GL_RGB, gl::GL_FLOAT });
 
@@ -80,6 +109,41 @@ namespace viscom::enh {
         cubicWeightsTexture_->SampleWrapRepeat();
     }
 
-    ApplicationNodeBase::~ApplicationNodeBase() = default;
+    /**
+     *  Starts a new frame of the enh classes, classes overriding UpdateFrame() need to call it before rendering.
+     *  @param currentTime the current time in seconds.
+     *  @param elapsedTime the time the last frame took in seconds.
+     */
+    void ApplicationNodeBase::UpdateFrame(double currentTime, double elapsedTime)
+    {
+        viscom::ApplicationNodeBase::UpdateFrame(currentTime, elapsedTime);
+        renderTargetPool_.EndFrame();
+        glStateCache_.EndFrame();
+#ifdef ENABLE_GL_CALL_STATISTICS
+        GLCallStatistics::Get().EndFrame();
+#endif
+        // all programs of the effects created at startup are linked by now.
+        if (!programBinaryCacheLogged_ && programBinaryCache_) {
+            LOG(INFO) << "Program binary cache: " << programBinaryCache_->GetNumHits() << " hits, " << programBinaryCache_->GetNumMisses()
+                << " misses, " << programBinaryCache_->GetNumRejected() << " rejected.";
+            programBinaryCacheLogged_ = true;
+        }
+        ENH_PROFILE_BEGIN_FRAME();
+    }
+
+    /** Returns the cache of linked program binaries, it is created on first use so nodes not using it do not query the driver. */
+    ProgramBinaryCache* ApplicationNodeBase::GetProgramBinaryCache()
+    {
+        if (!programBinaryCache_) programBinaryCache_ = std::make_unique<ProgramBinaryCache>(PROGRAM_BINARY_DIRECTORY);
+        return programBinaryCache_.get();
+    }
+
+    ApplicationNodeBase::~ApplicationNodeBase()
+    {
+#ifdef ENABLE_PROFILING
+        // the queries need to be deleted while the context exists.
+        Profiler::Get().ReleaseQueries();
+#endif
+    }
 
 }
@@ -10,11 +10,14 @@
 
 #include "core/app/ApplicationNodeBase.h"
 #include "enh/gfx/gl/ShaderBufferBindingPoints.h"
+#include "enh/gfx/gl/GLStateCache.h"
+#include "enh/gfx/gl/RenderTargetPool.h"
 
 namespace viscom::enh {
 
     class SimpleMeshRenderer;
     class GLTexture;
+    class ProgramBinaryCache;
 
     class ApplicationNodeBase : public viscom::ApplicationNodeBase
     {
@@ -26,16 +29,39 @@ namespace viscom::enh {
         ApplicationNodeBase& operator=(ApplicationNodeBase&&) = delete;
         virtual ~ApplicationNodeBase() override;
 
+        virtual void UpdateFrame(double currentTime, double elapsedTime) override;
+
         ShaderBufferBindingPoints* GetUBOBindingPoints() { return &uniformBindingPoints_; }
         ShaderBufferBindingPoints* GetSSBOBindingPoints() { return &shaderStorageBindingPoints_; }
+        GLStateCache* GetGLStateCache() { return &glStateCache_; }
+        RenderTargetPool* GetRenderTargetPool() { return &renderTargetPool_; }
         const SimpleMeshRenderer* GetSimpleMeshes() const { return simpleMeshes_.get(); }
+        SimpleMeshRenderer* GetSimpleMeshes() { return simpleMeshes_.get(); }
         const GLTexture& GetCubicWeightsTexture() const { return *cubicWeightsTexture_; }
+        ProgramBinaryCache* GetProgramBinaryCache();
+        /** Returns the directory the enh shaders are loaded from. */
+        const std::string& GetShaderDirectory() const { return shaderDirectory_; }
+        /** Sets the directory the enh shaders are loaded from, programs created before keep their shaders. */
+        void SetShaderDirectory(const std::string& shaderDirectory) { shaderDirectory_ = shaderDirectory; }
+
+    protected:
+        ApplicationNodeBase(ApplicationNodeInternal* appNode, bool generateSimpleMeshes);
 
     private:
         /** Holds the uniform binding points. */
         ShaderBufferBindingPoints uniformBindingPoints_;
         /** Holds the shader storage buffer object binding points. */
         ShaderBufferBindingPoints shaderStorageBindingPoints_;
+        /** Holds the OpenGL state cache used by the enh classes. */
+        GLStateCache glStateCache_;
+        /** Holds the pool of transient render targets used by the post-processing effects. */
+        RenderTargetPool renderTargetPool_;
+        /** Holds the cache of linked program binaries, created on first use. */
+        std::unique_ptr<ProgramBinaryCache> programBinaryCache_;
+        /** Holds whether the statistics of the program binary cache were logged. */
+        bool programBinaryCacheLogged_ = false;
+        /** Holds the directory the enh shaders are loaded from. */
+        std::string shaderDirectory_;
         /** Holds the simple meshes renderer. */
         std::unique_ptr<SimpleMeshRenderer> simpleMeshes_;
         /** Holds the texture for cubic filtering weights. */
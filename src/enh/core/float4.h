@@ -0,0 +1,98 @@
+/**
+ * @file   float4.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  A four component float vector mapped to SSE registers for the CPU image processing.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENH_FLOAT4_SSE
+#include <immintrin.h>
+#endif
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Four floats (usually an RGBA pixel) processed with SSE if available.
+     *
+     *  The scalar fallback has the same interface, so code using it compiles on all targets. Loads and stores do not
+     *  need to be aligned.
+     */
+    struct float4
+    {
+#ifdef ENH_FLOAT4_SSE
+        __m128 v_;
+
+        float4() : v_{ _mm_setzero_ps() } {}
+        explicit float4(__m128 v) : v_{ v } {}
+        explicit float4(float s) : v_{ _mm_set1_ps(s) } {}
+        float4(float x, float y, float z, float w) : v_{ _mm_setr_ps(x, y, z, w) } {}
+
+        static float4 Load(const float* p) { return float4{ _mm_loadu_ps(p) }; }
+        void Store(float* p) const { _mm_storeu_ps(p, v_); }
+
+        float4 operator+(const float4& rhs) const { return float4{ _mm_add_ps(v_, rhs.v_) }; }
+        float4 operator-(const float4& rhs) const { return float4{ _mm_sub_ps(v_, rhs.v_) }; }
+        float4 operator*(const float4& rhs) const { return float4{ _mm_mul_ps(v_, rhs.v_) }; }
+        float4 operator/(const float4& rhs) const { return float4{ _mm_div_ps(v_, rhs.v_) }; }
+        float4 operator*(float s) const { return float4{ _mm_mul_ps(v_, _mm_set1_ps(s)) }; }
+
+        friend float4 Min(const float4& a, const float4& b) { return float4{ _mm_min_ps(a.v_, b.v_) }; }
+        friend float4 Max(const float4& a, const float4& b) { return float4{ _mm_max_ps(a.v_, b.v_) }; }
+        friend float4 Abs(const float4& a) { return float4{ _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v_) }; }
+        /** Returns a with the w component taken from b. */
+        friend float4 WithW(const float4& a, const float4& b)
+        {
+            return float4{ _mm_shuffle_ps(a.v_, _mm_shuffle_ps(a.v_, b.v_, _MM_SHUFFLE(3, 3, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0)) };
+        }
+
+        float operator[](int i) const { alignas(16) float f[4]; _mm_store_ps(f, v_); return f[i]; }
+        float HorizontalMax() const
+        {
+            auto m = _mm_max_ps(v_, _mm_shuffle_ps(v_, v_, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtss_f32(_mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+        float HorizontalSum() const
+        {
+            auto s = _mm_add_ps(v_, _mm_shuffle_ps(v_, v_, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtss_f32(_mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+#else
+        float v_[4];
+
+        float4() : v_{ 0.0f, 0.0f, 0.0f, 0.0f } {}
+        explicit float4(float s) : v_{ s, s, s, s } {}
+        float4(float x, float y, float z, float w) : v_{ x, y, z, w } {}
+
+        static float4 Load(const float* p) { return float4{ p[0], p[1], p[2], p[3] }; }
+        void Store(float* p) const { std::copy(v_, v_ + 4, p); }
+
+        float4 operator+(const float4& rhs) const { return float4{ v_[0] + rhs.v_[0], v_[1] + rhs.v_[1], v_[2] + rhs.v_[2], v_[3] + rhs.v_[3] }; }
+        float4 operator-(const float4& rhs) const { return float4{ v_[0] - rhs.v_[0], v_[1] - rhs.v_[1], v_[2] - rhs.v_[2], v_[3] - rhs.v_[3] }; }
+        float4 operator*(const float4& rhs) const { return float4{ v_[0] * rhs.v_[0], v_[1] * rhs.v_[1], v_[2] * rhs.v_[2], v_[3] * rhs.v_[3] }; }
+        float4 operator/(const float4& rhs) const { return float4{ v_[0] / rhs.v_[0], v_[1] / rhs.v_[1], v_[2] / rhs.v_[2], v_[3] / rhs.v_[3] }; }
+        float4 operator*(float s) const { return float4{ v_[0] * s, v_[1] * s, v_[2] * s, v_[3] * s }; }
+
+        friend float4 Min(const float4& a, const float4& b) { return float4{ std::min(a.v_[0], b.v_[0]), std::min(a.v_[1], b.v_[1]), std::min(a.v_[2], b.v_[2]), std::min(a.v_[3], b.v_[3]) }; }
+        friend float4 Max(const float4& a, const float4& b) { return float4{ std::max(a.v_[0], b.v_[0]), std::max(a.v_[1], b.v_[1]), std::max(a.v_[2], b.v_[2]), std::max(a.v_[3], b.v_[3]) }; }
+        friend float4 Abs(const float4& a) { return float4{ std::abs(a.v_[0]), std::abs(a.v_[1]), std::abs(a.v_[2]), std::abs(a.v_[3]) }; }
+        /** Returns a with the w component taken from b. */
+        friend float4 WithW(const float4& a, const float4& b) { return float4{ a.v_[0], a.v_[1], a.v_[2], b.v_[3] }; }
+
+        float operator[](int i) const { return v_[i]; }
+        float HorizontalMax() const { return std::max(std::max(v_[0], v_[1]), std::max(v_[2], v_[3])); }
+        float HorizontalSum() const { return v_[0] + v_[1] + v_[2] + v_[3]; }
+#endif
+
+        float4& operator+=(const float4& rhs) { return *this = *this + rhs; }
+    };
+
+    /** Returns a + t * (b - a). */
+    inline float4 Mix(const float4& a, const float4& b, float t) { return a + (b - a) * t; }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file   json_helper.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of helper functions for writing JSON files.
+ */
+
+#include "json_helper.h"
+#include <iomanip>
+
+namespace viscom::enh {
+
+    /**
+     *  Writes a string as JSON string. Quotes, backslashes and control characters are escaped, other characters
+     *  (including UTF-8 sequences) are written unchanged.
+     *  @param out the stream to write to.
+     *  @param str the string to write.
+     */
+    void WriteJSONString(std::ostream& out, const std::string& str)
+    {
+        out << '"';
+        for (auto c : str) {
+            switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\b': out << "\\b"; break;
+            case '\f': out << "\\f"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    auto flags = out.flags();
+                    auto fill = out.fill('0');
+                    out << "\\u" << std::hex << std::setw(4) << static_cast<int>(c);
+                    out.fill(fill);
+                    out.flags(flags);
+                }
+                else out << c;
+                break;
+            }
+        }
+        out << '"';
+    }
+}
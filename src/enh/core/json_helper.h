@@ -0,0 +1,17 @@
+/**
+ * @file   json_helper.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of helper functions for writing JSON files.
+ */
+
+#pragma once
+
+#include <ostream>
+#include <string>
+
+namespace viscom::enh {
+
+    void WriteJSONString(std::ostream& out, const std::string& str);
+}
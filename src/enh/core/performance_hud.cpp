@@ -0,0 +1,189 @@
+/**
+ * @file   performance_hud.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the performance overlay.
+ */
+
+#include "performance_hud.h"
+
+#ifdef ENABLE_PROFILING
+
+#include "profiler.h"
+#include "enh/gfx/gl/GLCallStatistics.h"
+#include "enh/gfx/gl/GLStateCache.h"
+#include "enh/gfx/gl/ProgramBinaryCache.h"
+#include "enh/gfx/gl/RenderTargetPool.h"
+#include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace viscom::enh {
+
+    namespace {
+        constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+    }
+
+    void PerformanceHUD::History::Add(float value)
+    {
+        values_[nextValue_] = value;
+        nextValue_ = (nextValue_ + 1) % HISTORY_SIZE;
+    }
+
+    float PerformanceHUD::History::GetAverage() const
+    {
+        auto sum = 0.0f;
+        for (auto value : values_) sum += value;
+        return sum / static_cast<float>(HISTORY_SIZE);
+    }
+
+    float PerformanceHUD::History::GetMax() const
+    {
+        return *std::max_element(values_.begin(), values_.end());
+    }
+
+    /**
+     *  Plots the history as graph with the last value and the average as overlay.
+     *  @param label the label of the graph.
+     *  @param unit the unit shown in the overlay.
+     */
+    void PerformanceHUD::History::Plot(const char* label, const char* unit) const
+    {
+        std::array<char, 64> overlay;
+        auto last = values_[(nextValue_ + HISTORY_SIZE - 1) % HISTORY_SIZE];
+        std::snprintf(overlay.data(), overlay.size(), "%.2f %s (avg %.2f)", last, unit, GetAverage());
+        ImGui::PlotLines(label, values_.data(), static_cast<int>(HISTORY_SIZE), static_cast<int>(nextValue_), overlay.data(),
+            0.0f, std::max(GetMax() * 1.1f, 1e-3f), ImVec2(0.0f, 60.0f));
+    }
+
+    /**
+     *  Adds the counters of the last frame to the graphs.
+     *  @param elapsedTime the time the last frame took in seconds.
+     */
+    void PerformanceHUD::Update(double elapsedTime)
+    {
+        const auto& profiler = Profiler::Get();
+        auto mbPerSecond = [elapsedTime](std::size_t bytes) {
+            return elapsedTime > 0.0 ? static_cast<float>(static_cast<double>(bytes) / BYTES_PER_MB / elapsedTime) : 0.0f;
+        };
+
+        frameTimes_.Add(static_cast<float>(elapsedTime * 1000.0));
+        glCalls_.Add(static_cast<float>(profiler.GetLastFrameCounter(Profiler::FrameCounter::GL_CALLS)));
+        uploadBandwidth_.Add(mbPerSecond(profiler.GetLastFrameCounter(Profiler::FrameCounter::UPLOADED_BYTES)));
+        downloadBandwidth_.Add(mbPerSecond(profiler.GetLastFrameCounter(Profiler::FrameCounter::DOWNLOADED_BYTES)));
+    }
+
+    /**
+     *  Draws the overlay window.
+     *  @param showHUD whether the window is shown, set to false when the window is closed.
+     */
+    void PerformanceHUD::Draw(bool& showHUD) const
+    {
+        if (!showHUD) return;
+
+        const auto& profiler = Profiler::Get();
+        if (ImGui::Begin("Performance", &showHUD, ImGuiWindowFlags_AlwaysAutoResize)) {
+            frameTimes_.Plot("Frame Time", "ms");
+            glCalls_.Plot("GL Calls", "calls");
+            uploadBandwidth_.Plot("Upload", "MB/s");
+            downloadBandwidth_.Plot("Readback", "MB/s");
+
+            ImGui::Separator();
+            ImGui::Text("Texture Memory: %.2f MB", static_cast<double>(profiler.GetMemory(Profiler::MemoryCounter::TEXTURES)) / BYTES_PER_MB);
+            ImGui::Text("Buffer Memory: %.2f MB", static_cast<double>(profiler.GetMemory(Profiler::MemoryCounter::BUFFERS)) / BYTES_PER_MB);
+            if (renderTargetPool_) {
+                ImGui::Text("Render Target Pool: %.2f MB (%u targets)", static_cast<double>(renderTargetPool_->GetMemorySize()) / BYTES_PER_MB,
+                    static_cast<unsigned int>(renderTargetPool_->GetNumTargets()));
+            }
+            if (stateCache_) {
+                const auto& statistics = stateCache_->GetLastFrameStatistics();
+                ImGui::Text("State Cache: %u issued, %u elided calls", static_cast<unsigned int>(statistics.issuedCalls_),
+                    static_cast<unsigned int>(statistics.elidedCalls_));
+            }
+            if (programBinaryCache_) {
+                ImGui::Text("Program Binaries: %u hits, %u misses, %u rejected", static_cast<unsigned int>(programBinaryCache_->GetNumHits()),
+                    static_cast<unsigned int>(programBinaryCache_->GetNumMisses()), static_cast<unsigned int>(programBinaryCache_->GetNumRejected()));
+            }
+
+            ImGui::Separator();
+            if (ImGui::TreeNodeEx("GPU Zones", ImGuiTreeNodeFlags_DefaultOpen)) {
+                DrawZones(true);
+                ImGui::Text("Dropped GPU Frames: %u", static_cast<unsigned int>(profiler.GetDroppedGPUFrames()));
+                ImGui::Text("Dropped GPU Zones: %u", static_cast<unsigned int>(profiler.GetDroppedGPUZones()));
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("CPU Zones")) {
+                DrawZones(false);
+                ImGui::TreePop();
+            }
+            if (ImGui::TreeNode("GL Functions")) {
+                DrawGLFunctions();
+                ImGui::TreePop();
+            }
+        }
+        ImGui::End();
+    }
+
+    /**
+     *  Draws a table with the times of the zones of one type, each with a bar showing its share of the frame time.
+     *  @param gpuZones whether to draw the GPU or the CPU zones.
+     */
+    void PerformanceHUD::DrawZones(bool gpuZones) const
+    {
+        const auto& profiler = Profiler::Get();
+        auto type = gpuZones ? Profiler::ZoneType::GPU : Profiler::ZoneType::CPU;
+        auto frameTime = std::max(frameTimes_.GetAverage(), 1e-3f);
+
+        ImGui::Columns(5, nullptr, false);
+        ImGui::Text("Zone"); ImGui::NextColumn();
+        ImGui::Text("Last [ms]"); ImGui::NextColumn();
+        ImGui::Text("Avg [ms]"); ImGui::NextColumn();
+        ImGui::Text("95%% [ms]"); ImGui::NextColumn();
+        ImGui::Text("Frame Share"); ImGui::NextColumn();
+        for (std::size_t i = 0; i < profiler.GetNumZones(); ++i) {
+            const auto& zone = profiler.GetZone(i);
+            if (zone.GetType() != type || zone.GetNumSamples() == 0) continue;
+
+            auto average = zone.GetAverage();
+            ImGui::TextUnformatted(zone.GetName().c_str()); ImGui::NextColumn();
+            ImGui::Text("%.3f", zone.GetLast()); ImGui::NextColumn();
+            ImGui::Text("%.3f", average); ImGui::NextColumn();
+            ImGui::Text("%.3f", zone.GetPercentile(95.0)); ImGui::NextColumn();
+            ImGui::ProgressBar(std::min(static_cast<float>(average) / frameTime, 1.0f), ImVec2(-1.0f, 0.0f)); ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
+
+    /** Draws the GL functions called most in the last frame. */
+    void PerformanceHUD::DrawGLFunctions() const
+    {
+#ifdef ENABLE_GL_CALL_STATISTICS
+        const auto& statistics = GLCallStatistics::Get();
+        std::array<std::size_t, NUM_TOP_GL_FUNCTIONS> topFunctions;
+        std::size_t numTopFunctions = 0;
+        for (std::size_t i = 0; i < statistics.GetNumFunctions(); ++i) {
+            auto calls = statistics.GetLastFrameCalls(i);
+            if (calls == 0) continue;
+
+            // insertion into the sorted list of the most called functions.
+            auto pos = numTopFunctions;
+            while (pos > 0 && statistics.GetLastFrameCalls(topFunctions[pos - 1]) < calls) {
+                if (pos < NUM_TOP_GL_FUNCTIONS) topFunctions[pos] = topFunctions[pos - 1];
+                pos -= 1;
+            }
+            if (pos < NUM_TOP_GL_FUNCTIONS) topFunctions[pos] = i;
+            numTopFunctions = std::min(numTopFunctions + 1, NUM_TOP_GL_FUNCTIONS);
+        }
+
+        ImGui::Text("Errors: %u", static_cast<unsigned int>(statistics.GetNumErrors()));
+        for (std::size_t i = 0; i < numTopFunctions; ++i) {
+            ImGui::Text("%6u %s", static_cast<unsigned int>(statistics.GetLastFrameCalls(topFunctions[i])), statistics.GetFunctionName(topFunctions[i]));
+        }
+#else
+        ImGui::TextUnformatted("Enable VISCOM_OGL_CALL_STATISTICS for per function counts.");
+#endif
+    }
+}
+
+#endif
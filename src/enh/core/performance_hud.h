@@ -0,0 +1,84 @@
+/**
+ * @file   performance_hud.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the performance overlay.
+ */
+
+#pragma once
+
+#ifdef ENABLE_PROFILING
+
+#include <array>
+#include <cstddef>
+
+namespace viscom::enh {
+
+    class GLStateCache;
+    class ProgramBinaryCache;
+    class RenderTargetPool;
+
+    /**
+     * @brief  ImGui overlay showing the data of the profiler.
+     *
+     *  Shows graphs of the frame time, GL calls and upload/readback bandwidth, the times of all profiler zones, the
+     *  allocated texture, buffer and render target memory, the calls issued and elided by the state cache in the
+     *  last frame and the hits and misses of the program binary cache. With the GL call statistics the most called functions are listed. The history is kept in
+     *  preallocated ring buffers and drawing does not allocate, so the overlay does not distort the numbers it shows.
+     *  Call Update() once per frame after enh::ApplicationNodeBase::UpdateFrame() and Draw() in the GUI pass.
+     */
+    class PerformanceHUD final
+    {
+    public:
+        /** The number of frames shown in the graphs. */
+        static constexpr std::size_t HISTORY_SIZE = 256;
+
+        explicit PerformanceHUD(const RenderTargetPool* renderTargetPool = nullptr, const GLStateCache* stateCache = nullptr,
+            const ProgramBinaryCache* programBinaryCache = nullptr) :
+            renderTargetPool_{ renderTargetPool }, stateCache_{ stateCache }, programBinaryCache_{ programBinaryCache } {}
+
+        void Update(double elapsedTime);
+        void Draw(bool& showHUD) const;
+
+    private:
+        /** The values of a graph as ring buffer. */
+        class History
+        {
+        public:
+            void Add(float value);
+            float GetAverage() const;
+            float GetMax() const;
+            void Plot(const char* label, const char* unit) const;
+
+        private:
+            /** Holds the values. */
+            std::array<float, HISTORY_SIZE> values_ = {};
+            /** Holds the position of the next value. */
+            std::size_t nextValue_ = 0;
+        };
+
+        void DrawZones(bool gpuZones) const;
+        void DrawGLFunctions() const;
+
+        /** The number of most called GL functions shown. */
+        static constexpr std::size_t NUM_TOP_GL_FUNCTIONS = 10;
+
+        /** Holds the render target pool to show the memory of. */
+        const RenderTargetPool* renderTargetPool_;
+        /** Holds the state cache to show the statistics of. */
+        const GLStateCache* stateCache_;
+        /** Holds the program binary cache to show the statistics of. */
+        const ProgramBinaryCache* programBinaryCache_;
+        /** Holds the frame times in milliseconds. */
+        History frameTimes_;
+        /** Holds the GL calls per frame. */
+        History glCalls_;
+        /** Holds the upload bandwidth in MB/s. */
+        History uploadBandwidth_;
+        /** Holds the readback bandwidth in MB/s. */
+        History downloadBandwidth_;
+    };
+}
+
+#endif
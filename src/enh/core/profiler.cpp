@@ -0,0 +1,181 @@
+/**
+ * @file   profiler.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the CPU and GPU zone profiler.
+ */
+
+#include "profiler.h"
+
+#ifdef ENABLE_PROFILING
+
+#include <algorithm>
+#include <cmath>
+
+namespace viscom::enh {
+
+    double Profiler::ZoneStatistics::GetLast() const
+    {
+        if (numSamples_ == 0) return 0.0;
+        return history_[(nextSample_ + HISTORY_SIZE - 1) % HISTORY_SIZE];
+    }
+
+    /** Returns the average over the history. */
+    double Profiler::ZoneStatistics::GetAverage() const
+    {
+        if (numSamples_ == 0) return 0.0;
+        return sum_ / static_cast<double>(numSamples_);
+    }
+
+    /**
+     *  Returns a percentile of the history (nearest rank).
+     *  @param percentile the percentile in [0, 100].
+     */
+    double Profiler::ZoneStatistics::GetPercentile(double percentile) const
+    {
+        if (numSamples_ == 0) return 0.0;
+
+        std::copy_n(history_.begin(), numSamples_, sortedHistory_.begin());
+        auto rank = static_cast<std::size_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(numSamples_)));
+        auto nth = sortedHistory_.begin() + (rank == 0 ? 0 : rank - 1);
+        std::nth_element(sortedHistory_.begin(), nth, sortedHistory_.begin() + numSamples_);
+        return *nth;
+    }
+
+    void Profiler::ZoneStatistics::AddSample(double sample)
+    {
+        if (numSamples_ == HISTORY_SIZE) sum_ -= history_[nextSample_];
+        else numSamples_ += 1;
+
+        history_[nextSample_] = sample;
+        sum_ += sample;
+        nextSample_ = (nextSample_ + 1) % HISTORY_SIZE;
+    }
+
+    Profiler& Profiler::Get()
+    {
+        static Profiler instance;
+        return instance;
+    }
+
+    /**
+     *  Registers a zone, a zone with the same name and type is reused.
+     *  @return the id of the zone.
+     */
+    std::size_t Profiler::RegisterZone(const std::string& name, ZoneType type)
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        for (std::size_t i = 0; i < zones_.size(); ++i) {
+            if (zones_[i].GetName() == name && zones_[i].GetType() == type) return i;
+        }
+        zones_.emplace_back(name, type);
+        return zones_.size() - 1;
+    }
+
+    /**
+     *  Completes the counters of the last frame, collects the GPU results of the query pool used two frames ago and
+     *  starts using it for this frame. This also advances a capture of the trace recorder.
+     */
+    void Profiler::BeginFrame()
+    {
+        for (std::size_t i = 0; i < frameCounters_.size(); ++i) lastFrameCounters_[i] = frameCounters_[i].exchange(0, std::memory_order_relaxed);
+
+        currentPool_ = (currentPool_ + 1) % NUM_QUERY_POOLS;
+        CollectGPUResults(currentPool_);
+        frameStarted_ = true;
+        TraceRecorder::Get().BeginFrame();
+    }
+
+    void Profiler::AddCPUSample(std::size_t zone, std::chrono::steady_clock::duration duration)
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        zones_[zone].AddSample(std::chrono::duration<double, std::milli>(duration).count());
+    }
+
+    /**
+     *  Writes the timestamp at the start of a GPU zone. Before the first frame and if the frame has too many zones
+     *  already, the zone is not measured.
+     *  @return the record to pass to EndGPUZone() (NO_GPU_RECORD if the zone is not measured).
+     */
+    std::size_t Profiler::BeginGPUZone(std::size_t zone)
+    {
+        auto& pool = queryPools_[currentPool_];
+        if (!frameStarted_) return NO_GPU_RECORD;
+        if (pool.usedQueries_ + pool.openZones_ + 2 > 2 * MAX_GPU_ZONES_PER_FRAME) {
+            droppedGPUZones_ += 1;
+            return NO_GPU_RECORD;
+        }
+
+        pool.openZones_ += 1;
+        auto query = pool.usedQueries_;
+        gl::glQueryCounter(GetQuery(currentPool_), gl::GL_TIMESTAMP);
+        pool.records_.push_back(GPURecord{ zone, query, query });
+        return pool.records_.size() - 1;
+    }
+
+    /** Writes the timestamp at the end of a GPU zone. */
+    void Profiler::EndGPUZone(std::size_t record)
+    {
+        if (record == NO_GPU_RECORD) return;
+
+        auto& pool = queryPools_[currentPool_];
+        pool.openZones_ -= 1;
+        pool.records_[record].endQuery_ = pool.usedQueries_;
+        gl::glQueryCounter(GetQuery(currentPool_), gl::GL_TIMESTAMP);
+    }
+
+    /** Returns the next query of a pool, the pool grows if all queries are used. */
+    gl::GLuint Profiler::GetQuery(std::size_t pool)
+    {
+        auto& queryPool = queryPools_[pool];
+        if (queryPool.usedQueries_ == queryPool.queries_.size()) {
+            queryPool.queries_.push_back(0);
+            gl::glGenQueries(1, &queryPool.queries_.back());
+        }
+        return queryPool.queries_[queryPool.usedQueries_++];
+    }
+
+    /**
+     *  Reads back the results of a pool if the GPU finished them and resets the pool. Timestamps are written in order,
+     *  so all results are available if the last one is.
+     */
+    void Profiler::CollectGPUResults(std::size_t pool)
+    {
+        auto& queryPool = queryPools_[pool];
+        if (queryPool.usedQueries_ > 0) {
+            gl::GLint available = 0;
+            gl::glGetQueryObjectiv(queryPool.queries_[queryPool.usedQueries_ - 1], gl::GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available != 0) {
+                std::lock_guard<std::mutex> lock{ mutex_ };
+                for (const auto& record : queryPool.records_) {
+                    gl::GLuint64 begin = 0, end = 0;
+                    gl::glGetQueryObjectui64v(queryPool.queries_[record.beginQuery_], gl::GL_QUERY_RESULT, &begin);
+                    gl::glGetQueryObjectui64v(queryPool.queries_[record.endQuery_], gl::GL_QUERY_RESULT, &end);
+                    zones_[record.zone_].AddSample(static_cast<double>(end - begin) * 1e-6);
+                    TraceRecorder::Get().RecordGPUZone(record.zone_, begin, end);
+                }
+            }
+            else droppedGPUFrames_ += 1;
+        }
+
+        queryPool.usedQueries_ = 0;
+        queryPool.openZones_ = 0;
+        queryPool.records_.clear();
+    }
+
+    /** Deletes all queries, GPU zones measured afterwards create new ones. */
+    void Profiler::ReleaseQueries()
+    {
+        for (auto& pool : queryPools_) {
+            if (!pool.queries_.empty()) gl::glDeleteQueries(static_cast<gl::GLsizei>(pool.queries_.size()), pool.queries_.data());
+            pool.queries_.clear();
+            pool.usedQueries_ = 0;
+            pool.openZones_ = 0;
+            pool.records_.clear();
+        }
+        frameStarted_ = false;
+    }
+}
+
+#endif
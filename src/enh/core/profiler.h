@@ -0,0 +1,245 @@
+/**
+ * @file   profiler.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the CPU and GPU zone profiler.
+ */
+
+#pragma once
+
+#ifdef ENABLE_PROFILING
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glbinding/gl/gl.h>
+#include "trace_recorder.h"
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Measures CPU and GPU time of named zones.
+     *
+     *  Zones are registered once per call site (see the ENH_PROFILE_* macros) and keep a history of their last
+     *  samples for rolling averages and percentiles. GPU zones write GL_TIMESTAMP queries into one of two query pools,
+     *  the pool of the frame before the last is read back in BeginFrame() if its results are available and dropped
+     *  otherwise, so the profiler never stalls the pipeline. GPU zones are only measured after the first BeginFrame()
+     *  (enh::ApplicationNodeBase calls it each frame) and at most MAX_GPU_ZONES_PER_FRAME per frame, further zones are
+     *  dropped. CPU zones may be used from any thread, GPU zones only from the thread owning the context. The queries
+     *  need to be released with ReleaseQueries() before the context is destroyed. While a capture of the TraceRecorder
+     *  runs the zones are also recorded to the trace. Besides the zones the profiler sums up counters per frame (GL
+     *  calls, transferred bytes) and tracks allocated GPU memory.
+     */
+    class Profiler final
+    {
+    public:
+        /** The kinds of zones. */
+        enum class ZoneType
+        {
+            CPU,
+            GPU
+        };
+
+        /** The counters summed up per frame. */
+        enum class FrameCounter
+        {
+            GL_CALLS,
+            UPLOADED_BYTES,
+            DOWNLOADED_BYTES,
+            COUNT
+        };
+
+        /** The kinds of GPU memory tracked. */
+        enum class MemoryCounter
+        {
+            TEXTURES,
+            BUFFERS,
+            COUNT
+        };
+
+        /** The number of samples kept per zone. */
+        static constexpr std::size_t HISTORY_SIZE = 128;
+        /** The maximum number of GPU zones measured per frame. */
+        static constexpr std::size_t MAX_GPU_ZONES_PER_FRAME = 512;
+        /** The record returned for GPU zones that are not measured. */
+        static constexpr std::size_t NO_GPU_RECORD = static_cast<std::size_t>(-1);
+
+        /** The statistics of a zone, all times are in milliseconds. */
+        class ZoneStatistics
+        {
+        public:
+            ZoneStatistics(std::string name, ZoneType type) : name_{ std::move(name) }, type_{ type } {}
+
+            const std::string& GetName() const { return name_; }
+            ZoneType GetType() const { return type_; }
+            /** Returns the number of samples in the history. */
+            std::size_t GetNumSamples() const { return numSamples_; }
+            double GetLast() const;
+            double GetAverage() const;
+            double GetPercentile(double percentile) const;
+            void AddSample(double sample);
+
+        private:
+            /** Holds the name of the zone. */
+            std::string name_;
+            /** Holds the type of the zone. */
+            ZoneType type_;
+            /** Holds the last samples as ring buffer. */
+            std::array<double, HISTORY_SIZE> history_ = {};
+            /** Holds a copy of the history for computing percentiles without allocating. */
+            mutable std::array<double, HISTORY_SIZE> sortedHistory_ = {};
+            /** Holds the number of samples in the history. */
+            std::size_t numSamples_ = 0;
+            /** Holds the position of the next sample. */
+            std::size_t nextSample_ = 0;
+            /** Holds the sum of the samples in the history. */
+            double sum_ = 0.0;
+        };
+
+        static Profiler& Get();
+
+        std::size_t RegisterZone(const std::string& name, ZoneType type);
+        void BeginFrame();
+        void AddCPUSample(std::size_t zone, std::chrono::steady_clock::duration duration);
+        std::size_t BeginGPUZone(std::size_t zone);
+        void EndGPUZone(std::size_t record);
+        void ReleaseQueries();
+        /** Adds a value to a counter of the current frame, may be used from any thread. */
+        void AddToCounter(FrameCounter counter, std::size_t value) { frameCounters_[static_cast<std::size_t>(counter)].fetch_add(value, std::memory_order_relaxed); }
+        /** Adds the size of allocated (or with a negative size freed) memory. */
+        void AddMemory(MemoryCounter counter, std::int64_t size) { memoryCounters_[static_cast<std::size_t>(counter)].fetch_add(size, std::memory_order_relaxed); }
+
+        /** Returns the number of zones, zone ids are in [0, GetNumZones()). */
+        std::size_t GetNumZones() const { return zones_.size(); }
+        /** Returns the statistics of a zone, the zone is read without locking so only use it from the main thread. */
+        const ZoneStatistics& GetZone(std::size_t zone) const { return zones_[zone]; }
+        /** Returns the number of frames whose GPU results were not yet available and dropped. */
+        std::size_t GetDroppedGPUFrames() const { return droppedGPUFrames_; }
+        /** Returns the number of GPU zones dropped because a frame had more than MAX_GPU_ZONES_PER_FRAME. */
+        std::size_t GetDroppedGPUZones() const { return droppedGPUZones_; }
+        /** Returns the value of a counter in the last completed frame. */
+        std::size_t GetLastFrameCounter(FrameCounter counter) const { return lastFrameCounters_[static_cast<std::size_t>(counter)]; }
+        /** Returns the memory currently allocated in bytes. */
+        std::int64_t GetMemory(MemoryCounter counter) const { return memoryCounters_[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed); }
+
+    private:
+        Profiler() = default;
+        void CollectGPUResults(std::size_t pool);
+        gl::GLuint GetQuery(std::size_t pool);
+
+        /** A measurement of a GPU zone. */
+        struct GPURecord
+        {
+            /** Holds the zone. */
+            std::size_t zone_;
+            /** Holds the index of the query at the start of the zone. */
+            std::size_t beginQuery_;
+            /** Holds the index of the query at the end of the zone. */
+            std::size_t endQuery_;
+        };
+
+        /** The queries of one frame. */
+        struct GPUQueryPool
+        {
+            /** Holds the queries, the pool grows to the number of queries needed per frame. */
+            std::vector<gl::GLuint> queries_;
+            /** Holds the number of queries used this frame. */
+            std::size_t usedQueries_ = 0;
+            /** Holds the number of zones begun but not ended this frame, their end queries are reserved. */
+            std::size_t openZones_ = 0;
+            /** Holds the measurements of the frame. */
+            std::vector<GPURecord> records_;
+        };
+
+        /** The number of query pools. */
+        static constexpr std::size_t NUM_QUERY_POOLS = 2;
+
+        /** Holds the zones. */
+        std::vector<ZoneStatistics> zones_;
+        /** Holds the mutex for registering zones and adding CPU samples. */
+        std::mutex mutex_;
+        /** Holds the query pools. */
+        std::array<GPUQueryPool, NUM_QUERY_POOLS> queryPools_;
+        /** Holds the query pool of the current frame. */
+        std::size_t currentPool_ = 0;
+        /** Holds whether BeginFrame() was called, GPU zones are not measured before. */
+        bool frameStarted_ = false;
+        /** Holds the number of frames whose GPU results were dropped. */
+        std::size_t droppedGPUFrames_ = 0;
+        /** Holds the number of GPU zones dropped because the frame had too many. */
+        std::size_t droppedGPUZones_ = 0;
+        /** Holds the counters of the current frame. */
+        std::array<std::atomic<std::size_t>, static_cast<std::size_t>(FrameCounter::COUNT)> frameCounters_ = {};
+        /** Holds the counters of the last completed frame. */
+        std::array<std::size_t, static_cast<std::size_t>(FrameCounter::COUNT)> lastFrameCounters_ = {};
+        /** Holds the allocated memory. */
+        std::array<std::atomic<std::int64_t>, static_cast<std::size_t>(MemoryCounter::COUNT)> memoryCounters_ = {};
+    };
+
+    /** Measures the CPU time of a scope. */
+    class CPUProfileZone final
+    {
+    public:
+        explicit CPUProfileZone(std::size_t zone) : zone_{ zone }, start_{ std::chrono::steady_clock::now() } {}
+        CPUProfileZone(const CPUProfileZone&) = delete;
+        CPUProfileZone& operator=(const CPUProfileZone&) = delete;
+        ~CPUProfileZone()
+        {
+            auto end = std::chrono::steady_clock::now();
+            Profiler::Get().AddCPUSample(zone_, end - start_);
+            if (TraceRecorder::Get().IsRecording()) TraceRecorder::Get().RecordCPUZone(zone_, start_, end);
+        }
+
+    private:
+        /** Holds the zone. */
+        std::size_t zone_;
+        /** Holds the start of the measurement. */
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /** Measures the GPU time of the commands issued in a scope. */
+    class GPUProfileZone final
+    {
+    public:
+        explicit GPUProfileZone(std::size_t zone) : record_{ Profiler::Get().BeginGPUZone(zone) } {}
+        GPUProfileZone(const GPUProfileZone&) = delete;
+        GPUProfileZone& operator=(const GPUProfileZone&) = delete;
+        ~GPUProfileZone() { Profiler::Get().EndGPUZone(record_); }
+
+    private:
+        /** Holds the record of the measurement. */
+        std::size_t record_;
+    };
+}
+
+#define ENH_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ENH_PROFILE_CONCAT(a, b) ENH_PROFILE_CONCAT_IMPL(a, b)
+/** Measures the CPU time of the enclosing scope. */
+#define ENH_PROFILE_CPU(name) \
+    static const std::size_t ENH_PROFILE_CONCAT(enhProfileZoneId, __LINE__) = ::viscom::enh::Profiler::Get().RegisterZone(name, ::viscom::enh::Profiler::ZoneType::CPU); \
+    ::viscom::enh::CPUProfileZone ENH_PROFILE_CONCAT(enhProfileZone, __LINE__){ ENH_PROFILE_CONCAT(enhProfileZoneId, __LINE__) }
+/** Measures the GPU time of the commands issued in the enclosing scope. */
+#define ENH_PROFILE_GPU(name) \
+    static const std::size_t ENH_PROFILE_CONCAT(enhProfileZoneId, __LINE__) = ::viscom::enh::Profiler::Get().RegisterZone(name, ::viscom::enh::Profiler::ZoneType::GPU); \
+    ::viscom::enh::GPUProfileZone ENH_PROFILE_CONCAT(enhProfileZone, __LINE__){ ENH_PROFILE_CONCAT(enhProfileZoneId, __LINE__) }
+/** Starts a new frame, called once per frame by enh::ApplicationNodeBase::UpdateFrame(). */
+#define ENH_PROFILE_BEGIN_FRAME() ::viscom::enh::Profiler::Get().BeginFrame()
+/** Adds a value to a counter of the current frame. */
+#define ENH_PROFILE_COUNT(counter, value) ::viscom::enh::Profiler::Get().AddToCounter(::viscom::enh::Profiler::FrameCounter::counter, value)
+/** Adds the size of allocated (or with a negative size freed) GPU memory. */
+#define ENH_PROFILE_MEMORY(counter, size) ::viscom::enh::Profiler::Get().AddMemory(::viscom::enh::Profiler::MemoryCounter::counter, size)
+
+#else
+
+#define ENH_PROFILE_CPU(name)
+#define ENH_PROFILE_GPU(name)
+#define ENH_PROFILE_BEGIN_FRAME()
+#define ENH_PROFILE_COUNT(counter, value)
+#define ENH_PROFILE_MEMORY(counter, size)
+
+#endif
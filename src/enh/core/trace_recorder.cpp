@@ -0,0 +1,182 @@
+/**
+ * @file   trace_recorder.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the recorder writing profiler zones to Chrome trace files.
+ */
+
+#include "trace_recorder.h"
+
+#ifdef ENABLE_PROFILING
+
+#include "profiler.h"
+#include "json_helper.h"
+#include "core/main.h"
+#include <algorithm>
+#include <fstream>
+#include <glbinding/gl/gl.h>
+
+namespace viscom::enh {
+
+    void TraceRecorder::ThreadBuffer::Push(const TraceEvent& event, std::size_t capture)
+    {
+        if (capture_.load(std::memory_order_relaxed) != capture) {
+            writeIndex_.store(0, std::memory_order_relaxed);
+            capture_.store(capture, std::memory_order_release);
+        }
+        auto index = writeIndex_.load(std::memory_order_relaxed);
+        events_[index % BUFFER_SIZE] = event;
+        writeIndex_.store(index + 1, std::memory_order_release);
+    }
+
+    TraceRecorder& TraceRecorder::Get()
+    {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    /**
+     *  Schedules a capture, a capture already scheduled or running is replaced.
+     *  @param filename the file the trace is written to.
+     *  @param numFrames the number of frames to record.
+     *  @param delayFrames the number of frames to wait before recording.
+     */
+    void TraceRecorder::ScheduleCapture(const std::string& filename, std::size_t numFrames, std::size_t delayFrames)
+    {
+        recording_.store(false, std::memory_order_relaxed);
+        filename_ = filename;
+        numFrames_ = std::max<std::size_t>(numFrames, 1);
+        framesLeft_ = delayFrames;
+        state_ = State::WAITING;
+        frameZone_ = Profiler::Get().RegisterZone("Frame", Profiler::ZoneType::CPU);
+    }
+
+    /** Records a CPU zone of the calling thread. */
+    void TraceRecorder::RecordCPUZone(std::size_t zone, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        GetThreadBuffer().Push(TraceEvent{ zone, std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch_).count(),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() }, capture_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     *  Records a GPU zone, only called by the profiler when reading back results.
+     *  @param begin the GPU timestamp at the start of the zone.
+     *  @param end the GPU timestamp at the end of the zone.
+     */
+    void TraceRecorder::RecordGPUZone(std::size_t zone, std::uint64_t begin, std::uint64_t end)
+    {
+        if (state_ != State::RECORDING && state_ != State::FLUSHING) return;
+        auto start = static_cast<std::int64_t>(begin) + gpuOffset_;
+        // zones from frames before the capture started.
+        if (start < 0) return;
+        gpuBuffer_->Push(TraceEvent{ zone, start, static_cast<std::int64_t>(end - begin) }, capture_.load(std::memory_order_relaxed));
+    }
+
+    /** Advances the capture by a frame, called from Profiler::BeginFrame(). */
+    void TraceRecorder::BeginFrame()
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (state_ == State::RECORDING) RecordCPUZone(frameZone_, frameStart_, now);
+        frameStart_ = now;
+
+        switch (state_) {
+        case State::WAITING:
+            if (framesLeft_ > 0) framesLeft_ -= 1;
+            else StartRecording();
+            break;
+        case State::RECORDING:
+            if (--framesLeft_ == 0) {
+                recording_.store(false, std::memory_order_relaxed);
+                framesLeft_ = GPU_LATENCY_FRAMES;
+                state_ = State::FLUSHING;
+            }
+            break;
+        case State::FLUSHING:
+            if (--framesLeft_ == 0) {
+                WriteTrace();
+                state_ = State::IDLE;
+            }
+            break;
+        case State::IDLE:
+            break;
+        }
+    }
+
+    /**
+     *  Starts a new capture and measures the offset between the GPU and CPU clocks. The buffers are not touched here,
+     *  each thread resets its own buffer when it records its first zone of the new capture.
+     */
+    void TraceRecorder::StartRecording()
+    {
+        if (!gpuBuffer_) gpuBuffer_ = std::make_unique<ThreadBuffer>();
+        capture_.fetch_add(1, std::memory_order_relaxed);
+
+        epoch_ = std::chrono::steady_clock::now();
+        frameStart_ = epoch_;
+        // the timestamp is taken when the previous commands reached the GPU, so the GPU zones align only roughly.
+        gl::GLint64 gpuTime = 0;
+        gl::glGetInteger64v(gl::GL_TIMESTAMP, &gpuTime);
+        gpuOffset_ = -static_cast<std::int64_t>(gpuTime);
+
+        framesLeft_ = numFrames_;
+        state_ = State::RECORDING;
+        // publishes the epoch and capture number to the recording threads.
+        recording_.store(true, std::memory_order_release);
+    }
+
+    /** Returns the buffer of the calling thread, it is created when the thread records its first zone. */
+    TraceRecorder::ThreadBuffer& TraceRecorder::GetThreadBuffer()
+    {
+        thread_local ThreadBuffer* threadBuffer = nullptr;
+        if (threadBuffer) return *threadBuffer;
+
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        threadBuffers_.push_back(std::make_unique<ThreadBuffer>());
+        threadBuffers_.back()->threadId_ = threadBuffers_.size();
+        threadBuffer = threadBuffers_.back().get();
+        return *threadBuffer;
+    }
+
+    /** Writes the recorded events, the GPU zones are written to thread 0. */
+    void TraceRecorder::WriteTrace() const
+    {
+        std::ofstream traceFile(filename_);
+        if (!traceFile) {
+            LOG(WARNING) << "Could not write trace file " << filename_ << ".";
+            return;
+        }
+
+        auto first = true;
+        auto capture = capture_.load(std::memory_order_relaxed);
+        auto writeThread = [&traceFile, &first, capture](const ThreadBuffer& buffer, std::size_t threadId, const std::string& threadName) {
+            // buffers of threads that recorded nothing in this capture still hold older events.
+            if (buffer.capture_.load(std::memory_order_acquire) != capture) return;
+            auto numEvents = buffer.writeIndex_.load(std::memory_order_acquire);
+            if (numEvents == 0) return;
+
+            traceFile << (first ? "\n" : ",\n") << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << threadId << R"(,"args":{"name":)";
+            WriteJSONString(traceFile, threadName);
+            traceFile << "}}";
+            first = false;
+
+            for (auto i = numEvents - std::min(numEvents, BUFFER_SIZE); i < numEvents; ++i) {
+                const auto& event = buffer.events_[i % BUFFER_SIZE];
+                traceFile << ",\n{\"name\":";
+                WriteJSONString(traceFile, Profiler::Get().GetZone(event.zone_).GetName());
+                traceFile << R"(,"ph":"X","pid":0,"tid":)" << threadId << ",\"ts\":" << static_cast<double>(event.start_) * 1e-3
+                    << ",\"dur\":" << static_cast<double>(event.duration_) * 1e-3 << "}";
+            }
+        };
+
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        traceFile << "{\"traceEvents\":[";
+        if (gpuBuffer_) writeThread(*gpuBuffer_, 0, "GPU");
+        for (const auto& buffer : threadBuffers_) writeThread(*buffer, buffer->threadId_, "CPU " + std::to_string(buffer->threadId_));
+        traceFile << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        LOG(INFO) << "Trace written to " << filename_ << ".";
+    }
+}
+
+#endif
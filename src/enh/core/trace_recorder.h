@@ -0,0 +1,127 @@
+/**
+ * @file   trace_recorder.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the recorder writing profiler zones to Chrome trace files.
+ */
+
+#pragma once
+
+#ifdef ENABLE_PROFILING
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Records the zones of the profiler for a number of frames and writes them as Chrome trace JSON.
+     *
+     *  The file can be opened in chrome://tracing or the Perfetto UI. Each thread writes its CPU zones to its own ring
+     *  buffer without locking, the GPU zones are added when the profiler reads them back and are moved to the CPU time
+     *  line by an offset measured at the start of the capture. As GPU results arrive a few frames late, the file is
+     *  written some frames after the last captured frame. When a ring buffer overflows the oldest events are dropped.
+     *  A capture is started by the application, e.g. on a key press, or scheduled some frames after the start.
+     */
+    class TraceRecorder final
+    {
+    public:
+        static TraceRecorder& Get();
+
+        void ScheduleCapture(const std::string& filename, std::size_t numFrames, std::size_t delayFrames = 0);
+        /** Returns whether CPU zones are recorded. */
+        bool IsRecording() const { return recording_.load(std::memory_order_acquire); }
+        /** Returns whether a capture is scheduled or running. */
+        bool IsCapturePending() const { return state_ != State::IDLE; }
+        void RecordCPUZone(std::size_t zone, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+        void RecordGPUZone(std::size_t zone, std::uint64_t begin, std::uint64_t end);
+        void BeginFrame();
+
+    private:
+        TraceRecorder() = default;
+
+        /** An event of the trace, the times are in nanoseconds since the start of the capture. */
+        struct TraceEvent
+        {
+            /** Holds the profiler zone. */
+            std::size_t zone_;
+            /** Holds the start time. */
+            std::int64_t start_;
+            /** Holds the duration. */
+            std::int64_t duration_;
+        };
+
+        /** The number of events kept per thread. */
+        static constexpr std::size_t BUFFER_SIZE = 16384;
+
+        /**
+         *  The ring buffer of one thread, written only by that thread. The owning thread resets it on its first event
+         *  of a new capture, so starting a capture never writes to buffers other threads may be pushing to.
+         */
+        struct ThreadBuffer
+        {
+            /** Holds the events. */
+            std::array<TraceEvent, BUFFER_SIZE> events_;
+            /** Holds the number of events written since the capture started. */
+            std::atomic<std::size_t> writeIndex_{ 0 };
+            /** Holds the capture the events belong to. */
+            std::atomic<std::size_t> capture_{ 0 };
+            /** Holds the id of the thread in the trace. */
+            std::size_t threadId_ = 0;
+
+            void Push(const TraceEvent& event, std::size_t capture);
+        };
+
+        /** The states of a capture. */
+        enum class State
+        {
+            IDLE,
+            WAITING,
+            RECORDING,
+            FLUSHING
+        };
+
+        /** The number of frames the GPU results arrive late, see Profiler::NUM_QUERY_POOLS. */
+        static constexpr std::size_t GPU_LATENCY_FRAMES = 2;
+
+        ThreadBuffer& GetThreadBuffer();
+        void StartRecording();
+        void WriteTrace() const;
+
+        /** Holds the buffers of all threads that recorded zones. */
+        std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers_;
+        /** Holds the mutex for registering thread buffers. */
+        mutable std::mutex mutex_;
+        /** Holds the buffer for the GPU zones. */
+        std::unique_ptr<ThreadBuffer> gpuBuffer_;
+        /** Holds whether CPU zones are recorded. */
+        std::atomic<bool> recording_{ false };
+        /** Holds the number of the current capture, set before recording starts. */
+        std::atomic<std::size_t> capture_{ 0 };
+        /** Holds the state of the capture, only used from the main thread. */
+        State state_ = State::IDLE;
+        /** Holds the frames to wait before or record in the current state. */
+        std::size_t framesLeft_ = 0;
+        /** Holds the number of frames to record. */
+        std::size_t numFrames_ = 0;
+        /** Holds the file to write. */
+        std::string filename_;
+        /** Holds the start of the capture. */
+        std::chrono::steady_clock::time_point epoch_;
+        /** Holds the offset from GPU timestamps to the capture time line in nanoseconds. */
+        std::int64_t gpuOffset_ = 0;
+        /** Holds the start of the current frame. */
+        std::chrono::steady_clock::time_point frameStart_;
+        /** Holds the zone used for frames. */
+        std::size_t frameZone_ = 0;
+    };
+}
+
+#endif
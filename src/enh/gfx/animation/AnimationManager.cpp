@@ -8,6 +8,7 @@
 
 #include "AnimationManager.h"
 #include "enh/core/gui_helper.h"
+#include "enh/core/profiler.h"
 #include <imgui.h>
 #include <fstream>
 #include <cereal/archives/xml.hpp>
@@ -230,6 +231,7 @@ namespace viscom::enh {
 
     bool AnimationManager::DoAnimationStep(float elapsedTime)
     {
+        ENH_PROFILE_CPU("Animation/Step");
         auto running = false;
         if (wpAnimations_.DoAnimationStep(elapsedTime)) running = true;
         if (rotAnimations_.DoAnimationStep(elapsedTime)) running = true;
@@ -8,18 +8,23 @@
 
 #include "EnvironmentMapRenderer.h"
 #include "enh/ApplicationNodeBase.h"
-#include "core/gfx/FullscreenQuad.h"
+#include "enh/gfx/gl/ScreenQuad.h"
 #include <glm/gtc/type_ptr.hpp>
 
 namespace viscom::enh {
 
     EnvironmentMapRenderer::EnvironmentMapRenderer(ApplicationNodeBase* app) :
-        screenQuad_(app->CreateFullscreenQuad("envmap/drawEnvMap.frag")),
-        envMapUniformIds_(screenQuad_->GetGPUProgram()->GetUniformLocations({ "envMapTex", "vpInv", "camPos" }))
+        stateCache_(app->GetGLStateCache()),
+        screenQuad_(std::make_unique<ScreenQuad>("envmap/drawEnvMap.frag", app)),
+        envMapUniformIds_(screenQuad_->GetProgram()->GetUniformLocations({ "envMapTex", "vpInv", "camPos" }))
     {
     }
 
-    EnvironmentMapRenderer::~EnvironmentMapRenderer() = default;
+    EnvironmentMapRenderer::~EnvironmentMapRenderer()
+    {
+        // the screen quad and its program are deleted with the renderer.
+        stateCache_->Invalidate();
+    }
 
     void EnvironmentMapRenderer::Draw(const CameraHelper& camera, gl::GLuint tex)
     {
@@ -28,10 +33,10 @@ namespace viscom::enh {
 
     void EnvironmentMapRenderer::Draw(const glm::vec3& camPos, const glm::mat4& viewproj, gl::GLuint tex)
     {
-        gl::glUseProgram(screenQuad_->GetGPUProgram()->getProgramId());
+        stateCache_->InvalidateExternalState();
+        stateCache_->UseProgram(screenQuad_->GetProgram()->GetProgramId());
 
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 0);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, tex);
+        stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, tex);
         gl::glUniform1i(envMapUniformIds_[0], 0);
 
         auto invMatrix = glm::inverse(viewproj);
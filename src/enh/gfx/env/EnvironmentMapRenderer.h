@@ -13,14 +13,14 @@
 #include <glbinding/gl/gl.h>
 
 namespace viscom {
-    class GPUProgram;
-    class FullscreenQuad;
     class CameraHelper;
 }
 
 namespace viscom::enh {
 
     class ApplicationNodeBase;
+    class GLStateCache;
+    class ScreenQuad;
 
     class EnvironmentMapRenderer
     {
@@ -32,8 +32,10 @@ namespace viscom::enh {
         void Draw(const glm::vec3& camPos, const glm::mat4& viewproj, gl::GLuint tex);
 
     private:
+        /** Holds the OpenGL state cache. */
+        GLStateCache* stateCache_;
         /** Holds the screen quad renderable. */
-        std::unique_ptr<FullscreenQuad> screenQuad_;
+        std::unique_ptr<ScreenQuad> screenQuad_;
         /** Holds the uniform bindings. */
         std::vector<gl::GLint> envMapUniformIds_;
     };
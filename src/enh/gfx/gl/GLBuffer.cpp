@@ -7,6 +7,7 @@
  */
 
 #include "GLBuffer.h"
+#include "enh/core/profiler.h"
 
 namespace viscom::enh {
 
@@ -17,13 +18,16 @@ namespace viscom::enh {
     }
 
 
-    GLBuffer::~GLBuffer() = default;
+    GLBuffer::~GLBuffer()
+    {
+        ENH_PROFILE_MEMORY(BUFFERS, -static_cast<std::int64_t>(bufferSize_));
+    }
 
     GLBuffer::GLBuffer(const GLBuffer& rhs) :
-        bufferSize_{ rhs.bufferSize_ },
+        bufferSize_{ 0 },
         usage_{ rhs.usage_ }
     {
-        std::vector<int8_t> tmp(bufferSize_);
+        std::vector<int8_t> tmp(rhs.bufferSize_);
         rhs.DownloadData(tmp);
         InitializeData(tmp);
     }
@@ -57,6 +61,8 @@ namespace viscom::enh {
 
     void GLBuffer::InitializeData(std::size_t size, const void* data)
     {
+        ENH_PROFILE_MEMORY(BUFFERS, static_cast<std::int64_t>(size) - static_cast<std::int64_t>(bufferSize_));
+        ENH_PROFILE_COUNT(UPLOADED_BYTES, data ? size : 0);
         bufferSize_ = size;
         gl::glNamedBufferData(buffer_, size, data, usage_);
     }
@@ -65,6 +71,7 @@ namespace viscom::enh {
     {
         if (offset + size > bufferSize_) {
             std::vector<int8_t> tmp(offset);
+            ENH_PROFILE_MEMORY(BUFFERS, static_cast<std::int64_t>(offset + size) - static_cast<std::int64_t>(bufferSize_));
             bufferSize_ = offset + size;
             gl::glGetNamedBufferSubData(buffer_, 0, offset, tmp.data());
             gl::glNamedBufferData(buffer_, bufferSize_, nullptr, usage_);
@@ -72,10 +79,12 @@ namespace viscom::enh {
         }
 
         gl::glNamedBufferSubData(buffer_, offset, size, data);
+        ENH_PROFILE_COUNT(UPLOADED_BYTES, size);
     }
 
     void GLBuffer::DownloadData(std::size_t size, void* data) const
     {
         gl::glGetNamedBufferSubData(buffer_, 0, size, data);
+        ENH_PROFILE_COUNT(DOWNLOADED_BYTES, size);
     }
 }
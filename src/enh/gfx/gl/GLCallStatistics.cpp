@@ -0,0 +1,112 @@
+/**
+ * @file   GLCallStatistics.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the low overhead OpenGL call statistics.
+ */
+
+#include "GLCallStatistics.h"
+
+#ifdef ENABLE_GL_CALL_STATISTICS
+
+#include "core/main.h"
+#include "enh/core/profiler.h"
+#include <algorithm>
+#include <glbinding/gl/gl.h>
+#include <glbinding/AbstractFunction.h>
+#include <glbinding/Binding.h>
+#include <glbinding/Meta.h>
+#include <glbinding/callbacks.h>
+
+namespace viscom::enh {
+
+    GLCallStatistics& GLCallStatistics::Get()
+    {
+        static GLCallStatistics instance;
+        return instance;
+    }
+
+    /**
+     *  Allocates the counters and installs the glbinding callback. glGetError() is excluded from the callback as it
+     *  is called by the statistics themselves.
+     */
+    void GLCallStatistics::Install()
+    {
+        const auto& functions = glbinding::Binding::functions();
+        functions_.assign(functions.begin(), functions.end());
+        std::sort(functions_.begin(), functions_.end());
+        frameCalls_.assign(functions_.size(), 0);
+        lastFrameCalls_.assign(functions_.size(), 0);
+        totalCalls_.assign(functions_.size(), 0);
+        InstallCallback();
+    }
+
+    /** Installs the glbinding callback again after it was replaced, e.g. by a GLCommandCapture. */
+    void GLCallStatistics::InstallCallback()
+    {
+        glbinding::setCallbackMaskExcept(glbinding::CallbackMask::After, { "glGetError" });
+        glbinding::setAfterCallback([](const glbinding::FunctionCall& call) { Get().AddCall(call.function); });
+    }
+
+    /**
+     *  Sets the number of calls between error checks.
+     *  @param interval the interval, it is clamped to [1, CALL_HISTORY_SIZE] so error reports contain the failing call.
+     */
+    void GLCallStatistics::SetErrorCheckInterval(std::size_t interval)
+    {
+        errorCheckInterval_ = std::clamp<std::size_t>(interval, 1, CALL_HISTORY_SIZE);
+    }
+
+    /** Moves the counters of the current frame to the last frame, called by enh::ApplicationNodeBase::UpdateFrame(). */
+    void GLCallStatistics::EndFrame()
+    {
+        std::swap(frameCalls_, lastFrameCalls_);
+        std::fill(frameCalls_.begin(), frameCalls_.end(), 0);
+        lastFrameNumCalls_ = frameNumCalls_;
+        frameNumCalls_ = 0;
+    }
+
+    const char* GLCallStatistics::GetFunctionName(std::size_t function) const
+    {
+        return functions_[function]->name();
+    }
+
+    /** Counts a call, only called from the callback or from callbacks replacing it. */
+    void GLCallStatistics::AddCall(const glbinding::AbstractFunction* function)
+    {
+        auto it = std::lower_bound(functions_.begin(), functions_.end(), function);
+        // functions not in the binding are stored as functions_.size(), which CheckErrors() reports as unknown.
+        auto index = functions_.size();
+        if (it != functions_.end() && *it == function) {
+            index = static_cast<std::size_t>(it - functions_.begin());
+            frameCalls_[index] += 1;
+            totalCalls_[index] += 1;
+        }
+
+        callHistory_[numCalls_ % CALL_HISTORY_SIZE] = static_cast<std::uint32_t>(index);
+        numCalls_ += 1;
+        frameNumCalls_ += 1;
+        ENH_PROFILE_COUNT(GL_CALLS, 1);
+
+        if (++callsSinceErrorCheck_ >= errorCheckInterval_) CheckErrors();
+    }
+
+    /** Checks for errors and logs each with the calls since the last check. */
+    void GLCallStatistics::CheckErrors()
+    {
+        auto numCheckedCalls = callsSinceErrorCheck_;
+        callsSinceErrorCheck_ = 0;
+
+        for (auto error = gl::glGetError(); error != gl::GL_NO_ERROR; error = gl::glGetError()) {
+            numErrors_ += 1;
+            LOG(WARNING) << "Error: " << glbinding::Meta::getString(error) << " in one of the last " << numCheckedCalls << " calls:";
+            for (auto i = numCalls_ - std::min<std::uint64_t>(numCheckedCalls, numCalls_); i < numCalls_; ++i) {
+                auto function = callHistory_[i % CALL_HISTORY_SIZE];
+                LOG(WARNING) << "    " << (function < functions_.size() ? functions_[function]->name() : "<unknown>");
+            }
+        }
+    }
+}
+
+#endif
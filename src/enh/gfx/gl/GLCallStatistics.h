@@ -0,0 +1,89 @@
+/**
+ * @file   GLCallStatistics.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the low overhead OpenGL call statistics.
+ */
+
+#pragma once
+
+#ifdef ENABLE_GL_CALL_STATISTICS
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace glbinding {
+    class AbstractFunction;
+}
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Counts the OpenGL calls per function and checks for errors periodically.
+     *
+     *  Installs a glbinding after callback that does no string formatting: the function is mapped to its index in the
+     *  binding and counted in an array allocated once. glGetError() is only called every few calls, when it reports an
+     *  error the error is logged together with the last calls, which are kept as function indices in a ring buffer
+     *  large enough to contain the failing call. The statistics are only updated from the thread owning the context.
+     */
+    class GLCallStatistics final
+    {
+    public:
+        /** The number of calls kept for error reports, also the maximum interval between error checks. */
+        static constexpr std::size_t CALL_HISTORY_SIZE = 64;
+
+        static GLCallStatistics& Get();
+
+        void Install();
+        void InstallCallback();
+        void AddCall(const glbinding::AbstractFunction* function);
+        void SetErrorCheckInterval(std::size_t interval);
+        void EndFrame();
+
+        /** Returns the number of functions in the binding, function indices are in [0, GetNumFunctions()). */
+        std::size_t GetNumFunctions() const { return functions_.size(); }
+        const char* GetFunctionName(std::size_t function) const;
+        /** Returns the number of calls of a function in the last frame. */
+        std::uint64_t GetLastFrameCalls(std::size_t function) const { return lastFrameCalls_[function]; }
+        /** Returns the number of calls of a function since installing the statistics. */
+        std::uint64_t GetTotalCalls(std::size_t function) const { return totalCalls_[function]; }
+        /** Returns the number of calls in the last frame. */
+        std::uint64_t GetLastFrameCalls() const { return lastFrameNumCalls_; }
+        /** Returns the number of calls since installing the statistics, differences count the calls of any section. */
+        std::uint64_t GetNumCalls() const { return numCalls_; }
+        /** Returns the number of errors found. */
+        std::uint64_t GetNumErrors() const { return numErrors_; }
+
+    private:
+        GLCallStatistics() = default;
+        void CheckErrors();
+
+        /** Holds the functions of the binding sorted by address for finding their indices. */
+        std::vector<const glbinding::AbstractFunction*> functions_;
+        /** Holds the calls per function in the current frame. */
+        std::vector<std::uint64_t> frameCalls_;
+        /** Holds the calls per function in the last frame. */
+        std::vector<std::uint64_t> lastFrameCalls_;
+        /** Holds the calls per function since installing the statistics. */
+        std::vector<std::uint64_t> totalCalls_;
+        /** Holds the number of calls in the current frame. */
+        std::uint64_t frameNumCalls_ = 0;
+        /** Holds the number of calls in the last frame. */
+        std::uint64_t lastFrameNumCalls_ = 0;
+        /** Holds the indices of the last calls as ring buffer. */
+        std::array<std::uint32_t, CALL_HISTORY_SIZE> callHistory_ = {};
+        /** Holds the number of calls made since installing the statistics. */
+        std::uint64_t numCalls_ = 0;
+        /** Holds the number of calls between error checks. */
+        std::size_t errorCheckInterval_ = CALL_HISTORY_SIZE;
+        /** Holds the number of calls since the last error check. */
+        std::size_t callsSinceErrorCheck_ = 0;
+        /** Holds the number of errors found. */
+        std::uint64_t numErrors_ = 0;
+    };
+}
+
+#endif
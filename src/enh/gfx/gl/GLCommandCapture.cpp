@@ -0,0 +1,872 @@
+/**
+ * @file   GLCommandCapture.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the binary capture and replay of OpenGL commands.
+ */
+
+#include "GLCommandCapture.h"
+#include "GLCallStatistics.h"
+#include "core/main.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <glbinding/gl/gl.h>
+#include <glbinding/AbstractFunction.h>
+#include <glbinding/Binding.h>
+#include <glbinding/Value.h>
+#include <glbinding/callbacks.h>
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Maps the names of objects created during a capture to the objects created by their replay.
+     *
+     *  Names that were not created during the capture are used unchanged, except the default frame buffer which can
+     *  be replaced by a frame buffer object for contexts without one. The objects created by the replay are deleted
+     *  when the capture deletes them, when the creation is replayed again and when the replay is destroyed.
+     */
+    class GLReplayObjectNames final
+    {
+    public:
+        /** The types of objects that are created by the replay. */
+        enum class Type : std::uint8_t { Buffer, Texture, Framebuffer, VertexArray, Sampler, Query, Shader, Program, Count };
+
+        GLReplayObjectNames() = default;
+        GLReplayObjectNames(const GLReplayObjectNames&) = delete;
+        GLReplayObjectNames& operator=(const GLReplayObjectNames&) = delete;
+        ~GLReplayObjectNames();
+
+        /** Returns the name of the object replaying a captured object. */
+        gl::GLuint Get(Type type, gl::GLuint name) const
+        {
+            if (type == Type::Framebuffer && name == 0) return defaultFramebuffer_;
+            const auto& names = names_[static_cast<std::size_t>(type)];
+            return name < names.size() && names[name] != 0 ? names[name] : name;
+        }
+        void Add(Type type, gl::GLsizei count, const gl::GLuint* capturedNames, const gl::GLuint* createdNames);
+        void Remove(Type type, gl::GLsizei count, const gl::GLuint* capturedNames);
+        /** Sets the frame buffer used in place of the default frame buffer, it is not deleted by the replay. */
+        void SetDefaultFramebuffer(gl::GLuint framebuffer) { defaultFramebuffer_ = framebuffer; }
+
+    private:
+        static void Delete(Type type, gl::GLsizei count, const gl::GLuint* names);
+
+        /** Holds the created names of each type indexed by the captured names, 0 if not created. */
+        std::array<std::vector<gl::GLuint>, static_cast<std::size_t>(Type::Count)> names_;
+        /** Holds the frame buffer replacing the default frame buffer. */
+        gl::GLuint defaultFramebuffer_ = 0;
+    };
+
+    /** Deletes all objects created by the replay, needs the context the replay ran in. */
+    GLReplayObjectNames::~GLReplayObjectNames()
+    {
+        for (std::size_t i = 0; i < names_.size(); ++i) {
+            std::vector<gl::GLuint> createdNames;
+            std::copy_if(names_[i].begin(), names_[i].end(), std::back_inserter(createdNames), [](gl::GLuint name) { return name != 0; });
+            if (!createdNames.empty()) Delete(static_cast<Type>(i), static_cast<gl::GLsizei>(createdNames.size()), createdNames.data());
+        }
+    }
+
+    /**
+     *  Adds the objects created for captured objects, objects created for the same names before are deleted.
+     *  @param type the type of the objects.
+     *  @param count the number of objects.
+     *  @param capturedNames the names of the objects in the capture.
+     *  @param createdNames the names of the objects created by the replay.
+     */
+    void GLReplayObjectNames::Add(Type type, gl::GLsizei count, const gl::GLuint* capturedNames, const gl::GLuint* createdNames)
+    {
+        auto& names = names_[static_cast<std::size_t>(type)];
+        for (gl::GLsizei i = 0; i < count; ++i) {
+            if (capturedNames[i] == 0) continue;
+            if (capturedNames[i] >= names.size()) names.resize(capturedNames[i] + 1, 0);
+            if (names[capturedNames[i]] != 0) Delete(type, 1, &names[capturedNames[i]]);
+            names[capturedNames[i]] = createdNames[i];
+        }
+    }
+
+    /**
+     *  Removes deleted objects.
+     *  @param type the type of the objects.
+     *  @param count the number of objects.
+     *  @param capturedNames the names of the objects in the capture.
+     */
+    void GLReplayObjectNames::Remove(Type type, gl::GLsizei count, const gl::GLuint* capturedNames)
+    {
+        auto& names = names_[static_cast<std::size_t>(type)];
+        for (gl::GLsizei i = 0; i < count; ++i) {
+            if (capturedNames[i] < names.size()) names[capturedNames[i]] = 0;
+        }
+    }
+
+    /** Deletes objects of a type. */
+    void GLReplayObjectNames::Delete(Type type, gl::GLsizei count, const gl::GLuint* names)
+    {
+        switch (type) {
+        case Type::Buffer: gl::glDeleteBuffers(count, names); break;
+        case Type::Texture: gl::glDeleteTextures(count, names); break;
+        case Type::Framebuffer: gl::glDeleteFramebuffers(count, names); break;
+        case Type::VertexArray: gl::glDeleteVertexArrays(count, names); break;
+        case Type::Sampler: gl::glDeleteSamplers(count, names); break;
+        case Type::Query: gl::glDeleteQueries(count, names); break;
+        case Type::Shader: std::for_each(names, names + count, [](gl::GLuint name) { gl::glDeleteShader(name); }); break;
+        case Type::Program: std::for_each(names, names + count, [](gl::GLuint name) { gl::glDeleteProgram(name); }); break;
+        default: break;
+        }
+    }
+
+    namespace {
+
+        /** Identifies capture files. */
+        constexpr std::array<char, 8> CAPTURE_MAGIC = { 'E', 'N', 'H', 'G', 'L', 'C', 'A', 'P' };
+        /** The version of the capture format. */
+        constexpr std::uint32_t CAPTURE_VERSION = 2;
+        /** The memory reserved for the commands of a capture. */
+        constexpr std::size_t INITIAL_CAPTURE_SIZE = 4 * 1024 * 1024;
+        /** The pixel unpack parameters recorded at the start of a capture. */
+        constexpr std::array<gl::GLenum, 6> UNPACK_PARAMETERS = { gl::GL_UNPACK_ALIGNMENT, gl::GL_UNPACK_ROW_LENGTH,
+            gl::GL_UNPACK_IMAGE_HEIGHT, gl::GL_UNPACK_SKIP_PIXELS, gl::GL_UNPACK_SKIP_ROWS, gl::GL_UNPACK_SKIP_IMAGES };
+
+        /** Appends raw values to a byte array. */
+        class CommandWriter
+        {
+        public:
+            explicit CommandWriter(std::vector<std::uint8_t>& data) : data_{ data } {}
+
+            template<class T> void Write(const T& value) { WriteBytes(&value, sizeof(T)); }
+            void WriteBytes(const void* bytes, std::size_t size)
+            {
+                auto begin = static_cast<const std::uint8_t*>(bytes);
+                data_.insert(data_.end(), begin, begin + size);
+            }
+
+        private:
+            /** Holds the data written to. */
+            std::vector<std::uint8_t>& data_;
+        };
+
+        /** Reads raw values from a byte array, reading past the end throws. */
+        class CommandReader
+        {
+        public:
+            explicit CommandReader(const std::vector<std::uint8_t>& data) : data_{ data } {}
+
+            template<class T> T Read()
+            {
+                T value;
+                ReadBytes(&value, sizeof(T));
+                return value;
+            }
+            void ReadBytes(void* bytes, std::size_t size)
+            {
+                if (size > data_.size() - position_) throw std::runtime_error("Capture file is truncated.");
+                std::memcpy(bytes, data_.data() + position_, size);
+                position_ += size;
+            }
+
+        private:
+            /** Holds the data read from. */
+            const std::vector<std::uint8_t>& data_;
+            /** Holds the read position. */
+            std::size_t position_ = 0;
+        };
+
+        using PayloadStorage = std::vector<std::unique_ptr<std::uint64_t[]>>;
+        using ObjectType = GLReplayObjectNames::Type;
+        /** The arguments of a function that are object names, as argument index and object type. */
+        using ObjectArguments = std::vector<std::pair<std::size_t, ObjectType>>;
+
+        /**
+         *  Writes an argument: pointers with a payload size are followed by the memory they point to, other pointers
+         *  are offsets into bound buffers.
+         */
+        template<class T> void WriteArgument(CommandWriter& writer, T value, std::size_t payloadSize)
+        {
+            if constexpr (std::is_pointer_v<T>) {
+                auto hasPayload = value != nullptr && payloadSize > 0;
+                writer.Write<std::uint8_t>(hasPayload ? 1 : 0);
+                if (hasPayload) {
+                    writer.Write<std::uint64_t>(payloadSize);
+                    writer.WriteBytes(value, payloadSize);
+                }
+                else writer.Write<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value));
+            }
+            else {
+                static_assert(std::is_trivially_copyable_v<T>, "Arguments need to be trivially copyable.");
+                writer.Write(value);
+            }
+        }
+
+        template<class T> T ReadArgument(CommandReader& reader, PayloadStorage& payloads)
+        {
+            if constexpr (std::is_pointer_v<T>) {
+                if (reader.Read<std::uint8_t>() == 0) return reinterpret_cast<T>(static_cast<std::uintptr_t>(reader.Read<std::uint64_t>()));
+                auto size = reader.Read<std::uint64_t>();
+                payloads.push_back(std::make_unique<std::uint64_t[]>((size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t)));
+                reader.ReadBytes(payloads.back().get(), size);
+                return reinterpret_cast<T>(payloads.back().get());
+            }
+            else return reader.Read<T>();
+        }
+
+        /** A function that can be captured and replayed. */
+        struct CommandType
+        {
+            /** Holds the name of the function. */
+            const char* name_;
+            /** Holds the function writing the arguments of a call. */
+            std::function<void(const glbinding::FunctionCall&, CommandWriter&)> record_;
+            /** Holds the function decoding the arguments of a call to a command executing it. */
+            std::function<std::function<void()>(CommandReader&, PayloadStorage&, GLReplayObjectNames&)> load_;
+        };
+
+        /** The payload size of functions not reading client memory. */
+        struct NoPayload
+        {
+            template<class Tuple> std::size_t operator()(const Tuple&) const { return 0; }
+        };
+
+        template<class... Args, class PayloadSize, std::size_t... I>
+        void RecordArguments(const glbinding::FunctionCall& call, CommandWriter& writer, const PayloadSize& payloadSize, std::index_sequence<I...>)
+        {
+            // glbinding stores the parameters as values of exactly the argument types.
+            std::tuple<Args...> args{ static_cast<const glbinding::Value<Args>*>(call.parameters[I])->value()... };
+            auto size = payloadSize(args);
+            (WriteArgument(writer, std::get<I>(args), size), ...);
+        }
+
+        /** Returns a payload size read from an argument. */
+        template<std::size_t I> struct ArgumentSize
+        {
+            template<class Tuple> std::size_t operator()(const Tuple& args) const { return static_cast<std::size_t>(std::get<I>(args)); }
+        };
+
+        /** Returns the payload size of an array with the count in argument I and N elements of T per entry. */
+        template<std::size_t I, std::size_t N, class T> struct ArraySize
+        {
+            template<class Tuple> std::size_t operator()(const Tuple& args) const { return static_cast<std::size_t>(std::get<I>(args)) * N * sizeof(T); }
+        };
+
+        /** Replaces an argument that is an object name by the name of the object replaying it. */
+        template<class T> void RemapArgument(T& value, ObjectType type, const GLReplayObjectNames& names)
+        {
+            if constexpr (std::is_same_v<T, gl::GLuint>) value = names.Get(type, value);
+        }
+
+        template<class Tuple, std::size_t... I>
+        void RemapArguments(Tuple& args, const ObjectArguments& objects, const GLReplayObjectNames& names, std::index_sequence<I...>)
+        {
+            for (const auto& object : objects) ((I == object.first ? RemapArgument(std::get<I>(args), object.second, names) : void()), ...);
+        }
+
+        /**
+         *  Creates the command type of a function whose arguments contain object names.
+         *  @param name the name of the function in glbinding.
+         *  @param function the function.
+         *  @param objects the arguments that are object names, they are remapped to the objects created by the replay.
+         *  @param payloadSize returns the size of the client memory read by a call from its arguments.
+         */
+        template<class... Args, class PayloadSize = NoPayload>
+        CommandType MakeObjectCommand(const char* name, void (*function)(Args...), const ObjectArguments& objects, PayloadSize payloadSize = {})
+        {
+            return CommandType{ name,
+                [payloadSize](const glbinding::FunctionCall& call, CommandWriter& writer) {
+                    RecordArguments<Args...>(call, writer, payloadSize, std::index_sequence_for<Args...>{});
+                },
+                [function, objects](CommandReader& reader, PayloadStorage& payloads, GLReplayObjectNames& names) -> std::function<void()> {
+                    // braced initialization evaluates the arguments in order.
+                    std::tuple<Args...> args{ ReadArgument<Args>(reader, payloads)... };
+                    if (objects.empty()) return [function, args]() { std::apply(function, args); };
+                    // the names are only known once the replay created the objects.
+                    return [function, args, objects, &names]() {
+                        auto remappedArgs = args;
+                        RemapArguments(remappedArgs, objects, names, std::index_sequence_for<Args...>{});
+                        std::apply(function, remappedArgs);
+                    };
+                } };
+        }
+
+        /**
+         *  Creates the command type of a function.
+         *  @param name the name of the function in glbinding.
+         *  @param function the function.
+         *  @param payloadSize returns the size of the client memory read by a call from its arguments.
+         */
+        template<class... Args, class PayloadSize = NoPayload>
+        CommandType MakeCommand(const char* name, void (*function)(Args...), PayloadSize payloadSize = {})
+        {
+            return MakeObjectCommand(name, function, ObjectArguments{}, payloadSize);
+        }
+
+        /**
+         *  Creates the command type of a function creating objects, its last arguments are the number of objects and
+         *  the array the names are written to. The names are recorded after the call and mapped to the names created
+         *  by the replay.
+         *  @param name the name of the function in glbinding.
+         *  @param function the function.
+         *  @param type the type of the created objects.
+         */
+        template<class... Args>
+        CommandType MakeCreateCommand(const char* name, void (*function)(Args...), ObjectType type)
+        {
+            constexpr auto COUNT = sizeof...(Args) - 2;
+            constexpr auto NAMES = sizeof...(Args) - 1;
+            static_assert(std::is_same_v<std::tuple_element_t<NAMES, std::tuple<Args...>>, gl::GLuint*>, "Objects are returned as name arrays.");
+            return CommandType{ name,
+                [](const glbinding::FunctionCall& call, CommandWriter& writer) {
+                    RecordArguments<Args...>(call, writer, ArraySize<COUNT, 1, gl::GLuint>{}, std::index_sequence_for<Args...>{});
+                },
+                [function, type](CommandReader& reader, PayloadStorage& payloads, GLReplayObjectNames& names) -> std::function<void()> {
+                    std::tuple<Args...> args{ ReadArgument<Args>(reader, payloads)... };
+                    return [function, type, args, &names]() {
+                        auto count = std::get<COUNT>(args);
+                        std::vector<gl::GLuint> createdNames(static_cast<std::size_t>(std::max(count, 0)));
+                        auto createArgs = args;
+                        std::get<NAMES>(createArgs) = createdNames.data();
+                        std::apply(function, createArgs);
+                        names.Add(type, count, std::get<NAMES>(args), createdNames.data());
+                    };
+                } };
+        }
+
+        /**
+         *  Creates the command type of a function deleting objects, its arguments are the number of objects and their
+         *  names.
+         *  @param name the name of the function in glbinding.
+         *  @param function the function.
+         *  @param type the type of the deleted objects.
+         */
+        CommandType MakeDeleteCommand(const char* name, void (*function)(gl::GLsizei, const gl::GLuint*), ObjectType type)
+        {
+            return CommandType{ name,
+                [](const glbinding::FunctionCall& call, CommandWriter& writer) {
+                    RecordArguments<gl::GLsizei, const gl::GLuint*>(call, writer, ArraySize<0, 1, gl::GLuint>{}, std::index_sequence_for<gl::GLsizei, const gl::GLuint*>{});
+                },
+                [function, type](CommandReader& reader, PayloadStorage& payloads, GLReplayObjectNames& names) -> std::function<void()> {
+                    auto count = ReadArgument<gl::GLsizei>(reader, payloads);
+                    auto capturedNames = ReadArgument<const gl::GLuint*>(reader, payloads);
+                    return [function, type, count, capturedNames, &names]() {
+                        std::vector<gl::GLuint> deletedNames(static_cast<std::size_t>(std::max(count, 0)));
+                        // moved-from RAII wrappers delete name 0, it must not delete the replaced default frame buffer.
+                        std::transform(capturedNames, capturedNames + deletedNames.size(), deletedNames.begin(),
+                            [type, &names](gl::GLuint name) { return name == 0 ? name : names.Get(type, name); });
+                        function(count, deletedNames.data());
+                        names.Remove(type, count, capturedNames);
+                    };
+                } };
+        }
+
+        /**
+         *  Creates the command type of a function returning the name of a created object (shaders and programs). The
+         *  returned name is recorded after the arguments.
+         *  @param name the name of the function in glbinding.
+         *  @param function the function.
+         *  @param type the type of the created object.
+         */
+        template<class... Args>
+        CommandType MakeCreateReturnCommand(const char* name, gl::GLuint (*function)(Args...), ObjectType type)
+        {
+            return CommandType{ name,
+                [](const glbinding::FunctionCall& call, CommandWriter& writer) {
+                    RecordArguments<Args...>(call, writer, NoPayload{}, std::index_sequence_for<Args...>{});
+                    writer.Write(static_cast<const glbinding::Value<gl::GLuint>*>(call.returnValue)->value());
+                },
+                [function, type](CommandReader& reader, PayloadStorage& payloads, GLReplayObjectNames& names) -> std::function<void()> {
+                    std::tuple<Args...> args{ ReadArgument<Args>(reader, payloads)... };
+                    auto capturedName = reader.Read<gl::GLuint>();
+                    return [function, type, args, capturedName, &names]() {
+                        auto createdName = std::apply(function, args);
+                        names.Add(type, 1, &capturedName, &createdName);
+                    };
+                } };
+        }
+
+        /**
+         *  Creates the command type of a function deleting a single object given by its name.
+         *  @param name the name of the function in glbinding.
+         *  @param function the function.
+         *  @param type the type of the deleted object.
+         */
+        CommandType MakeDeleteSingleCommand(const char* name, void (*function)(gl::GLuint), ObjectType type)
+        {
+            return CommandType{ name,
+                [](const glbinding::FunctionCall& call, CommandWriter& writer) {
+                    RecordArguments<gl::GLuint>(call, writer, NoPayload{}, std::index_sequence_for<gl::GLuint>{});
+                },
+                [function, type](CommandReader& reader, PayloadStorage& payloads, GLReplayObjectNames& names) -> std::function<void()> {
+                    auto capturedName = ReadArgument<gl::GLuint>(reader, payloads);
+                    return [function, type, capturedName, &names]() {
+                        function(names.Get(type, capturedName));
+                        names.Remove(type, 1, &capturedName);
+                    };
+                } };
+        }
+
+        /**
+         *  Creates the command type of glShaderSource. The source strings are concatenated to a single payload, so
+         *  the replay passes one string with its length.
+         */
+        CommandType MakeShaderSourceCommand()
+        {
+            return CommandType{ "glShaderSource",
+                [](const glbinding::FunctionCall& call, CommandWriter& writer) {
+                    auto shader = static_cast<const glbinding::Value<gl::GLuint>*>(call.parameters[0])->value();
+                    auto count = static_cast<const glbinding::Value<gl::GLsizei>*>(call.parameters[1])->value();
+                    auto strings = static_cast<const glbinding::Value<const gl::GLchar* const*>*>(call.parameters[2])->value();
+                    auto lengths = static_cast<const glbinding::Value<const gl::GLint*>*>(call.parameters[3])->value();
+
+                    // strings without a (non negative) length are null terminated.
+                    std::string source;
+                    for (gl::GLsizei i = 0; i < count; ++i) {
+                        if (lengths && lengths[i] >= 0) source.append(strings[i], static_cast<std::size_t>(lengths[i]));
+                        else source.append(strings[i]);
+                    }
+                    writer.Write(shader);
+                    writer.Write<std::uint64_t>(source.size());
+                    writer.WriteBytes(source.data(), source.size());
+                },
+                [](CommandReader& reader, PayloadStorage& payloads, GLReplayObjectNames& names) -> std::function<void()> {
+                    auto shader = reader.Read<gl::GLuint>();
+                    auto size = reader.Read<std::uint64_t>();
+                    payloads.push_back(std::make_unique<std::uint64_t[]>((size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t)));
+                    reader.ReadBytes(payloads.back().get(), size);
+                    auto source = reinterpret_cast<const gl::GLchar*>(payloads.back().get());
+                    auto length = static_cast<gl::GLint>(size);
+                    return [shader, source, length, &names]() { gl::glShaderSource(names.Get(ObjectType::Shader, shader), 1, &source, &length); };
+                } };
+        }
+
+        /** Returns the size of a pixel in client memory. */
+        std::size_t GetPixelSize(gl::GLenum format, gl::GLenum type)
+        {
+            switch (type) {
+            case gl::GL_UNSIGNED_SHORT_5_6_5: case gl::GL_UNSIGNED_SHORT_5_6_5_REV:
+            case gl::GL_UNSIGNED_SHORT_4_4_4_4: case gl::GL_UNSIGNED_SHORT_4_4_4_4_REV:
+            case gl::GL_UNSIGNED_SHORT_5_5_5_1: case gl::GL_UNSIGNED_SHORT_1_5_5_5_REV:
+                return 2;
+            case gl::GL_UNSIGNED_INT_8_8_8_8: case gl::GL_UNSIGNED_INT_8_8_8_8_REV:
+            case gl::GL_UNSIGNED_INT_10_10_10_2: case gl::GL_UNSIGNED_INT_2_10_10_10_REV:
+            case gl::GL_UNSIGNED_INT_10F_11F_11F_REV: case gl::GL_UNSIGNED_INT_5_9_9_9_REV:
+            case gl::GL_UNSIGNED_INT_24_8:
+                return 4;
+            case gl::GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+                return 8;
+            default:
+                break;
+            }
+
+            std::size_t components = 1;
+            switch (format) {
+            case gl::GL_RG: case gl::GL_RG_INTEGER: components = 2; break;
+            case gl::GL_RGB: case gl::GL_BGR: case gl::GL_RGB_INTEGER: case gl::GL_BGR_INTEGER: components = 3; break;
+            case gl::GL_RGBA: case gl::GL_BGRA: case gl::GL_RGBA_INTEGER: case gl::GL_BGRA_INTEGER: components = 4; break; //-V112
+            default: break;
+            }
+
+            switch (type) {
+            case gl::GL_SHORT: case gl::GL_UNSIGNED_SHORT: case gl::GL_HALF_FLOAT: return components * 2;
+            case gl::GL_INT: case gl::GL_UNSIGNED_INT: case gl::GL_FLOAT: return components * 4;
+            default: return components;
+            }
+        }
+
+        /** Returns whether texture data is read from a buffer instead of client memory. */
+        bool IsUnpackBufferBound()
+        {
+            gl::GLint unpackBuffer = 0;
+            gl::glGetIntegerv(gl::GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+            return unpackBuffer != 0;
+        }
+
+        /** Returns a pixel unpack parameter, negative (invalid) values are returned as 0. */
+        std::size_t GetUnpackParameter(gl::GLenum pname)
+        {
+            gl::GLint value = 0;
+            gl::glGetIntegerv(pname, &value);
+            return static_cast<std::size_t>(std::max(value, 0));
+        }
+
+        /**
+         *  Returns the size of the client memory read by a texture upload. The pixel unpack state is applied as in the
+         *  GL specification: rows are padded to the alignment, are GL_UNPACK_ROW_LENGTH pixels long and images are
+         *  GL_UNPACK_IMAGE_HEIGHT rows high if these are set, and the skipped pixels, rows and images are read as well.
+         *  @param dimensions the number of dimensions of the upload.
+         *  @param width the width of the uploaded pixels.
+         *  @param height the height of the uploaded pixels (1 for 1D uploads).
+         *  @param depth the depth of the uploaded pixels (1 for 1D and 2D uploads).
+         *  @param format the format of the pixels.
+         *  @param type the type of the pixels.
+         */
+        std::size_t GetTextureDataSize(std::size_t dimensions, gl::GLsizei width, gl::GLsizei height, gl::GLsizei depth, gl::GLenum format, gl::GLenum type)
+        {
+            if (width <= 0 || height <= 0 || depth <= 0 || IsUnpackBufferBound()) return 0;
+
+            auto pixelSize = GetPixelSize(format, type);
+            auto alignment = std::max<std::size_t>(GetUnpackParameter(gl::GL_UNPACK_ALIGNMENT), 1);
+            auto rowLength = GetUnpackParameter(gl::GL_UNPACK_ROW_LENGTH);
+            auto rowSize = (rowLength > 0 ? rowLength : static_cast<std::size_t>(width)) * pixelSize;
+            auto rowStride = (rowSize + alignment - 1) / alignment * alignment;
+
+            // the last row is not padded.
+            auto size = (GetUnpackParameter(gl::GL_UNPACK_SKIP_PIXELS) + static_cast<std::size_t>(width)) * pixelSize;
+            if (dimensions >= 2) size += (GetUnpackParameter(gl::GL_UNPACK_SKIP_ROWS) + static_cast<std::size_t>(height) - 1) * rowStride;
+            if (dimensions >= 3) {
+                auto imageHeight = GetUnpackParameter(gl::GL_UNPACK_IMAGE_HEIGHT);
+                auto imageStride = (imageHeight > 0 ? imageHeight : static_cast<std::size_t>(height)) * rowStride;
+                size += (GetUnpackParameter(gl::GL_UNPACK_SKIP_IMAGES) + static_cast<std::size_t>(depth) - 1) * imageStride;
+            }
+            return size;
+        }
+
+        /**
+         *  Returns the functions supported by the capture: the object creation, state changes, uniform updates, data
+         *  uploads, draws and dispatches issued per frame by the enh classes, the core full screen quads and frame
+         *  buffers, and the creation of the programs and textures of the enh classes.
+         */
+        const std::vector<CommandType>& GetCommandTypes()
+        {
+            using namespace gl;
+            static const std::vector<CommandType> commandTypes{
+                MakeCreateCommand("glGenBuffers", &glGenBuffers, ObjectType::Buffer),
+                MakeCreateCommand("glCreateBuffers", &glCreateBuffers, ObjectType::Buffer),
+                MakeCreateCommand("glGenTextures", &glGenTextures, ObjectType::Texture),
+                MakeCreateCommand("glCreateTextures", &glCreateTextures, ObjectType::Texture),
+                MakeCreateCommand("glGenFramebuffers", &glGenFramebuffers, ObjectType::Framebuffer),
+                MakeCreateCommand("glCreateFramebuffers", &glCreateFramebuffers, ObjectType::Framebuffer),
+                MakeCreateCommand("glGenVertexArrays", &glGenVertexArrays, ObjectType::VertexArray),
+                MakeCreateCommand("glCreateVertexArrays", &glCreateVertexArrays, ObjectType::VertexArray),
+                MakeCreateCommand("glGenSamplers", &glGenSamplers, ObjectType::Sampler),
+                MakeCreateCommand("glCreateSamplers", &glCreateSamplers, ObjectType::Sampler),
+                MakeCreateCommand("glGenQueries", &glGenQueries, ObjectType::Query),
+                MakeCreateCommand("glCreateQueries", &glCreateQueries, ObjectType::Query),
+                MakeDeleteCommand("glDeleteBuffers", &glDeleteBuffers, ObjectType::Buffer),
+                MakeDeleteCommand("glDeleteTextures", &glDeleteTextures, ObjectType::Texture),
+                MakeDeleteCommand("glDeleteFramebuffers", &glDeleteFramebuffers, ObjectType::Framebuffer),
+                MakeDeleteCommand("glDeleteVertexArrays", &glDeleteVertexArrays, ObjectType::VertexArray),
+                MakeDeleteCommand("glDeleteSamplers", &glDeleteSamplers, ObjectType::Sampler),
+                MakeDeleteCommand("glDeleteQueries", &glDeleteQueries, ObjectType::Query),
+                MakeCreateReturnCommand("glCreateShader", &glCreateShader, ObjectType::Shader),
+                MakeCreateReturnCommand("glCreateProgram", &glCreateProgram, ObjectType::Program),
+                MakeDeleteSingleCommand("glDeleteShader", &glDeleteShader, ObjectType::Shader),
+                MakeDeleteSingleCommand("glDeleteProgram", &glDeleteProgram, ObjectType::Program),
+                MakeShaderSourceCommand(),
+                MakeObjectCommand("glCompileShader", &glCompileShader, { { 0, ObjectType::Shader } }),
+                MakeObjectCommand("glAttachShader", &glAttachShader, { { 0, ObjectType::Program }, { 1, ObjectType::Shader } }),
+                MakeObjectCommand("glDetachShader", &glDetachShader, { { 0, ObjectType::Program }, { 1, ObjectType::Shader } }),
+                MakeObjectCommand("glLinkProgram", &glLinkProgram, { { 0, ObjectType::Program } }),
+                MakeObjectCommand("glProgramParameteri", &glProgramParameteri, { { 0, ObjectType::Program } }),
+                MakeObjectCommand("glProgramBinary", &glProgramBinary, { { 0, ObjectType::Program } }, ArgumentSize<3>{}),
+                MakeObjectCommand("glUniformBlockBinding", &glUniformBlockBinding, { { 0, ObjectType::Program } }),
+                MakeObjectCommand("glShaderStorageBlockBinding", &glShaderStorageBlockBinding, { { 0, ObjectType::Program } }),
+                MakeObjectCommand("glUseProgram", &glUseProgram, { { 0, ObjectType::Program } }),
+                MakeCommand("glActiveTexture", &glActiveTexture),
+                MakeObjectCommand("glBindTexture", &glBindTexture, { { 1, ObjectType::Texture } }),
+                MakeObjectCommand("glBindSampler", &glBindSampler, { { 1, ObjectType::Sampler } }),
+                MakeObjectCommand("glBindImageTexture", &glBindImageTexture, { { 1, ObjectType::Texture } }),
+                MakeObjectCommand("glBindBuffer", &glBindBuffer, { { 1, ObjectType::Buffer } }),
+                MakeObjectCommand("glBindBufferBase", &glBindBufferBase, { { 2, ObjectType::Buffer } }),
+                MakeObjectCommand("glBindBufferRange", &glBindBufferRange, { { 2, ObjectType::Buffer } }),
+                MakeObjectCommand("glBindVertexArray", &glBindVertexArray, { { 0, ObjectType::VertexArray } }),
+                MakeObjectCommand("glBindFramebuffer", &glBindFramebuffer, { { 1, ObjectType::Framebuffer } }),
+                MakeObjectCommand("glFramebufferTexture", &glFramebufferTexture, { { 2, ObjectType::Texture } }),
+                MakeObjectCommand("glFramebufferTexture2D", &glFramebufferTexture2D, { { 3, ObjectType::Texture } }),
+                MakeCommand("glDrawBuffers", &glDrawBuffers, ArraySize<0, 1, GLenum>{}),
+                MakeCommand("glViewport", &glViewport),
+                MakeCommand("glScissor", &glScissor),
+                MakeCommand("glEnable", &glEnable),
+                MakeCommand("glDisable", &glDisable),
+                MakeCommand("glBlendFunc", &glBlendFunc),
+                MakeCommand("glBlendEquation", &glBlendEquation),
+                MakeCommand("glDepthMask", &glDepthMask),
+                MakeCommand("glDepthFunc", &glDepthFunc),
+                MakeCommand("glColorMask", &glColorMask),
+                MakeCommand("glCullFace", &glCullFace),
+                MakeCommand("glClearColor", &glClearColor),
+                MakeCommand("glClearDepth", &glClearDepth),
+                MakeCommand("glClear", &glClear),
+                MakeCommand("glEnableVertexAttribArray", &glEnableVertexAttribArray),
+                MakeCommand("glDisableVertexAttribArray", &glDisableVertexAttribArray),
+                MakeCommand("glVertexAttribPointer", &glVertexAttribPointer),
+                MakeCommand("glVertexAttribIPointer", &glVertexAttribIPointer),
+                MakeCommand("glUniform1i", &glUniform1i),
+                MakeCommand("glUniform1ui", &glUniform1ui),
+                MakeCommand("glUniform1f", &glUniform1f),
+                MakeCommand("glUniform2f", &glUniform2f),
+                MakeCommand("glUniform3f", &glUniform3f),
+                MakeCommand("glUniform4f", &glUniform4f),
+                MakeCommand("glUniform1iv", &glUniform1iv, ArraySize<1, 1, GLint>{}),
+                MakeCommand("glUniform2uiv", &glUniform2uiv, ArraySize<1, 2, GLuint>{}),
+                MakeCommand("glUniform1fv", &glUniform1fv, ArraySize<1, 1, GLfloat>{}),
+                MakeCommand("glUniform2fv", &glUniform2fv, ArraySize<1, 2, GLfloat>{}),
+                MakeCommand("glUniform3fv", &glUniform3fv, ArraySize<1, 3, GLfloat>{}),
+                MakeCommand("glUniform4fv", &glUniform4fv, ArraySize<1, 4, GLfloat>{}),
+                MakeCommand("glUniformMatrix3fv", &glUniformMatrix3fv, ArraySize<1, 9, GLfloat>{}),
+                MakeCommand("glUniformMatrix4fv", &glUniformMatrix4fv, ArraySize<1, 16, GLfloat>{}),
+                MakeCommand("glBufferData", &glBufferData, ArgumentSize<1>{}),
+                MakeCommand("glBufferSubData", &glBufferSubData, ArgumentSize<2>{}),
+                MakeObjectCommand("glNamedBufferData", &glNamedBufferData, { { 0, ObjectType::Buffer } }, ArgumentSize<1>{}),
+                MakeObjectCommand("glNamedBufferSubData", &glNamedBufferSubData, { { 0, ObjectType::Buffer } }, ArgumentSize<2>{}),
+                MakeObjectCommand("glCopyNamedBufferSubData", &glCopyNamedBufferSubData, { { 0, ObjectType::Buffer }, { 1, ObjectType::Buffer } }),
+                MakeCommand("glPixelStorei", &glPixelStorei),
+                MakeCommand("glTexParameteri", &glTexParameteri),
+                MakeCommand("glTexParameterfv", &glTexParameterfv, [](const auto& a) {
+                    return (std::get<1>(a) == GL_TEXTURE_BORDER_COLOR ? 4 : 1) * sizeof(GLfloat); }),
+                MakeCommand("glTexStorage1D", &glTexStorage1D),
+                MakeCommand("glTexStorage2D", &glTexStorage2D),
+                MakeCommand("glTexStorage3D", &glTexStorage3D),
+                MakeObjectCommand("glTextureView", &glTextureView, { { 0, ObjectType::Texture }, { 2, ObjectType::Texture } }),
+                MakeCommand("glTexImage2D", &glTexImage2D, [](const auto& a) {
+                    return GetTextureDataSize(2, std::get<3>(a), std::get<4>(a), 1, std::get<6>(a), std::get<7>(a)); }),
+                MakeCommand("glTexImage3D", &glTexImage3D, [](const auto& a) {
+                    return GetTextureDataSize(3, std::get<3>(a), std::get<4>(a), std::get<5>(a), std::get<7>(a), std::get<8>(a)); }),
+                MakeCommand("glTexSubImage1D", &glTexSubImage1D, [](const auto& a) {
+                    return GetTextureDataSize(1, std::get<3>(a), 1, 1, std::get<4>(a), std::get<5>(a)); }),
+                MakeCommand("glTexSubImage2D", &glTexSubImage2D, [](const auto& a) {
+                    return GetTextureDataSize(2, std::get<4>(a), std::get<5>(a), 1, std::get<6>(a), std::get<7>(a)); }),
+                MakeCommand("glTexSubImage3D", &glTexSubImage3D, [](const auto& a) {
+                    return GetTextureDataSize(3, std::get<5>(a), std::get<6>(a), std::get<7>(a), std::get<8>(a), std::get<9>(a)); }),
+                MakeObjectCommand("glClearTexImage", &glClearTexImage, { { 0, ObjectType::Texture } },
+                    [](const auto& a) { return GetPixelSize(std::get<2>(a), std::get<3>(a)); }),
+                MakeCommand("glGenerateMipmap", &glGenerateMipmap),
+                MakeCommand("glMemoryBarrier", &glMemoryBarrier),
+                MakeCommand("glDrawArrays", &glDrawArrays),
+                MakeCommand("glDrawArraysInstanced", &glDrawArraysInstanced),
+                MakeCommand("glDrawElements", &glDrawElements),
+                MakeCommand("glDrawElementsBaseVertex", &glDrawElementsBaseVertex),
+                MakeCommand("glDrawElementsInstancedBaseVertex", &glDrawElementsInstancedBaseVertex),
+                MakeCommand("glMultiDrawElementsIndirect", &glMultiDrawElementsIndirect),
+                MakeCommand("glDispatchCompute", &glDispatchCompute),
+                MakeCommand("glDispatchComputeIndirect", &glDispatchComputeIndirect),
+                MakeCommand("glBlitFramebuffer", &glBlitFramebuffer),
+                MakeObjectCommand("glBeginQuery", &glBeginQuery, { { 1, ObjectType::Query } }),
+                MakeCommand("glEndQuery", &glEndQuery),
+                MakeObjectCommand("glQueryCounter", &glQueryCounter, { { 0, ObjectType::Query } })
+            };
+            return commandTypes;
+        }
+
+        /** Returns the command type of each glbinding function sorted by function for binary search. */
+        const std::vector<std::pair<const glbinding::AbstractFunction*, std::uint16_t>>& GetFunctionCommandTypes()
+        {
+            static const auto functionCommandTypes = []() {
+                std::vector<std::pair<const glbinding::AbstractFunction*, std::uint16_t>> result;
+                const auto& commandTypes = GetCommandTypes();
+                for (const auto function : glbinding::Binding::functions()) {
+                    auto it = std::find_if(commandTypes.begin(), commandTypes.end(),
+                        [function](const CommandType& type) { return std::strcmp(type.name_, function->name()) == 0; });
+                    if (it != commandTypes.end()) result.emplace_back(function, static_cast<std::uint16_t>(it - commandTypes.begin()));
+                }
+                std::sort(result.begin(), result.end());
+                return result;
+            }();
+            return functionCommandTypes;
+        }
+    }
+
+    GLCommandCapture& GLCommandCapture::Get()
+    {
+        static GLCommandCapture instance;
+        return instance;
+    }
+
+    /**
+     *  Starts capturing by replacing the glbinding callback.
+     *  @param filename the file to write the capture to.
+     */
+    void GLCommandCapture::Begin(const std::string& filename)
+    {
+        GetFunctionCommandTypes();
+        filename_ = filename;
+        commands_.clear();
+        // most frames fit, so the buffer does not grow during the captured frame.
+        commands_.reserve(INITIAL_CAPTURE_SIZE);
+        numCommands_ = 0;
+        unsupportedFunctions_.clear();
+        numUnsupportedCalls_ = 0;
+        capturing_ = true;
+
+        // texture uploads are replayed with the unpack state they were captured with.
+        const auto& commandTypes = GetCommandTypes();
+        auto pixelStore = std::find_if(commandTypes.begin(), commandTypes.end(), [](const CommandType& type) { return std::strcmp(type.name_, "glPixelStorei") == 0; });
+        CommandWriter writer{ commands_ };
+        for (auto pname : UNPACK_PARAMETERS) {
+            gl::GLint value = 0;
+            gl::glGetIntegerv(pname, &value);
+            writer.Write(static_cast<std::uint16_t>(pixelStore - commandTypes.begin()));
+            writer.Write(pname);
+            writer.Write(value);
+            numCommands_ += 1;
+        }
+
+        glbinding::setCallbackMaskExcept(glbinding::CallbackMask::After | glbinding::CallbackMask::ParametersAndReturnValue, { "glGetError" });
+        glbinding::setAfterCallback([](const glbinding::FunctionCall& call) { Get().RecordCall(call); });
+    }
+
+    /**
+     *  Stops capturing, restores the callback of the GL call statistics and writes the file.
+     *  @return whether the file was written.
+     */
+    bool GLCommandCapture::End()
+    {
+        if (!capturing_) return false;
+        capturing_ = false;
+
+#ifdef ENABLE_GL_CALL_STATISTICS
+        GLCallStatistics::Get().InstallCallback();
+#else
+        glbinding::setCallbackMask(glbinding::CallbackMask::None);
+#endif
+
+        if (numUnsupportedCalls_ > 0) {
+            LOG(WARNING) << numUnsupportedCalls_ << " calls of unsupported functions were not captured:";
+            for (auto function : unsupportedFunctions_) LOG(WARNING) << "    " << function->name();
+        }
+
+        std::ofstream captureFile(filename_, std::ios::binary);
+        if (!captureFile) {
+            LOG(WARNING) << "Could not write capture file " << filename_ << ".";
+            return false;
+        }
+
+        std::vector<std::uint8_t> header;
+        CommandWriter writer{ header };
+        writer.Write(CAPTURE_MAGIC);
+        writer.Write(CAPTURE_VERSION);
+        const auto& commandTypes = GetCommandTypes();
+        writer.Write(static_cast<std::uint32_t>(commandTypes.size()));
+        for (const auto& type : commandTypes) {
+            auto nameLength = static_cast<std::uint16_t>(std::strlen(type.name_));
+            writer.Write(nameLength);
+            writer.WriteBytes(type.name_, nameLength);
+        }
+        writer.Write(numCommands_);
+
+        captureFile.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        captureFile.write(reinterpret_cast<const char*>(commands_.data()), static_cast<std::streamsize>(commands_.size()));
+        LOG(INFO) << "Captured " << numCommands_ << " GL commands to " << filename_ << ".";
+        return true;
+    }
+
+    void GLCommandCapture::RecordCall(const glbinding::FunctionCall& call)
+    {
+        if (recordingCall_) return;
+#ifdef ENABLE_GL_CALL_STATISTICS
+        GLCallStatistics::Get().AddCall(call.function);
+#endif
+
+        const auto& functionCommandTypes = GetFunctionCommandTypes();
+        auto it = std::lower_bound(functionCommandTypes.begin(), functionCommandTypes.end(), call.function,
+            [](const auto& entry, const glbinding::AbstractFunction* function) { return entry.first < function; });
+        if (it == functionCommandTypes.end() || it->first != call.function) {
+            numUnsupportedCalls_ += 1;
+            if (std::find(unsupportedFunctions_.begin(), unsupportedFunctions_.end(), call.function) == unsupportedFunctions_.end()) {
+                unsupportedFunctions_.push_back(call.function);
+            }
+            return;
+        }
+
+        // the payload size of texture uploads queries GL state, these calls are not recorded.
+        recordingCall_ = true;
+        CommandWriter writer{ commands_ };
+        writer.Write(it->second);
+        GetCommandTypes()[it->second].record_(call, writer);
+        numCommands_ += 1;
+        recordingCall_ = false;
+    }
+
+    /**
+     *  Loads and decodes a capture file.
+     *  @param filename the file to load.
+     */
+    GLCommandReplay::GLCommandReplay(const std::string& filename) :
+        objectNames_{ std::make_unique<GLReplayObjectNames>() }
+    {
+        std::ifstream captureFile(filename, std::ios::binary);
+        if (!captureFile) {
+            LOG(WARNING) << "Could not open capture file " << filename << ".";
+            throw std::runtime_error("Could not open capture file \"" + filename + "\".");
+        }
+        std::vector<std::uint8_t> data{ std::istreambuf_iterator<char>(captureFile), std::istreambuf_iterator<char>() };
+
+        CommandReader reader{ data };
+        if (reader.Read<std::array<char, 8>>() != CAPTURE_MAGIC || reader.Read<std::uint32_t>() != CAPTURE_VERSION) {
+            LOG(WARNING) << "File " << filename << " is not a capture of this version.";
+            throw std::runtime_error("File \"" + filename + "\" is not a capture of this version.");
+        }
+
+        // the types are stored by name, so captures stay readable when functions are added.
+        const auto& commandTypes = GetCommandTypes();
+        std::vector<const CommandType*> fileCommandTypes(reader.Read<std::uint32_t>(), nullptr);
+        for (auto& fileType : fileCommandTypes) {
+            std::string name(reader.Read<std::uint16_t>(), '\0');
+            reader.ReadBytes(name.data(), name.size());
+            auto it = std::find_if(commandTypes.begin(), commandTypes.end(), [&name](const CommandType& type) { return name == type.name_; });
+            if (it != commandTypes.end()) fileType = &*it;
+        }
+
+        commands_.resize(reader.Read<std::uint32_t>());
+        for (auto& command : commands_) {
+            auto typeIndex = reader.Read<std::uint16_t>();
+            if (typeIndex >= fileCommandTypes.size() || !fileCommandTypes[typeIndex]) {
+                LOG(WARNING) << "Capture " << filename << " contains an unknown command.";
+                throw std::runtime_error("Capture \"" + filename + "\" contains an unknown command.");
+            }
+            command = fileCommandTypes[typeIndex]->load_(reader, payloads_, *objectNames_);
+        }
+    }
+
+    /** Deletes the objects created by the replay, needs the context the replay ran in. */
+    GLCommandReplay::~GLCommandReplay() = default;
+
+    /**
+     *  Replaces the default frame buffer of the capture, e.g. for replaying in a context without a window.
+     *  @param framebuffer the frame buffer object bound instead of frame buffer 0.
+     */
+    void GLCommandReplay::SetDefaultFramebuffer(std::uint32_t framebuffer)
+    {
+        objectNames_->SetDefaultFramebuffer(framebuffer);
+    }
+
+    /** Executes all commands. */
+    void GLCommandReplay::Replay() const
+    {
+        for (const auto& command : commands_) command();
+    }
+
+    /**
+     *  Replays the commands several times after a warm up replay.
+     *  @param iterations the number of measured replays.
+     *  @return the average times per replay.
+     */
+    GLCommandReplay::Result GLCommandReplay::Benchmark(std::size_t iterations) const
+    {
+        Replay();
+        gl::glFinish();
+
+        Result result{ {}, {} };
+        for (std::size_t i = 0; i < iterations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            Replay();
+            auto submitted = std::chrono::steady_clock::now();
+            gl::glFinish();
+            auto finished = std::chrono::steady_clock::now();
+            result.cpuTime_ += submitted - start;
+            result.totalTime_ += finished - start;
+        }
+
+        if (iterations > 0) {
+            result.cpuTime_ /= static_cast<double>(iterations);
+            result.totalTime_ /= static_cast<double>(iterations);
+        }
+        return result;
+    }
+}
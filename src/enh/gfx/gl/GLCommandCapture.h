@@ -0,0 +1,113 @@
+/**
+ * @file   GLCommandCapture.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the binary capture and replay of OpenGL commands.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace glbinding {
+    class AbstractFunction;
+    struct FunctionCall;
+}
+
+namespace viscom::enh {
+
+    class GLReplayObjectNames;
+
+    /**
+     * @brief  Records the OpenGL calls between Begin() and End() into a compact binary file.
+     *
+     *  Uses a glbinding after callback with parameters. Each call of a supported function is written as its index
+     *  followed by the raw parameter values, client memory read by the call (buffer and texture data, uniform arrays,
+     *  draw buffers) is stored as payload. The size of texture data follows the pixel unpack state, which is recorded
+     *  at the start of the capture. Pointers into bound buffers are stored as offsets. The names of created buffers,
+     *  textures, frame buffers, vertex arrays, samplers, queries, shaders and programs are recorded so the replay can
+     *  remap them; shader sources are stored as one string per call. Calls of other functions (state queries,
+     *  mapping, synchronization) are not recorded and reported when the capture ends. The data is kept in memory and
+     *  written in End(), so the capture does not do file I/O during the frame. A capture that also covers the creation
+     *  of the programs and textures (i.e. begun right after glbinding is initialized) can be replayed in another
+     *  context; programs restored from the program binary cache are recorded as binaries and only replay with the
+     *  same driver.
+     *  While capturing, the GL call statistics are still updated; the debug callback of the DebugOpenGLCalls
+     *  configuration is not restored.
+     */
+    class GLCommandCapture final
+    {
+    public:
+        static GLCommandCapture& Get();
+
+        void Begin(const std::string& filename);
+        bool End();
+        /** Returns whether a capture is running. */
+        bool IsCapturing() const { return capturing_; }
+
+    private:
+        GLCommandCapture() = default;
+        void RecordCall(const glbinding::FunctionCall& call);
+
+        /** Holds the file to write. */
+        std::string filename_;
+        /** Holds whether a capture is running. */
+        bool capturing_ = false;
+        /** Holds whether a call is being recorded, GL calls made while recording are ignored. */
+        bool recordingCall_ = false;
+        /** Holds the recorded commands. */
+        std::vector<std::uint8_t> commands_;
+        /** Holds the number of recorded commands. */
+        std::uint32_t numCommands_ = 0;
+        /** Holds the functions that were called but are not supported. */
+        std::vector<const glbinding::AbstractFunction*> unsupportedFunctions_;
+        /** Holds the number of calls that were not recorded. */
+        std::size_t numUnsupportedCalls_ = 0;
+    };
+
+    /**
+     * @brief  Replays a file written by GLCommandCapture in the current context.
+     *
+     *  The commands are decoded when loading, replaying only executes them, so repeated replays measure the driver
+     *  side cost of the captured commands without the application. Objects created by the capture are created again
+     *  and references to them are remapped when replaying, each replay recreates them and the objects of the previous
+     *  replay are deleted. Objects created before the capture began are used by their captured names, so captures of
+     *  single frames replay only in the context they were made in. Self-contained captures (see GLCommandCapture)
+     *  replay in any context, also without a window when the default frame buffer is replaced.
+     */
+    class GLCommandReplay final
+    {
+    public:
+        /** The timings of a replay. */
+        struct Result
+        {
+            /** Holds the CPU time needed to submit the commands per iteration. */
+            std::chrono::duration<double, std::milli> cpuTime_;
+            /** Holds the time until the GPU finished per iteration. */
+            std::chrono::duration<double, std::milli> totalTime_;
+        };
+
+        explicit GLCommandReplay(const std::string& filename);
+        ~GLCommandReplay();
+
+        /** Returns the number of commands loaded. */
+        std::size_t GetNumCommands() const { return commands_.size(); }
+        void SetDefaultFramebuffer(std::uint32_t framebuffer);
+        void Replay() const;
+        Result Benchmark(std::size_t iterations) const;
+
+    private:
+        /** Holds the decoded commands. */
+        std::vector<std::function<void()>> commands_;
+        /** Holds the payloads referenced by the commands, stored as 64 bit words for alignment. */
+        std::vector<std::unique_ptr<std::uint64_t[]>> payloads_;
+        /** Holds the names of the objects created by the replay, the commands reference it. */
+        std::unique_ptr<GLReplayObjectNames> objectNames_;
+    };
+}
@@ -0,0 +1,180 @@
+/**
+ * @file   GLProgram.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of a shader program linked through the program binary cache.
+ */
+
+#include "GLProgram.h"
+#include "ProgramBinaryCache.h"
+#include "core/main.h"
+#include "enh/ApplicationNodeBase.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace viscom::enh {
+
+    namespace {
+
+        /** The maximum nesting of includes, deeper nesting is most likely an include cycle. */
+        constexpr std::size_t MAX_INCLUDE_DEPTH = 16;
+
+        /** Returns the shader type for the extension of a shader file. */
+        gl::GLenum GetShaderType(const std::string& filename)
+        {
+            auto extension = std::filesystem::path(filename).extension().string();
+            if (extension == ".vert") return gl::GL_VERTEX_SHADER;
+            if (extension == ".tesc") return gl::GL_TESS_CONTROL_SHADER;
+            if (extension == ".tese") return gl::GL_TESS_EVALUATION_SHADER;
+            if (extension == ".geom") return gl::GL_GEOMETRY_SHADER;
+            if (extension == ".frag") return gl::GL_FRAGMENT_SHADER;
+            if (extension == ".comp") return gl::GL_COMPUTE_SHADER;
+
+            LOG(FATAL) << "Unknown shader type of file " << filename << ".";
+            throw std::runtime_error("Unknown shader type of file " + filename + ".");
+        }
+
+        /** Reads a shader file and replaces its includes by the included files. */
+        std::string ReadShaderFile(const std::filesystem::path& filename, std::size_t depth)
+        {
+            std::ifstream file(filename);
+            if (!file || depth > MAX_INCLUDE_DEPTH) {
+                LOG(FATAL) << "Could not read shader file " << filename.string() << ".";
+                throw std::runtime_error("Could not read shader file " + filename.string() + ".");
+            }
+
+            std::stringstream source;
+            std::string line;
+            while (std::getline(file, line)) {
+                auto directive = line.find_first_not_of(" \t");
+                auto nameBegin = line.find('"');
+                auto nameEnd = line.rfind('"');
+                if (directive != std::string::npos && line.compare(directive, 8, "#include") == 0 && nameBegin < nameEnd) {
+                    source << ReadShaderFile(filename.parent_path() / line.substr(nameBegin + 1, nameEnd - nameBegin - 1), depth + 1);
+                } else source << line << '\n';
+            }
+            return source.str();
+        }
+
+        /** Returns the info log of a shader or program. */
+        template<typename GetParameter, typename GetInfoLog>
+        std::string GetInfoLogString(gl::GLuint object, GetParameter getParameter, GetInfoLog getInfoLog)
+        {
+            gl::GLint logLength = 0;
+            getParameter(object, gl::GL_INFO_LOG_LENGTH, &logLength);
+            std::string infoLog(static_cast<std::size_t>(std::max(logLength, 1)), '\0');
+            getInfoLog(object, logLength, nullptr, infoLog.data());
+            return infoLog;
+        }
+    }
+
+    GLProgram::GLProgram(const std::vector<std::string>& shaderFiles, ApplicationNodeBase* app) :
+        GLProgram(shaderFiles, std::vector<std::string>{}, app)
+    {
+    }
+
+    /**
+     *  Creates the program with the shader directory and binary cache of the application.
+     *  @param shaderFiles the shader files relative to the shader directory.
+     *  @param defines the defines to compile the shaders with.
+     *  @param app the application.
+     */
+    GLProgram::GLProgram(const std::vector<std::string>& shaderFiles, const std::vector<std::string>& defines, ApplicationNodeBase* app) :
+        GLProgram(shaderFiles, defines, app->GetShaderDirectory(), app->GetProgramBinaryCache())
+    {
+    }
+
+    /**
+     *  Creates the program, it is loaded from the binary cache if possible and compiled otherwise.
+     *  @param shaderFiles the shader files relative to the shader directory.
+     *  @param defines the defines to compile the shaders with.
+     *  @param shaderDirectory the directory the shaders are loaded from.
+     *  @param binaryCache the binary cache to use (may be nullptr).
+     */
+    GLProgram::GLProgram(const std::vector<std::string>& shaderFiles, const std::vector<std::string>& defines, const std::string& shaderDirectory,
+        ProgramBinaryCache* binaryCache) :
+        shaderFiles_{ shaderFiles }
+    {
+        std::vector<std::string> sources;
+        for (const auto& shaderFile : shaderFiles_) sources.push_back(LoadShaderSource(shaderDirectory + "/" + shaderFile, defines));
+
+        auto link = [this, &sources]() { return CompileAndLink(sources); };
+        auto linked = binaryCache ? binaryCache->LoadOrLink(program_, ProgramBinaryCache::CreateKey(sources, defines), link) : link();
+        if (!linked) {
+            LOG(FATAL) << "Could not link program " << shaderFiles_.front() << ".";
+            throw std::runtime_error("Could not link program " + shaderFiles_.front() + ".");
+        }
+    }
+
+    GLProgram::~GLProgram() = default;
+
+    std::vector<gl::GLint> GLProgram::GetUniformLocations(const std::vector<std::string>& names) const
+    {
+        std::vector<gl::GLint> locations;
+        for (const auto& name : names) locations.push_back(gl::glGetUniformLocation(program_, name.c_str()));
+        return locations;
+    }
+
+    std::vector<gl::GLint> GLProgram::GetAttributeLocations(const std::vector<std::string>& names) const
+    {
+        std::vector<gl::GLint> locations;
+        for (const auto& name : names) locations.push_back(gl::glGetAttribLocation(program_, name.c_str()));
+        return locations;
+    }
+
+    /**
+     *  Loads a shader file with its includes and inserts the defines after the #version line.
+     *  @param filename the shader file.
+     *  @param defines the defines to insert.
+     *  @return the preprocessed source.
+     */
+    std::string GLProgram::LoadShaderSource(const std::string& filename, const std::vector<std::string>& defines)
+    {
+        auto source = ReadShaderFile(filename, 0);
+
+        auto versionLine = source.find("#version");
+        auto insertPosition = versionLine == std::string::npos ? 0 : std::min(source.find('\n', versionLine), source.size() - 1) + 1;
+        auto lineNumber = std::count(source.begin(), source.begin() + insertPosition, '\n') + 1;
+
+        std::string defineLines;
+        for (const auto& define : defines) defineLines += "#define " + define + "\n";
+        // keeps the line numbers of compiler messages matching the file.
+        defineLines += "#line " + std::to_string(lineNumber) + "\n";
+        return source.insert(insertPosition, defineLines);
+    }
+
+    /** Compiles the shaders from their sources and links the program, errors are logged. */
+    bool GLProgram::CompileAndLink(const std::vector<std::string>& sources)
+    {
+        std::vector<ShaderRAII> shaders;
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            shaders.emplace_back(gl::glCreateShader(GetShaderType(shaderFiles_[i])));
+            auto sourcePtr = sources[i].c_str();
+            gl::glShaderSource(shaders.back(), 1, &sourcePtr, nullptr);
+            gl::glCompileShader(shaders.back());
+
+            gl::GLint compileStatus = 0;
+            gl::glGetShaderiv(shaders.back(), gl::GL_COMPILE_STATUS, &compileStatus);
+            if (compileStatus == 0) {
+                LOG(WARNING) << "Could not compile shader " << shaderFiles_[i] << ":\n" << GetInfoLogString(shaders.back(), gl::glGetShaderiv, gl::glGetShaderInfoLog);
+                return false;
+            }
+            gl::glAttachShader(program_, shaders.back());
+        }
+
+        gl::glLinkProgram(program_);
+        for (const auto& shader : shaders) gl::glDetachShader(program_, shader);
+
+        gl::GLint linkStatus = 0;
+        gl::glGetProgramiv(program_, gl::GL_LINK_STATUS, &linkStatus);
+        if (linkStatus == 0) {
+            LOG(WARNING) << "Could not link program " << shaderFiles_.front() << ":\n" << GetInfoLogString(program_, gl::glGetProgramiv, gl::glGetProgramInfoLog);
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * @file   GLProgram.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of a shader program linked through the program binary cache.
+ */
+
+#pragma once
+
+#include "enh/main.h"
+#include <string>
+#include <vector>
+
+namespace viscom::enh {
+
+    class ApplicationNodeBase;
+    class ProgramBinaryCache;
+
+    /**
+     * @brief  A program compiled from shader files and restored from the program binary cache when possible.
+     *
+     *  The shader type is taken from the file extension (.vert, .tesc, .tese, .geom, .frag or .comp). Includes
+     *  (#include "file") are resolved relative to the including file and the defines are inserted after the #version
+     *  line ("NAME" or "NAME VALUE"). The preprocessed sources and defines form the key of the binary cache (see
+     *  ProgramBinaryCache::CreateKey()), so changing a shader or an included file compiles the program again.
+     */
+    class GLProgram final
+    {
+    public:
+        GLProgram(const std::vector<std::string>& shaderFiles, ApplicationNodeBase* app);
+        GLProgram(const std::vector<std::string>& shaderFiles, const std::vector<std::string>& defines, ApplicationNodeBase* app);
+        GLProgram(const std::vector<std::string>& shaderFiles, const std::vector<std::string>& defines, const std::string& shaderDirectory,
+            ProgramBinaryCache* binaryCache);
+        GLProgram(const GLProgram&) = delete;
+        GLProgram& operator=(const GLProgram&) = delete;
+        ~GLProgram();
+
+        /** Returns the OpenGL program name. */
+        gl::GLuint GetProgramId() const { return program_; }
+        std::vector<gl::GLint> GetUniformLocations(const std::vector<std::string>& names) const;
+        std::vector<gl::GLint> GetAttributeLocations(const std::vector<std::string>& names) const;
+
+        static std::string LoadShaderSource(const std::string& filename, const std::vector<std::string>& defines);
+
+    private:
+        bool CompileAndLink(const std::vector<std::string>& sources);
+
+        /** Holds the shader files. */
+        std::vector<std::string> shaderFiles_;
+        /** Holds the program. */
+        ProgramRAII program_;
+    };
+}
@@ -0,0 +1,158 @@
+/**
+ * @file   GLStateCache.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of a shadow copy of the OpenGL binding state.
+ */
+
+#include "GLStateCache.h"
+
+#include <limits>
+
+namespace viscom::enh {
+
+    namespace {
+        /** Object name used for state not known to the cache. */
+        constexpr gl::GLuint unknownName = std::numeric_limits<gl::GLuint>::max();
+        /** Size used for indexed bindings of whole buffers. */
+        constexpr gl::GLsizeiptr wholeBuffer = -1;
+    }
+
+    GLStateCache::GLStateCache()
+    {
+        Invalidate();
+    }
+
+    /** Forgets all tracked state, the next change of each binding will be issued. */
+    void GLStateCache::Invalidate()
+    {
+        program_ = unknownName;
+        activeTextureUnit_ = unknownName;
+        textures_.fill(TextureBinding{ gl::GL_NONE, unknownName });
+        samplers_.fill(unknownName);
+        for (auto& target : buffers_) {
+            target.buffer_ = unknownName;
+            target.indexed_.fill(IndexedBufferBinding{ unknownName, 0, wholeBuffer });
+        }
+        vertexArray_ = unknownName;
+    }
+
+    /**
+     *  Forgets the state that may have been changed by code not using the cache.
+     *  This is all state unless exclusive access is set and only the vertex array binding otherwise.
+     */
+    void GLStateCache::InvalidateExternalState()
+    {
+        if (exclusiveAccess_) vertexArray_ = unknownName;
+        else Invalidate();
+    }
+
+    void GLStateCache::UseProgram(gl::GLuint program)
+    {
+        if (Elide(program_ == program)) return;
+        gl::glUseProgram(program);
+        program_ = program;
+    }
+
+    /**
+     *  Binds a texture to a texture unit.
+     *  @param unit the index of the texture unit (not GL_TEXTURE0 + index).
+     *  @param target the texture target.
+     *  @param texture the texture to bind.
+     */
+    void GLStateCache::BindTexture(gl::GLuint unit, gl::GLenum target, gl::GLuint texture)
+    {
+        auto tracked = unit < MAX_TRACKED_BINDINGS;
+        if (Elide(tracked && textures_[unit].target_ == target && textures_[unit].texture_ == texture)) return;
+
+        if (!Elide(activeTextureUnit_ == unit)) {
+            gl::glActiveTexture(gl::GL_TEXTURE0 + unit);
+            activeTextureUnit_ = unit;
+        }
+        gl::glBindTexture(target, texture);
+        if (tracked) textures_[unit] = TextureBinding{ target, texture };
+    }
+
+    void GLStateCache::BindSampler(gl::GLuint unit, gl::GLuint sampler)
+    {
+        auto tracked = unit < MAX_TRACKED_BINDINGS;
+        if (Elide(tracked && samplers_[unit] == sampler)) return;
+        gl::glBindSampler(unit, sampler);
+        if (tracked) samplers_[unit] = sampler;
+    }
+
+    void GLStateCache::BindBuffer(gl::GLenum target, gl::GLuint buffer)
+    {
+        auto& bindings = GetBufferTarget(target);
+        if (Elide(bindings.buffer_ == buffer)) return;
+        gl::glBindBuffer(target, buffer);
+        bindings.buffer_ = buffer;
+    }
+
+    void GLStateCache::BindBufferBase(gl::GLenum target, gl::GLuint index, gl::GLuint buffer)
+    {
+        auto& bindings = GetBufferTarget(target);
+        auto tracked = index < MAX_TRACKED_BINDINGS;
+        if (Elide(tracked && bindings.indexed_[index].buffer_ == buffer && bindings.indexed_[index].size_ == wholeBuffer)) return;
+        gl::glBindBufferBase(target, index, buffer);
+        // binding an indexed target also binds the generic one.
+        bindings.buffer_ = buffer;
+        if (tracked) bindings.indexed_[index] = IndexedBufferBinding{ buffer, 0, wholeBuffer };
+    }
+
+    void GLStateCache::BindBufferRange(gl::GLenum target, gl::GLuint index, gl::GLuint buffer, gl::GLintptr offset, gl::GLsizeiptr size)
+    {
+        auto& bindings = GetBufferTarget(target);
+        auto tracked = index < MAX_TRACKED_BINDINGS;
+        const auto& current = bindings.indexed_[tracked ? index : 0];
+        if (Elide(tracked && current.buffer_ == buffer && current.offset_ == offset && current.size_ == size)) return;
+        gl::glBindBufferRange(target, index, buffer, offset, size);
+        bindings.buffer_ = buffer;
+        if (tracked) bindings.indexed_[index] = IndexedBufferBinding{ buffer, offset, size };
+    }
+
+    void GLStateCache::BindVertexArray(gl::GLuint vertexArray)
+    {
+        if (Elide(vertexArray_ == vertexArray)) return;
+        gl::glBindVertexArray(vertexArray);
+        vertexArray_ = vertexArray;
+    }
+
+    /** Forgets the bindings of a texture that is about to be deleted. */
+    void GLStateCache::ForgetTexture(gl::GLuint texture)
+    {
+        for (auto& binding : textures_) if (binding.texture_ == texture) binding = TextureBinding{ gl::GL_NONE, unknownName };
+    }
+
+    /** Forgets the bound program if it is about to be deleted, it stays in use until another program is bound. */
+    void GLStateCache::ForgetProgram(gl::GLuint program)
+    {
+        if (program_ == program) program_ = unknownName;
+    }
+
+    /** Stores the statistics of the current frame and resets them, called by enh::ApplicationNodeBase::UpdateFrame(). */
+    void GLStateCache::EndFrame()
+    {
+        lastFrameStatistics_ = statistics_;
+        statistics_ = Statistics{};
+    }
+
+    GLStateCache::BufferTargetBindings& GLStateCache::GetBufferTarget(gl::GLenum target)
+    {
+        for (auto& bindings : buffers_) if (bindings.target_ == target) return bindings;
+
+        buffers_.emplace_back();
+        buffers_.back().target_ = target;
+        buffers_.back().buffer_ = unknownName;
+        buffers_.back().indexed_.fill(IndexedBufferBinding{ unknownName, 0, wholeBuffer });
+        return buffers_.back();
+    }
+
+    bool GLStateCache::Elide(bool redundant)
+    {
+        if (redundant) statistics_.elidedCalls_ += 1;
+        else statistics_.issuedCalls_ += 1;
+        return redundant;
+    }
+}
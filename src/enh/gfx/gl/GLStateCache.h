@@ -0,0 +1,111 @@
+/**
+ * @file   GLStateCache.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of a shadow copy of the OpenGL binding state.
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <glbinding/gl/gl.h>
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Shadows the OpenGL binding state to skip redundant state changes.
+     *
+     *  Only changes made through the cache are known to it. Code not using the cache (e.g. the core framework or the
+     *  application) may change the state behind its back, so the enh classes call InvalidateExternalState() at their
+     *  entry points. If the application guarantees that all changes to the tracked state go through the cache it can
+     *  set exclusive access to keep the state across effects. As the core FullscreenQuad used by applications binds
+     *  its own vertex array, the vertex array binding is always invalidated. Binding state is per context, so Invalidate() needs to be
+     *  called when switching contexts. A deleted object's name may be reused by the next object created, so code
+     *  deleting tracked objects calls ForgetTexture() or ForgetProgram() first, or Invalidate() if it deletes many.
+     */
+    class GLStateCache
+    {
+    public:
+        /** Counts the calls made through the cache. */
+        struct Statistics
+        {
+            /** Holds the number of OpenGL calls issued. */
+            std::size_t issuedCalls_ = 0;
+            /** Holds the number of OpenGL calls skipped as redundant. */
+            std::size_t elidedCalls_ = 0;
+        };
+
+        GLStateCache();
+
+        void Invalidate();
+        void InvalidateExternalState();
+        void SetExclusiveAccess(bool exclusive) { exclusiveAccess_ = exclusive; }
+        bool IsExclusiveAccess() const { return exclusiveAccess_; }
+
+        void UseProgram(gl::GLuint program);
+        void BindTexture(gl::GLuint unit, gl::GLenum target, gl::GLuint texture);
+        void BindSampler(gl::GLuint unit, gl::GLuint sampler);
+        void BindBuffer(gl::GLenum target, gl::GLuint buffer);
+        void BindBufferBase(gl::GLenum target, gl::GLuint index, gl::GLuint buffer);
+        void BindBufferRange(gl::GLenum target, gl::GLuint index, gl::GLuint buffer, gl::GLintptr offset, gl::GLsizeiptr size);
+        void BindVertexArray(gl::GLuint vertexArray);
+        void ForgetTexture(gl::GLuint texture);
+        void ForgetProgram(gl::GLuint program);
+
+        void EndFrame();
+        const Statistics& GetStatistics() const { return statistics_; }
+        const Statistics& GetLastFrameStatistics() const { return lastFrameStatistics_; }
+
+    private:
+        /** The number of texture units and indexed buffer binding points tracked. */
+        static constexpr std::size_t MAX_TRACKED_BINDINGS = 32;
+
+        /** A texture binding of a texture unit. */
+        struct TextureBinding
+        {
+            gl::GLenum target_;
+            gl::GLuint texture_;
+        };
+
+        /** A binding of an indexed buffer target. */
+        struct IndexedBufferBinding
+        {
+            gl::GLuint buffer_;
+            gl::GLintptr offset_;
+            gl::GLsizeiptr size_;
+        };
+
+        /** The bindings of a buffer target. */
+        struct BufferTargetBindings
+        {
+            gl::GLenum target_;
+            gl::GLuint buffer_;
+            std::array<IndexedBufferBinding, MAX_TRACKED_BINDINGS> indexed_;
+        };
+
+        BufferTargetBindings& GetBufferTarget(gl::GLenum target);
+        bool Elide(bool redundant);
+
+        /** Holds whether all changes to the tracked state go through the cache. */
+        bool exclusiveAccess_ = false;
+        /** Holds the bound program. */
+        gl::GLuint program_;
+        /** Holds the active texture unit. */
+        gl::GLuint activeTextureUnit_;
+        /** Holds the textures bound to the texture units. */
+        std::array<TextureBinding, MAX_TRACKED_BINDINGS> textures_;
+        /** Holds the samplers bound to the texture units. */
+        std::array<gl::GLuint, MAX_TRACKED_BINDINGS> samplers_;
+        /** Holds the buffer bindings for each target used. */
+        std::vector<BufferTargetBindings> buffers_;
+        /** Holds the bound vertex array. */
+        gl::GLuint vertexArray_;
+
+        /** Holds the statistics of the current frame. */
+        Statistics statistics_;
+        /** Holds the statistics of the last frame. */
+        Statistics lastFrameStatistics_;
+    };
+}
@@ -7,7 +7,9 @@
  */
 
 #include "GLTexture.h"
+#include "GLStateCache.h"
 #include "core/main.h"
+#include "enh/core/profiler.h"
 #include <glm/gtc/type_ptr.hpp>
 #include <stb_image.h>
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -36,6 +38,7 @@ namespace viscom::enh {
         gl::glTexStorage3D(gl::GL_TEXTURE_2D_ARRAY, mipMapLevels_, descriptor_.internalFormat_, width_, height_, depth_);
         gl::glBindTexture(gl::GL_TEXTURE_2D_ARRAY, 0);
         InitSampling();
+        TrackMemory();
     }
 
     GLTexture::GLTexture(unsigned int size, const TextureDescriptor& desc) :
@@ -50,6 +53,7 @@ namespace viscom::enh {
         gl::glTexStorage1D(id_.textureType, mipMapLevels_, descriptor_.internalFormat_, width_);
         gl::glBindTexture(id_.textureType, 0);
         InitSampling();
+        TrackMemory();
     }
 
     /**
@@ -59,23 +63,26 @@ namespace viscom::enh {
      * @param h the textures height
      * @param desc the textures format
      * @param data the textures data
+     * @param numMipLevels the number of mip levels to allocate (data is only uploaded to the first)
      */
-    GLTexture::GLTexture(unsigned int w, unsigned int h, const TextureDescriptor& desc, const void* data) :
+    GLTexture::GLTexture(unsigned int w, unsigned int h, const TextureDescriptor& desc, const void* data, unsigned int numMipLevels) :
         id_{ gl::GL_TEXTURE_2D },
         descriptor_(desc),
         width_(w),
         height_(h),
         depth_(1),
-        mipMapLevels_(1)
+        mipMapLevels_(numMipLevels)
     {
         gl::glBindTexture(id_.textureType, id_.textureId);
         gl::glTexStorage2D(id_.textureType, mipMapLevels_, descriptor_.internalFormat_, width_, height_);
         if (data) {
-            gl::glTexSubImage2D(id_.textureType, 0, 0, 0, width_, depth_, descriptor_.format_,
+            gl::glTexSubImage2D(id_.textureType, 0, 0, 0, width_, height_, descriptor_.format_,
                 descriptor_.type_, data);
+            ENH_PROFILE_COUNT(UPLOADED_BYTES, static_cast<std::size_t>(width_) * height_ * descriptor_.bytesPP_);
         }
         gl::glBindTexture(id_.textureType, 0);
         InitSampling();
+        TrackMemory();
     }
 
     /**
@@ -109,9 +116,11 @@ namespace viscom::enh {
         if (data) {
             gl::glTexSubImage3D(id_.textureType, 0, 0, 0, 0, width_, height_, depth_,
                 descriptor_.format_, descriptor_.type_, data);
+            ENH_PROFILE_COUNT(UPLOADED_BYTES, static_cast<std::size_t>(width_) * height_ * depth_ * descriptor_.bytesPP_);
         }
         gl::glBindTexture(id_.textureType, 0);
         InitSampling();
+        TrackMemory();
     }
 
     /**
@@ -141,7 +150,23 @@ namespace viscom::enh {
     }
 
     /** Destructor. */
-    GLTexture::~GLTexture() = default;
+    GLTexture::~GLTexture()
+    {
+        ENH_PROFILE_MEMORY(TEXTURES, -static_cast<std::int64_t>(memorySize_));
+    }
+
+    /** Computes the size of the textures storage including all MipMap levels and reports it to the profiler. */
+    void GLTexture::TrackMemory()
+    {
+        auto layers = id_.textureType == gl::GL_TEXTURE_2D_ARRAY ? depth_ : 1U;
+        auto size = glm::uvec3(width_, height_, id_.textureType == gl::GL_TEXTURE_2D_ARRAY ? 1U : depth_);
+        memorySize_ = 0;
+        for (auto level = 0U; level < mipMapLevels_; ++level) {
+            memorySize_ += static_cast<std::size_t>(size.x) * size.y * size.z * layers * descriptor_.bytesPP_;
+            size = glm::max(size / 2U, glm::uvec3(1U));
+        }
+        ENH_PROFILE_MEMORY(TEXTURES, static_cast<std::int64_t>(memorySize_));
+    }
 
     /** Initializes the sampler. */
     void GLTexture::InitSampling() const
@@ -160,6 +185,25 @@ namespace viscom::enh {
         gl::glBindTexture(id_.textureType, id_.textureId);
     }
 
+    /**
+     *  Activates the texture through a state cache, skipping the binding if it is already bound.
+     *  @param stateCache the state cache to bind through.
+     *  @param textureUnit the index of the texture unit to bind the texture to.
+     */
+    void GLTexture::ActivateTexture(GLStateCache* stateCache, gl::GLuint textureUnit) const
+    {
+        stateCache->BindTexture(textureUnit, id_.textureType, id_.textureId);
+    }
+
+    /**
+     *  Removes the texture from a state cache, called before the texture is deleted.
+     *  @param stateCache the state cache the texture was bound through.
+     */
+    void GLTexture::ForgetBindings(GLStateCache* stateCache) const
+    {
+        stateCache->ForgetTexture(id_.textureId);
+    }
+
     /**
      *  Activate the texture as an image.
      *  @param imageUnitIndex the index of the image unit to activate the texture for
@@ -178,6 +222,7 @@ namespace viscom::enh {
      */
     void GLTexture::AddTextureToArray(const std::string& file, unsigned int slice) const
     {
+        ENH_PROFILE_CPU("Texture/Load");
         stbi_set_flip_vertically_on_load(1);
         auto channelsNeeded = 0;
         switch (descriptor_.format_) {
@@ -207,6 +252,7 @@ namespace viscom::enh {
         gl::glTexSubImage3D(id_.textureType, 0, 0, 0, slice, width_, height_, 1,
             descriptor_.format_, descriptor_.type_, image);
         gl::glBindTexture(id_.textureType, 0);
+        ENH_PROFILE_COUNT(UPLOADED_BYTES, static_cast<std::size_t>(width_) * height_ * channelsNeeded);
 
         stbi_image_free(image);
     }
@@ -217,6 +263,7 @@ namespace viscom::enh {
      */
     void GLTexture::SetData(const void* data) const
     {
+        ENH_PROFILE_CPU("Texture/Upload");
         glBindTexture(id_.textureType, id_.textureId);
         switch (id_.textureType)
         {
@@ -233,6 +280,7 @@ namespace viscom::enh {
             throw std::runtime_error("Texture format not supported for upload.");
         }        
         gl::glBindTexture(id_.textureType, 0);
+        ENH_PROFILE_COUNT(UPLOADED_BYTES, static_cast<std::size_t>(width_) * height_ * depth_ * descriptor_.bytesPP_);
     }
 
     /**
@@ -241,6 +289,7 @@ namespace viscom::enh {
      */
     void GLTexture::DownloadData(std::vector<uint8_t>& data, std::size_t offset, std::size_t size) const
     {
+        ENH_PROFILE_CPU("Texture/Download");
         if (size == 0) size = static_cast<std::size_t>(width_) * height_ * depth_ * descriptor_.bytesPP_;
         data.resize(size);
         assert(data.size() != 0);
@@ -259,6 +308,7 @@ namespace viscom::enh {
             memcpy(data.data() + offset, gpuMem, size);
             gl::glUnmapBuffer(gl::GL_PIXEL_PACK_BUFFER);
         }
+        ENH_PROFILE_COUNT(DOWNLOADED_BYTES, size);
 
         gl::glBindTexture(id_.textureType, 0);
         gl::glBindBuffer(gl::GL_PIXEL_PACK_BUFFER, 0);
@@ -299,6 +349,7 @@ namespace viscom::enh {
             memcpy(data.data(), gpuMem, data.size());
             glUnmapBuffer(gl::GL_PIXEL_PACK_BUFFER);
         }
+        ENH_PROFILE_COUNT(DOWNLOADED_BYTES, data.size());
 
         gl::glBindTexture(textureType, 0);
         gl::glBindBuffer(gl::GL_PIXEL_PACK_BUFFER, 0);
@@ -313,6 +364,7 @@ namespace viscom::enh {
     void GLTexture::SaveTextureToFile(gl::GLuint texture, const TextureDescriptor& descriptor,
         const glm::uvec3& size, const std::string& filename)
     {
+        ENH_PROFILE_CPU("Texture/Save");
         auto comp = 0;
         if (descriptor.format_ == gl::GL_RED) comp = 1;
         else if (descriptor.format_ == gl::GL_RG) comp = 2;
@@ -340,6 +392,7 @@ namespace viscom::enh {
      */
     void GLTexture::UploadData(std::vector<std::uint8_t>& data) const
     {
+        ENH_PROFILE_CPU("Texture/Upload");
         assert(data.size() != 0);
 
         // TODO: create external PBOs for real asynchronous up-/download [8/19/2015 Sebastian Maisch]
@@ -352,6 +405,7 @@ namespace viscom::enh {
             memcpy(gpuMem, data.data(), data.size());
             gl::glUnmapBuffer(gl::GL_PIXEL_UNPACK_BUFFER);
         }
+        ENH_PROFILE_COUNT(UPLOADED_BYTES, data.size());
 
         gl::glBindTexture(id_.textureType, id_.textureId);
         if (id_.textureType == gl::GL_TEXTURE_3D || id_.textureType == gl::GL_TEXTURE_2D_ARRAY) {
@@ -387,6 +441,19 @@ namespace viscom::enh {
         gl::glClearTexImage(id_.textureId, mipLevel, descriptor_.format_, gl::GL_FLOAT, &data);
     }
 
+    /**
+     *  Creates a texture view of a single mip map level.
+     *  The view can be sampled like a texture of the size of the level without the need for explicit LODs.
+     *  @param mipLevel the MipMap level to create the view for.
+     */
+    std::unique_ptr<GLTexture> GLTexture::CreateMipLevelView(unsigned int mipLevel) const
+    {
+        assert(mipLevel < mipMapLevels_);
+        TextureRAII view;
+        gl::glTextureView(view, id_.textureType, id_.textureId, descriptor_.internalFormat_, mipLevel, 1, 0, 1);
+        return std::make_unique<GLTexture>(std::move(view), id_.textureType, descriptor_);
+    }
+
     /**
      *  Returns the dimensions of a mip map level.
      */
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -17,6 +18,7 @@
 namespace viscom::enh {
 
     class GLTexture;
+    class GLStateCache;
 
     /** Describes the format of a texture. */
     struct TextureDescriptor
@@ -62,11 +64,13 @@ namespace viscom::enh {
         GLTexture(TextureRAII texID, gl::GLenum texType, const TextureDescriptor& desc);
         GLTexture(unsigned int size, const TextureDescriptor& desc);
         GLTexture(unsigned int width, unsigned int height, unsigned int arraySize, const TextureDescriptor& desc);
-        GLTexture(unsigned int width, unsigned int height, const TextureDescriptor& desc, const void* data);
+        GLTexture(unsigned int width, unsigned int height, const TextureDescriptor& desc, const void* data, unsigned int numMipLevels = 1);
         GLTexture(unsigned int width, unsigned int height, unsigned int depth, unsigned int numMipLevels, const TextureDescriptor& desc, const void* data);
         virtual ~GLTexture();
 
         void ActivateTexture(gl::GLenum textureUnit) const;
+        void ActivateTexture(GLStateCache* stateCache, gl::GLuint textureUnit) const;
+        void ForgetBindings(GLStateCache* stateCache) const;
         void ActivateImage(gl::GLuint imageUnitIndex, gl::GLint mipLevel, gl::GLenum accessType) const;
         void AddTextureToArray(const std::string& file, unsigned int slice) const;
         void SetData(const void* data) const;
@@ -76,9 +80,12 @@ namespace viscom::enh {
         void UploadData(std::vector<std::uint8_t>& data) const;
         void GenerateMipMaps() const;
         void ClearTexture(unsigned int mipLevel, const glm::vec4& data) const;
+        std::unique_ptr<GLTexture> CreateMipLevelView(unsigned int mipLevel) const;
         glm::uvec3 GetDimensions() const { return glm::uvec3(width_, height_, depth_); }
         glm::uvec3 GetLevelDimensions(int level) const;
         const TextureDescriptor& GetDescriptor() const { return descriptor_; }
+        /** Returns the size of the storage allocated by this texture in bytes, views and external textures have none. */
+        std::size_t GetMemorySize() const { return memorySize_; }
 
         static void DownloadData8Bit(gl::GLuint texture, const TextureDescriptor& descriptor,
             gl::GLenum textureType, const glm::uvec3& size, std::vector<std::uint8_t>& data);
@@ -113,7 +120,10 @@ namespace viscom::enh {
         unsigned int depth_;
         /** Holds the number of MipMap levels the texture has. */
         unsigned int mipMapLevels_;
+        /** Holds the size of the storage allocated by this texture in bytes. */
+        std::size_t memorySize_ = 0;
 
         void InitSampling() const;
+        void TrackMemory();
     };
 }
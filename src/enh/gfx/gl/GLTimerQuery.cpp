@@ -0,0 +1,49 @@
+/**
+ * @file   GLTimerQuery.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of a non-blocking GPU timer.
+ */
+
+#include "GLTimerQuery.h"
+
+namespace viscom::enh {
+
+    /** Starts a measurement. If all queries are still in flight this measurement is skipped. */
+    void GLTimerQuery::Begin()
+    {
+        CollectResults();
+
+        running_ = !pending_[nextQuery_];
+        if (running_) gl::glBeginQuery(gl::GL_TIME_ELAPSED, queries_[nextQuery_]);
+    }
+
+    void GLTimerQuery::End()
+    {
+        if (!running_) return;
+
+        gl::glEndQuery(gl::GL_TIME_ELAPSED);
+        pending_[nextQuery_] = true;
+        nextQuery_ = (nextQuery_ + 1) % NUM_QUERIES;
+        running_ = false;
+    }
+
+    /** Reads back all available results, oldest first. */
+    void GLTimerQuery::CollectResults()
+    {
+        for (std::size_t i = 0; i < NUM_QUERIES; ++i) {
+            auto query = (nextQuery_ + i) % NUM_QUERIES;
+            if (!pending_[query]) continue;
+
+            gl::GLint available = 0;
+            gl::glGetQueryObjectiv(queries_[query], gl::GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available == 0) break;
+
+            gl::GLuint64 elapsedNS = 0;
+            gl::glGetQueryObjectui64v(queries_[query], gl::GL_QUERY_RESULT, &elapsedNS);
+            lastTime_ = std::chrono::duration<double, std::nano>(static_cast<double>(elapsedNS));
+            pending_[query] = false;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+/**
+ * @file   GLTimerQuery.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of a non-blocking GPU timer.
+ */
+
+#pragma once
+
+#include "OpenGLRAIIWrapper.h"
+
+#include <array>
+#include <chrono>
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Measures GPU time between Begin() and End() using GL_TIME_ELAPSED queries.
+     *
+     *  Several queries are kept in flight so reading back results never stalls the pipeline, the result is available
+     *  a few frames later. As time elapsed queries cannot be nested, timers must not overlap.
+     */
+    class GLTimerQuery
+    {
+    public:
+        GLTimerQuery() = default;
+
+        void Begin();
+        void End();
+        /** Returns the last GPU time measured. */
+        std::chrono::duration<double, std::milli> GetLastTime() const { return lastTime_; }
+
+    private:
+        void CollectResults();
+
+        /** The number of queries in flight. */
+        static constexpr std::size_t NUM_QUERIES = 4;
+
+        /** Holds the queries. */
+        std::array<QueryRAII, NUM_QUERIES> queries_;
+        /** Holds whether a query waits for its result. */
+        std::array<bool, NUM_QUERIES> pending_ = { { false, false, false, false } };
+        /** Holds the next query to use. */
+        std::size_t nextQuery_ = 0;
+        /** Holds whether a query was started in Begin(). */
+        bool running_ = false;
+        /** Holds the last GPU time measured. */
+        std::chrono::duration<double, std::milli> lastTime_{ 0.0 };
+    };
+}
@@ -9,6 +9,7 @@
 #include "GLUniformBuffer.h"
 #include "GLBuffer.h"
 #include "ShaderBufferBindingPoints.h"
+#include "GLStateCache.h"
 
 #include <cassert>
 
@@ -107,4 +108,13 @@ namespace viscom::enh {
     {
         gl::glBindBufferRange(gl::GL_UNIFORM_BUFFER, bindingPoint_, buffer_->GetBuffer(), 0, buffer_->GetBufferSize());
     }
+
+    /**
+     *  Binds the buffer to its binding point, skipping the call if it is already bound.
+     *  @param stateCache the state cache to bind through.
+     */
+    void GLUniformBuffer::BindBuffer(GLStateCache* stateCache) const
+    {
+        stateCache->BindBufferRange(gl::GL_UNIFORM_BUFFER, bindingPoint_, buffer_->GetBuffer(), 0, buffer_->GetBufferSize());
+    }
 }
@@ -17,6 +17,7 @@ namespace viscom::enh {
 
     class GLBuffer;
     class ShaderBufferBindingPoints;
+    class GLStateCache;
 
     /**
      * @brief  Represents uniform buffers.
@@ -38,6 +39,7 @@ namespace viscom::enh {
         const GLBuffer* GetBuffer() const { return buffer_; }
         void UploadData(std::size_t offset, std::size_t size, const void* data);
         void BindBuffer() const;
+        void BindBuffer(GLStateCache* stateCache) const;
         ShaderBufferBindingPoints* GetBindingPoints() const { return bindingPoints_; }
         const std::string& GetUBOName() const { return uboName_; }
 
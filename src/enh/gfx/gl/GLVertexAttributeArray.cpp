@@ -7,6 +7,7 @@
  */
 
 #include "GLVertexAttributeArray.h"
+#include "GLStateCache.h"
 
 namespace viscom::enh {
 
@@ -93,6 +94,18 @@ namespace viscom::enh {
         gl::glBindVertexArray(0);
     }
 
+    /** Binds the vertex array through a state cache. */
+    void GLVertexAttributeArray::EnableVertexAttributeArray(GLStateCache* stateCache) const
+    {
+        stateCache->BindVertexArray(vao_);
+    }
+
+    /** Unbinds the vertex array through a state cache. */
+    void GLVertexAttributeArray::DisableVertexAttributeArray(GLStateCache* stateCache) const
+    {
+        stateCache->BindVertexArray(0);
+    }
+
     /**
      * Updates all vertex attributes.
      * This is used when BindingLocation changes after a shader recompile.
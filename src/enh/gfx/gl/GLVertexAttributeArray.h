@@ -14,6 +14,8 @@
 
 namespace viscom::enh {
 
+    class GLStateCache;
+
     /** The type of the vertex attribute inside a shader. */
     enum class VAShaderType
     {
@@ -72,6 +74,8 @@ namespace viscom::enh {
         void DisableAttributes();
         void EnableVertexAttributeArray() const;
         void DisableVertexAttributeArray() const;
+        void EnableVertexAttributeArray(GLStateCache* stateCache) const;
+        void DisableVertexAttributeArray(GLStateCache* stateCache) const;
 
     private:
         VertexArrayRAII vao_;
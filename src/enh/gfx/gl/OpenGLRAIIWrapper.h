@@ -143,6 +143,20 @@ namespace viscom::enh {
         }
     };
 
+    struct QueryObjectTraits
+    {
+        using value_type = gl::GLuint;
+        static const value_type null_obj = 0;
+        static value_type Create() { value_type query; gl::glGenQueries(1, &query); return query; }
+        template<int N> static void Create(std::array<value_type, N>& queries) { gl::glGenQueries(static_cast<gl::GLsizei>(N), queries.data()); }
+        static value_type Destroy(value_type query) { gl::glDeleteQueries(1, &query); return null_obj; }
+        template<int N> static void Destroy(std::array<value_type, N>& queries)
+        {
+            gl::glDeleteQueries(static_cast<gl::GLsizei>(N), queries.data());
+            for (auto& query : queries) query = null_obj;
+        }
+    };
+
     using ProgramRAII = OpenGLRAIIWrapper<ProgramObjectTraits, 1>;
     using ShaderRAII = OpenGLRAIIWrapper<ShaderObjectTraits, 1>;
     template<int N> using BuffersRAII = OpenGLRAIIWrapper<BufferObjectTraits, N>;
@@ -155,5 +169,7 @@ namespace viscom::enh {
     using RenderbufferRAII = OpenGLRAIIWrapper<RenderbufferObjectTraits, 1>;
     template<int N> using VertexArraysRAII = OpenGLRAIIWrapper<VertexArrayObjectTraits, N>;
     using VertexArrayRAII = OpenGLRAIIWrapper<VertexArrayObjectTraits, 1>;
+    template<int N> using QueriesRAII = OpenGLRAIIWrapper<QueryObjectTraits, N>;
+    using QueryRAII = OpenGLRAIIWrapper<QueryObjectTraits, 1>;
 }
 
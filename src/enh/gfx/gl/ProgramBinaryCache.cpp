@@ -0,0 +1,244 @@
+/**
+ * @file   ProgramBinaryCache.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the on-disk cache of linked program binaries.
+ */
+
+#include "ProgramBinaryCache.h"
+#include "core/main.h"
+#include "enh/core/profiler.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <glbinding/gl/gl.h>
+
+namespace viscom::enh {
+
+    namespace {
+
+        /** Identifies program binary files. */
+        constexpr std::array<char, 8> BINARY_MAGIC = { 'E', 'N', 'H', 'P', 'R', 'O', 'G', 'B' };
+        /** The version of the file format. */
+        constexpr std::uint32_t BINARY_VERSION = 1;
+        /** The initial value of the FNV-1a hash. */
+        constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+        /** The prime of the FNV-1a hash. */
+        constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+        /** The header of a program binary file, followed by the driver string and the binary. */
+        struct BinaryHeader
+        {
+            std::array<char, 8> magic_;
+            std::uint32_t version_;
+            std::uint32_t binaryFormat_;
+            std::uint64_t key_;
+            std::uint64_t checksum_;
+            std::uint32_t driverLength_;
+            std::uint32_t binarySize_;
+        };
+
+        /** Continues an FNV-1a hash with some bytes. */
+        std::uint64_t HashBytes(std::uint64_t hash, const void* bytes, std::size_t size)
+        {
+            auto data = static_cast<const unsigned char*>(bytes);
+            for (std::size_t i = 0; i < size; ++i) hash = (hash ^ data[i]) * FNV_PRIME;
+            return hash;
+        }
+
+        /** Continues a hash with a string and its length, so consecutive strings cannot be shifted into each other. */
+        std::uint64_t HashString(std::uint64_t hash, const std::string& str)
+        {
+            auto length = static_cast<std::uint64_t>(str.size());
+            hash = HashBytes(hash, &length, sizeof(length));
+            return HashBytes(hash, str.data(), str.size());
+        }
+
+        /** The reason ReadEntry() returns if there is no cache entry. */
+        constexpr const char* MISSING_ENTRY = "missing entry";
+
+        /**
+         *  Reads a cache entry and checks it against the key and driver, the file is closed on return.
+         *  @param filename the file of the entry.
+         *  @param key the key of the program.
+         *  @param driver the driver string of the current context.
+         *  @param header the header read.
+         *  @param binary the binary read.
+         *  @return nullptr if the entry is valid, the reason to reject it otherwise (MISSING_ENTRY if there is none).
+         */
+        const char* ReadEntry(const std::string& filename, std::uint64_t key, const std::string& driver, BinaryHeader& header, std::vector<char>& binary)
+        {
+            std::ifstream binaryFile(filename, std::ios::binary | std::ios::ate);
+            if (!binaryFile) return MISSING_ENTRY;
+            auto fileSize = static_cast<std::uint64_t>(binaryFile.tellg());
+            binaryFile.seekg(0);
+
+            if (!binaryFile.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic_ != BINARY_MAGIC
+                || header.version_ != BINARY_VERSION || header.key_ != key) return "invalid header";
+            // checked before allocating, so corrupt sizes cannot cause huge allocations.
+            if (sizeof(header) + static_cast<std::uint64_t>(header.driverLength_) + header.binarySize_ != fileSize) return "size mismatch";
+
+            std::string entryDriver(header.driverLength_, '\0');
+            binary.resize(header.binarySize_);
+            if (!binaryFile.read(entryDriver.data(), entryDriver.size()) || !binaryFile.read(binary.data(), binary.size())) return "truncated file";
+            if (entryDriver != driver) return "different driver";
+            if (HashBytes(FNV_OFFSET_BASIS, binary.data(), binary.size()) != header.checksum_) return "checksum mismatch";
+            return nullptr;
+        }
+
+        /** Returns a string from glGetString(), which may be nullptr. */
+        std::string GetGLString(gl::GLenum name)
+        {
+            auto str = gl::glGetString(name);
+            return str ? reinterpret_cast<const char*>(str) : "";
+        }
+    }
+
+    /**
+     *  Creates the cache and its directory and queries the driver string and supported binary formats, needs a current
+     *  context.
+     *  @param directory the directory to store the binaries in.
+     */
+    ProgramBinaryCache::ProgramBinaryCache(const std::string& directory) :
+        directory_{ directory },
+        driver_{ GetGLString(gl::GL_VENDOR) + "|" + GetGLString(gl::GL_RENDERER) + "|" + GetGLString(gl::GL_VERSION) }
+    {
+        gl::GLint numFormats = 0;
+        gl::glGetIntegerv(gl::GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+        binaryFormats_.resize(static_cast<std::size_t>(std::max(numFormats, 0)));
+        if (!binaryFormats_.empty()) gl::glGetIntegerv(gl::GL_PROGRAM_BINARY_FORMATS, binaryFormats_.data());
+        else LOG(INFO) << "The driver supports no program binary formats, programs are not cached.";
+
+        std::error_code error;
+        std::filesystem::create_directories(directory_, error);
+        if (error) LOG(WARNING) << "Could not create the program binary directory " << directory_ << " (" << error.message() << ").";
+    }
+
+    /**
+     *  Creates the key of a program.
+     *  @param sources the preprocessed sources of all shaders of the program (including the included files).
+     *  @param defines the defines the shaders are compiled with.
+     */
+    std::uint64_t ProgramBinaryCache::CreateKey(const std::vector<std::string>& sources, const std::vector<std::string>& defines)
+    {
+        auto hash = FNV_OFFSET_BASIS;
+        for (const auto& source : sources) hash = HashString(hash, source);
+        // separates the defines from the sources.
+        hash = HashString(hash, "");
+        for (const auto& define : defines) hash = HashString(hash, define);
+        return hash;
+    }
+
+    /**
+     *  Loads a cached binary into a program.
+     *  @param program the program object to load into, no shaders need to be attached.
+     *  @param key the key of the program (see CreateKey()).
+     *  @return whether the program was loaded and linked successfully.
+     */
+    bool ProgramBinaryCache::Load(gl::GLuint program, std::uint64_t key)
+    {
+        if (!IsEnabled()) return false;
+        ENH_PROFILE_CPU("ProgramBinaryCache/Load");
+
+        BinaryHeader header;
+        std::vector<char> binary;
+        // the file is closed before rejecting, an open file cannot be removed on all platforms.
+        auto rejectReason = ReadEntry(GetFilename(key), key, driver_, header, binary);
+        if (rejectReason == MISSING_ENTRY) {
+            ++numMisses_;
+            return false;
+        }
+        if (!rejectReason && std::find(binaryFormats_.begin(), binaryFormats_.end(), static_cast<gl::GLint>(header.binaryFormat_)) == binaryFormats_.end()) {
+            rejectReason = "unsupported binary format";
+        }
+        if (!rejectReason) {
+            gl::glProgramBinary(program, static_cast<gl::GLenum>(header.binaryFormat_), binary.data(), static_cast<gl::GLsizei>(binary.size()));
+            gl::GLint linkStatus = 0;
+            gl::glGetProgramiv(program, gl::GL_LINK_STATUS, &linkStatus);
+            if (linkStatus == 0) rejectReason = "binary not accepted by the driver";
+        }
+        if (rejectReason) {
+            Reject(key, rejectReason);
+            return false;
+        }
+
+        ++numHits_;
+        return true;
+    }
+
+    /**
+     *  Stores the binary of a linked program. The binary may only be retrievable if GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+     *  was set before linking (see LoadOrLink()).
+     *  @param program the linked program.
+     *  @param key the key of the program (see CreateKey()).
+     *  @return whether the binary was written.
+     */
+    bool ProgramBinaryCache::Store(gl::GLuint program, std::uint64_t key) const
+    {
+        if (!IsEnabled()) return false;
+        ENH_PROFILE_CPU("ProgramBinaryCache/Store");
+
+        gl::GLint binaryLength = 0;
+        gl::glGetProgramiv(program, gl::GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+        if (binaryLength <= 0) return false;
+
+        std::vector<char> binary(static_cast<std::size_t>(binaryLength));
+        gl::GLsizei writtenLength = 0;
+        gl::GLenum binaryFormat = gl::GL_NONE;
+        gl::glGetProgramBinary(program, binaryLength, &writtenLength, &binaryFormat, binary.data());
+        binary.resize(static_cast<std::size_t>(writtenLength));
+
+        BinaryHeader header{ BINARY_MAGIC, BINARY_VERSION, static_cast<std::uint32_t>(binaryFormat), key,
+            HashBytes(FNV_OFFSET_BASIS, binary.data(), binary.size()), static_cast<std::uint32_t>(driver_.size()), static_cast<std::uint32_t>(binary.size()) };
+
+        auto filename = GetFilename(key);
+        std::ofstream binaryFile(filename, std::ios::binary);
+        binaryFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        binaryFile.write(driver_.data(), static_cast<std::streamsize>(driver_.size()));
+        binaryFile.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+        if (!binaryFile) {
+            LOG(WARNING) << "Could not write program binary " << filename << ".";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     *  Loads a program from the cache, if that fails the program is linked and its binary stored.
+     *  @param program the program object, the shaders need to be attached for linking.
+     *  @param key the key of the program (see CreateKey()).
+     *  @param link compiles and links the program, returns whether linking succeeded.
+     *  @return whether the program is linked.
+     */
+    bool ProgramBinaryCache::LoadOrLink(gl::GLuint program, std::uint64_t key, const std::function<bool()>& link)
+    {
+        if (Load(program, key)) return true;
+
+        if (IsEnabled()) gl::glProgramParameteri(program, gl::GL_PROGRAM_BINARY_RETRIEVABLE_HINT, static_cast<gl::GLint>(gl::GL_TRUE));
+        if (!link()) return false;
+        Store(program, key);
+        return true;
+    }
+
+    /** Returns the file of a cache entry. */
+    std::string ProgramBinaryCache::GetFilename(std::uint64_t key) const
+    {
+        std::stringstream filename;
+        filename << directory_ << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+        return filename.str();
+    }
+
+    /** Removes an invalid cache entry, the program is compiled from source and stored again. */
+    void ProgramBinaryCache::Reject(std::uint64_t key, const char* reason)
+    {
+        ++numRejected_;
+        auto filename = GetFilename(key);
+        LOG(INFO) << "Recompiling program " << filename << " (" << reason << ").";
+        std::remove(filename.c_str());
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * @file   ProgramBinaryCache.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the on-disk cache of linked program binaries.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <glbinding/gl/types.h>
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Caches linked programs on disk with glGetProgramBinary() and restores them with glProgramBinary().
+     *
+     *  A program is identified by a key hashed from its preprocessed shader sources and defines, so each permutation
+     *  (e.g. HORIZONTAL and VERTICAL) has its own entry. Entries also store the driver string (vendor, renderer and
+     *  version) they were created with. Entries of other drivers, corrupt files, formats the driver does not support
+     *  and binaries the driver refuses to link are removed and the program is compiled from source again. The cache
+     *  directory is created if needed, the cache is disabled if the driver supports no binary formats.
+     */
+    class ProgramBinaryCache final
+    {
+    public:
+        explicit ProgramBinaryCache(const std::string& directory);
+
+        static std::uint64_t CreateKey(const std::vector<std::string>& sources, const std::vector<std::string>& defines);
+
+        bool Load(gl::GLuint program, std::uint64_t key);
+        bool Store(gl::GLuint program, std::uint64_t key) const;
+        bool LoadOrLink(gl::GLuint program, std::uint64_t key, const std::function<bool()>& link);
+
+        /** Returns whether the driver supports program binaries. */
+        bool IsEnabled() const { return !binaryFormats_.empty(); }
+        /** Returns the number of programs loaded from the cache. */
+        std::size_t GetNumHits() const { return numHits_; }
+        /** Returns the number of programs not found in the cache. */
+        std::size_t GetNumMisses() const { return numMisses_; }
+        /** Returns the number of cache entries rejected as out of date or invalid. */
+        std::size_t GetNumRejected() const { return numRejected_; }
+
+    private:
+        std::string GetFilename(std::uint64_t key) const;
+        void Reject(std::uint64_t key, const char* reason);
+
+        /** Holds the directory the binaries are stored in. */
+        std::string directory_;
+        /** Holds the driver string the binaries are valid for. */
+        std::string driver_;
+        /** Holds the binary formats supported by the driver. */
+        std::vector<gl::GLint> binaryFormats_;
+        /** Holds the number of programs loaded from the cache. */
+        std::size_t numHits_ = 0;
+        /** Holds the number of programs not found in the cache. */
+        std::size_t numMisses_ = 0;
+        /** Holds the number of rejected cache entries. */
+        std::size_t numRejected_ = 0;
+    };
+}
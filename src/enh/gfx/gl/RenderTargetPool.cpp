@@ -0,0 +1,108 @@
+/**
+ * @file   RenderTargetPool.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of a pool of transient render targets.
+ */
+
+#include "RenderTargetPool.h"
+#include "GLStateCache.h"
+#include "core/gfx/FrameBuffer.h"
+#include <algorithm>
+#include <cassert>
+
+namespace viscom::enh {
+
+    namespace {
+        /** Returns the bytes per pixel of the formats used for render targets (4 for unknown formats). */
+        std::size_t GetBytesPerPixel(gl::GLenum format)
+        {
+            switch (format) {
+            case gl::GL_RGBA32F: return 16;
+            case gl::GL_RGB32F: return 12;
+            case gl::GL_RGBA16F: case gl::GL_RG32F: return 8;
+            case gl::GL_RGB16F: return 6;
+            default: return 4;
+            }
+        }
+    }
+
+    RenderTargetPool::RenderTargetPool(GLStateCache* stateCache) :
+        stateCache_{ stateCache }
+    {
+    }
+
+    RenderTargetPool::~RenderTargetPool() = default;
+
+    /**
+     *  Acquires a target, a released one is used if available.
+     *  @param size the size of the target.
+     *  @param formats the internal formats of the color attachments.
+     *  @return the target, valid until it is released.
+     */
+    const FrameBuffer* RenderTargetPool::Acquire(const glm::uvec2& size, const std::vector<gl::GLenum>& formats)
+    {
+        for (auto& target : targets_) {
+            if (target.acquired_ || target.size_ != size || target.formats_ != formats) continue;
+            target.acquired_ = true;
+            target.lastUsedFrame_ = frame_;
+            return target.fbo_.get();
+        }
+
+        std::vector<FrameBufferTextureDescriptor> textureDescs;
+        for (auto format : formats) textureDescs.emplace_back(static_cast<GLenum>(format));
+        FrameBufferDescriptor desc{ textureDescs, {} };
+
+        PooledTarget target;
+        target.size_ = size;
+        target.formats_ = formats;
+        target.fbo_ = std::make_unique<FrameBuffer>(size.x, size.y, desc);
+        target.acquired_ = true;
+        target.lastUsedFrame_ = frame_;
+        targets_.emplace_back(std::move(target));
+        // creating the frame buffer changes the texture and frame buffer bindings.
+        stateCache_->Invalidate();
+        return targets_.back().fbo_.get();
+    }
+
+    /** Releases a target, it may be handed out again immediately. */
+    void RenderTargetPool::Release(const FrameBuffer* target)
+    {
+        auto it = std::find_if(targets_.begin(), targets_.end(), [target](const PooledTarget& t) { return t.fbo_.get() == target; });
+        assert(it != targets_.end() && it->acquired_);
+        it->acquired_ = false;
+    }
+
+    /** Frees the targets not acquired during the last frames. */
+    void RenderTargetPool::EndFrame()
+    {
+        FreeTargets([this](const PooledTarget& t) { return !t.acquired_ && frame_ - t.lastUsedFrame_ >= MAX_UNUSED_FRAMES; });
+        frame_ += 1;
+    }
+
+    /** Frees all targets not acquired. */
+    void RenderTargetPool::Clear()
+    {
+        FreeTargets([](const PooledTarget& t) { return !t.acquired_; });
+    }
+
+    /** Frees the targets matching a predicate, their textures are removed from the state cache first. */
+    template<typename Predicate> void RenderTargetPool::FreeTargets(Predicate freeTarget)
+    {
+        auto freed = std::stable_partition(targets_.begin(), targets_.end(), [&freeTarget](const PooledTarget& t) { return !freeTarget(t); });
+        for (auto it = freed; it != targets_.end(); ++it) {
+            for (auto texture : it->fbo_->GetTextures()) stateCache_->ForgetTexture(texture);
+        }
+        targets_.erase(freed, targets_.end());
+    }
+
+    std::size_t RenderTargetPool::GetMemorySize() const
+    {
+        std::size_t memorySize = 0;
+        for (const auto& target : targets_) {
+            for (auto format : target.formats_) memorySize += static_cast<std::size_t>(target.size_.x) * target.size_.y * GetBytesPerPixel(format);
+        }
+        return memorySize;
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * @file   RenderTargetPool.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of a pool of transient render targets.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glbinding/gl/gl.h>
+
+namespace viscom {
+    class FrameBuffer;
+}
+
+namespace viscom::enh {
+
+    class GLStateCache;
+
+    /**
+     * @brief  Shares render targets that are only needed during a pass window between effects and viewports.
+     *
+     *  Effects acquire their targets when they start and release them after their last pass, a released target is
+     *  handed out again to the next request with the same size and formats. As the viewports of a node are rendered
+     *  one after another, targets are shared between viewports and effects whose lifetimes do not overlap instead of
+     *  each effect keeping a set per viewport. The contents of a target are undefined after acquiring it.
+     *  EndFrame() is called once per frame by enh::ApplicationNodeBase::UpdateFrame() to free targets that were not used
+     *  for a few frames, so targets of an old size or precision are freed without the effects releasing them. Clear()
+     *  frees all targets not acquired at once.
+     */
+    class RenderTargetPool
+    {
+    public:
+        explicit RenderTargetPool(GLStateCache* stateCache);
+        RenderTargetPool(const RenderTargetPool&) = delete;
+        RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+        ~RenderTargetPool();
+
+        const FrameBuffer* Acquire(const glm::uvec2& size, const std::vector<gl::GLenum>& formats);
+        void Release(const FrameBuffer* target);
+        void EndFrame();
+        void Clear();
+
+        /** Returns the current frame, counted by EndFrame(). */
+        std::size_t GetFrame() const { return frame_; }
+        /** Returns the number of targets allocated. */
+        std::size_t GetNumTargets() const { return targets_.size(); }
+        /** Returns the (estimated) memory of all targets allocated in bytes. */
+        std::size_t GetMemorySize() const;
+
+        /** The number of frames a target is kept without being acquired. */
+        static constexpr std::size_t MAX_UNUSED_FRAMES = 3;
+
+    private:
+        /** A target of the pool. */
+        struct PooledTarget
+        {
+            /** Holds the size of the target. */
+            glm::uvec2 size_;
+            /** Holds the formats of the color attachments. */
+            std::vector<gl::GLenum> formats_;
+            /** Holds the frame buffer. */
+            std::unique_ptr<FrameBuffer> fbo_;
+            /** Holds whether the target is acquired. */
+            bool acquired_ = false;
+            /** Holds the frame the target was last acquired in. */
+            std::size_t lastUsedFrame_ = 0;
+        };
+
+        template<typename Predicate> void FreeTargets(Predicate freeTarget);
+
+        /** Holds the OpenGL state cache. */
+        GLStateCache* stateCache_;
+        /** Holds the targets. */
+        std::vector<PooledTarget> targets_;
+        /** Holds the current frame. */
+        std::size_t frame_ = 0;
+    };
+}
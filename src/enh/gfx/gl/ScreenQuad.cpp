@@ -0,0 +1,38 @@
+/**
+ * @file   ScreenQuad.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of a renderable covering the viewport.
+ */
+
+#include "ScreenQuad.h"
+#include "GLStateCache.h"
+#include "enh/ApplicationNodeBase.h"
+
+namespace viscom::enh {
+
+    ScreenQuad::ScreenQuad(const std::string& fragmentShader, ApplicationNodeBase* app) :
+        ScreenQuad(fragmentShader, std::vector<std::string>{}, app)
+    {
+    }
+
+    /**
+     *  Creates the quad.
+     *  @param fragmentShader the fragment shader relative to the shader directory.
+     *  @param defines the defines to compile the shaders with.
+     *  @param app the application.
+     */
+    ScreenQuad::ScreenQuad(const std::string& fragmentShader, const std::vector<std::string>& defines, ApplicationNodeBase* app) :
+        stateCache_{ app->GetGLStateCache() },
+        program_{ { "screenQuad.vert", fragmentShader }, defines, app }
+    {
+    }
+
+    /** Draws the quad with the program currently in use. */
+    void ScreenQuad::Draw() const
+    {
+        stateCache_->BindVertexArray(vao_);
+        gl::glDrawArrays(gl::GL_TRIANGLES, 0, 3);
+    }
+}
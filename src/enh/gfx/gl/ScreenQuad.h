@@ -0,0 +1,43 @@
+/**
+ * @file   ScreenQuad.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of a renderable covering the viewport.
+ */
+
+#pragma once
+
+#include "GLProgram.h"
+
+namespace viscom::enh {
+
+    class ApplicationNodeBase;
+    class GLStateCache;
+
+    /**
+     * @brief  Draws a fragment shader over the whole viewport with a program from the program binary cache.
+     *
+     *  The vertex shader (screenQuad.vert) draws a single triangle covering the viewport without vertex attributes and
+     *  passes the texture coordinates as texCoord. As with the core FullscreenQuad, the program needs to be in use and
+     *  its uniforms set before calling Draw().
+     */
+    class ScreenQuad final
+    {
+    public:
+        ScreenQuad(const std::string& fragmentShader, ApplicationNodeBase* app);
+        ScreenQuad(const std::string& fragmentShader, const std::vector<std::string>& defines, ApplicationNodeBase* app);
+
+        /** Returns the program of the quad. */
+        const GLProgram* GetProgram() const { return &program_; }
+        void Draw() const;
+
+    private:
+        /** Holds the OpenGL state cache. */
+        GLStateCache* stateCache_;
+        /** Holds the program. */
+        GLProgram program_;
+        /** Holds the empty vertex array. */
+        VertexArrayRAII vao_;
+    };
+}
@@ -33,4 +33,10 @@ namespace viscom::enh {
         auto uboIndex = gl::glGetUniformBlockIndex(program, name.c_str());
         gl::glUniformBlockBinding(program, uboIndex, GetBindingPoint(name.c_str()));
     }
+
+    void ShaderBufferBindingPoints::BindStorageBufferBlock(gl::GLuint program, const std::string& name)
+    {
+        auto ssboIndex = gl::glGetProgramResourceIndex(program, gl::GL_SHADER_STORAGE_BLOCK, name.c_str());
+        gl::glShaderStorageBlockBinding(program, ssboIndex, GetBindingPoint(name));
+    }
 }
@@ -32,6 +32,7 @@ namespace viscom::enh {
 
         gl::GLuint GetBindingPoint(const std::string& name);
         void BindBufferBlock(gl::GLuint program, const std::string& name);
+        void BindStorageBufferBlock(gl::GLuint program, const std::string& name);
 
     private:
         /** holds map that maps uniform buffer names to binding points. */
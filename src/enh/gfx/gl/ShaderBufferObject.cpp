@@ -8,6 +8,7 @@
 
 #include "ShaderBufferObject.h"
 #include "ShaderBufferBindingPoints.h"
+#include "GLStateCache.h"
 #include "GLBuffer.h"
 
 namespace viscom::enh {
@@ -77,4 +78,13 @@ namespace viscom::enh {
     {
         gl::glBindBufferBase(gl::GL_SHADER_STORAGE_BUFFER, bindingPoint_, buffer_->GetBuffer());
     }
+
+    /**
+     *  Binds the buffer to its binding point, skipping the call if it is already bound.
+     *  @param stateCache the state cache to bind through.
+     */
+    void ShaderBufferObject::BindBuffer(GLStateCache* stateCache) const
+    {
+        stateCache->BindBufferBase(gl::GL_SHADER_STORAGE_BUFFER, bindingPoint_, buffer_->GetBuffer());
+    }
 }
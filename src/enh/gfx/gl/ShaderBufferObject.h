@@ -17,6 +17,7 @@ namespace viscom::enh {
     
     class GLBuffer;
     class ShaderBufferBindingPoints;
+    class GLStateCache;
 
     /**
      * @brief Wrapper to access OpenGL shader storage buffer objects (SSBOs).
@@ -36,6 +37,7 @@ namespace viscom::enh {
         GLBuffer* GetBuffer() { return buffer_; }
         const GLBuffer* GetBuffer() const { return buffer_; }
         void BindBuffer() const;
+        void BindBuffer(GLStateCache* stateCache) const;
         // void UploadData(unsigned int offset, unsigned int size, const void* data) const;
         // void DownloadData(unsigned int size, void* data) const;
 
@@ -11,14 +11,32 @@
 #include "enh/ApplicationNodeBase.h"
 #include "enh/gfx/gl/GLVertexAttributeArray.h"
 #include "enh/gfx/gl/GLBuffer.h"
+#include "enh/gfx/gl/GLProgram.h"
+#include "enh/gfx/gl/ShaderBufferObject.h"
+#include "enh/gfx/gl/ShaderBufferBindingPoints.h"
 
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_access.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ENH_SIMPLE_MESH_SSE
+#include <xmmintrin.h>
+#endif
 
 namespace viscom::enh {
 
+    /**
+     *  Vertex with a position quantized to 16 bit signed normalized values relative to the sub mesh bounds. The
+     *  drawSimple vertex shaders read it as a vec4 in [-1, 1], the dequantization to the sub mesh bounds is part of
+     *  the model matrix (see SimpleSubMesh::dequantization_).
+     */
     struct SimpleVertex {
 
-        glm::vec4 pos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        std::array<std::int16_t, 4> pos = { { 0, 0, 0, std::numeric_limits<std::int16_t>::max() } };
 
         static void GatherAttributeNames(std::vector<std::string>& attribNames)
         {
@@ -28,55 +46,313 @@ namespace viscom::enh {
         static void VertexAttributeSetup(GLVertexAttributeArray* vao, const std::vector<gl::GLint>& shaderPositions)
         {
             vao->StartAttributeSetup();
-            if (shaderPositions[0] >= 0) vao->AddVertexAttribute(shaderPositions[0], 4, gl::GL_FLOAT, gl::GL_FALSE, sizeof(SimpleVertex), offsetof(SimpleVertex, pos)); //-V112
+            if (shaderPositions[0] >= 0) vao->AddVertexAttribute(shaderPositions[0], 4, gl::GL_SHORT, gl::GL_TRUE, sizeof(SimpleVertex), offsetof(SimpleVertex, pos)); //-V112
             vao->EndAttributeSetup();
         }
 
         SimpleVertex() = default;
-        explicit SimpleVertex(const glm::vec4& position) : pos{ position } {}
+        /** Constructs the vertex from a position in [-1, 1]. */
+        explicit SimpleVertex(const glm::vec3& normalizedPosition)
+        {
+            auto quantized = glm::round(glm::clamp(normalizedPosition, -1.0f, 1.0f) * static_cast<float>(std::numeric_limits<std::int16_t>::max()));
+            pos[0] = static_cast<std::int16_t>(quantized.x);
+            pos[1] = static_cast<std::int16_t>(quantized.y);
+            pos[2] = static_cast<std::int16_t>(quantized.z);
+        }
     };
 
-    SimpleMeshRenderer::SimpleMeshRenderer(ApplicationNodeBase* app) :
-        simpleProgram_(app->GetGPUProgramManager().GetResource("drawSimple", std::vector<std::string>{"drawSimple.vert", "drawSimple.frag"}))
+    namespace {
+
+        void AddQuad(std::vector<unsigned int>& indices, unsigned int i0, unsigned int i1, unsigned int i2, unsigned int i3)
+        {
+            indices.insert(indices.end(), { i0, i1, i2, i0, i2, i3 });
+        }
+
+        /** Generates a cone along the y-axis with base radius and height of 0.5 and 1 (matching mesh_cone.obj). */
+        void GenerateCone(unsigned int segments, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+        {
+            positions.emplace_back(0.0f, 0.5f, 0.0f);
+            positions.emplace_back(0.0f, -0.5f, 0.0f);
+            for (unsigned int s = 0; s < segments; ++s) {
+                auto phi = glm::two_pi<float>() * static_cast<float>(s) / static_cast<float>(segments);
+                positions.emplace_back(0.5f * glm::cos(phi), -0.5f, 0.5f * glm::sin(phi));
+            }
+
+            auto ring = [segments](unsigned int s) { return 2 + (s % segments); };
+            for (unsigned int s = 0; s < segments; ++s) {
+                indices.insert(indices.end(), { 0, ring(s + 1), ring(s) });
+                indices.insert(indices.end(), { 1, ring(s), ring(s + 1) });
+            }
+        }
+
+        /** Generates a cube with an edge length of 1 (matching mesh_cube.obj). */
+        void GenerateCube(std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+        {
+            // the bits of a corner index select the positive side of x, y and z.
+            for (unsigned int i = 0; i < 8; ++i) positions.emplace_back((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f);
+            AddQuad(indices, 0, 4, 6, 2);
+            AddQuad(indices, 1, 3, 7, 5);
+            AddQuad(indices, 0, 1, 5, 4);
+            AddQuad(indices, 2, 6, 7, 3);
+            AddQuad(indices, 0, 2, 3, 1);
+            AddQuad(indices, 4, 5, 7, 6);
+        }
+
+        /** Generates an octahedron with its corners at a distance of 0.5 on the axes (matching mesh_octahedron.obj). */
+        void GenerateOctahedron(std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+        {
+            positions.insert(positions.end(), { glm::vec3(0.5f, 0.0f, 0.0f), glm::vec3(-0.5f, 0.0f, 0.0f), glm::vec3(0.0f, 0.5f, 0.0f),
+                glm::vec3(0.0f, -0.5f, 0.0f), glm::vec3(0.0f, 0.0f, 0.5f), glm::vec3(0.0f, 0.0f, -0.5f) });
+            indices.insert(indices.end(), { 0, 2, 4, 4, 2, 1, 1, 2, 5, 5, 2, 0, 0, 4, 3, 4, 1, 3, 1, 5, 3, 5, 0, 3 });
+        }
+
+        /** Generates a sphere with radius 0.5 (matching mesh_sphere.obj) with the given tessellation. */
+        void GenerateSphere(unsigned int segments, unsigned int rings, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+        {
+            positions.emplace_back(0.0f, 0.5f, 0.0f);
+            for (unsigned int r = 1; r < rings; ++r) {
+                auto theta = glm::pi<float>() * static_cast<float>(r) / static_cast<float>(rings);
+                for (unsigned int s = 0; s < segments; ++s) {
+                    auto phi = glm::two_pi<float>() * static_cast<float>(s) / static_cast<float>(segments);
+                    positions.emplace_back(0.5f * glm::sin(theta) * glm::cos(phi), 0.5f * glm::cos(theta), 0.5f * glm::sin(theta) * glm::sin(phi));
+                }
+            }
+            positions.emplace_back(0.0f, -0.5f, 0.0f);
+
+            auto southPole = static_cast<unsigned int>(positions.size() - 1);
+            auto ring = [segments](unsigned int r, unsigned int s) { return 1 + (r - 1) * segments + (s % segments); };
+            for (unsigned int s = 0; s < segments; ++s) {
+                indices.insert(indices.end(), { 0, ring(1, s + 1), ring(1, s) });
+                for (unsigned int r = 1; r < rings - 1; ++r) AddQuad(indices, ring(r, s), ring(r, s + 1), ring(r + 1, s + 1), ring(r + 1, s));
+                indices.insert(indices.end(), { southPole, ring(rings - 1, s), ring(rings - 1, s + 1) });
+            }
+        }
+
+        /** Generates a cylinder along the y-axis with radius and height of 0.5 and 1 (matching mesh_cylinder.obj). */
+        void GenerateCylinder(unsigned int segments, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+        {
+            for (unsigned int s = 0; s < segments; ++s) {
+                auto phi = glm::two_pi<float>() * static_cast<float>(s) / static_cast<float>(segments);
+                positions.emplace_back(0.5f * glm::cos(phi), -0.5f, 0.5f * glm::sin(phi));
+                positions.emplace_back(0.5f * glm::cos(phi), 0.5f, 0.5f * glm::sin(phi));
+            }
+
+            for (unsigned int s = 0; s < segments; ++s) {
+                auto sn = (s + 1) % segments;
+                AddQuad(indices, 2 * s, 2 * s + 1, 2 * sn + 1, 2 * sn);
+            }
+            for (unsigned int s = 1; s < segments - 1; ++s) {
+                indices.insert(indices.end(), { 1, 2 * (s + 1) + 1, 2 * s + 1 });
+                indices.insert(indices.end(), { 0, 2 * s, 2 * (s + 1) });
+            }
+        }
+
+        /** Generates a torus around the y-axis with radii of 0.5 and 0.05 (matching mesh_torus.obj). */
+        void GenerateTorus(unsigned int segments, unsigned int tubeSegments, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+        {
+            for (unsigned int s = 0; s < segments; ++s) {
+                auto phi = glm::two_pi<float>() * static_cast<float>(s) / static_cast<float>(segments);
+                for (unsigned int t = 0; t < tubeSegments; ++t) {
+                    auto theta = glm::two_pi<float>() * static_cast<float>(t) / static_cast<float>(tubeSegments);
+                    auto radius = 0.5f + 0.05f * glm::cos(theta);
+                    positions.emplace_back(radius * glm::cos(phi), 0.05f * glm::sin(theta), radius * glm::sin(phi));
+                }
+            }
+
+            auto idx = [segments, tubeSegments](unsigned int s, unsigned int t) { return (s % segments) * tubeSegments + (t % tubeSegments); };
+            for (unsigned int s = 0; s < segments; ++s) {
+                for (unsigned int t = 0; t < tubeSegments; ++t) AddQuad(indices, idx(s, t), idx(s, t + 1), idx(s + 1, t + 1), idx(s + 1, t));
+            }
+        }
+
+        /** Frustum planes and projection information used for culling and level of detail selection. */
+        struct FrustumCullingData
+        {
+            /** Holds the normalized frustum planes (pointing inwards). */
+            std::array<glm::vec4, 6> planes_;
+            /** Holds the last row of the view projection matrix (to calculate w). */
+            glm::vec4 wRow_;
+            /** Holds the scale from world space radius to projected radius at w = 1. */
+            float projectionScale_;
+        };
+
+        FrustumCullingData ExtractFrustum(const glm::mat4& VPMatrix)
+        {
+            FrustumCullingData result;
+            auto row0 = glm::row(VPMatrix, 0), row1 = glm::row(VPMatrix, 1), row2 = glm::row(VPMatrix, 2);
+            result.wRow_ = glm::row(VPMatrix, 3);
+            result.planes_ = { { result.wRow_ + row0, result.wRow_ - row0, result.wRow_ + row1, result.wRow_ - row1, result.wRow_ + row2, result.wRow_ - row2 } };
+            for (auto& plane : result.planes_) plane /= glm::length(glm::vec3(plane));
+            result.projectionScale_ = glm::length(glm::vec3(row1));
+            return result;
+        }
+
+        /**
+         *  Classifies bounding spheres as culled (0), full detail (1) or low detail (2).
+         *  Four spheres are tested at once if SSE is available.
+         *  @param spheres the world space bounding spheres.
+         *  @param count the number of spheres.
+         *  @param frustum the frustum to test against.
+         *  @param frustumCulling whether to cull against the frustum planes.
+         *  @param lowDetailRadius projected radius below which the low detail class is selected.
+         *  @param minimumRadius projected radius below which spheres are culled.
+         *  @param classes the resulting classes.
+         */
+        void ClassifyBoundingSpheres(const glm::vec4* spheres, std::size_t count, const FrustumCullingData& frustum,
+            bool frustumCulling, float lowDetailRadius, float minimumRadius, std::uint8_t* classes)
+        {
+            std::size_t i = 0;
+#ifdef ENH_SIMPLE_MESH_SSE
+            for (; i + 4 <= count; i += 4) {
+                auto x = _mm_loadu_ps(glm::value_ptr(spheres[i]));
+                auto y = _mm_loadu_ps(glm::value_ptr(spheres[i + 1]));
+                auto z = _mm_loadu_ps(glm::value_ptr(spheres[i + 2]));
+                auto r = _mm_loadu_ps(glm::value_ptr(spheres[i + 3]));
+                _MM_TRANSPOSE4_PS(x, y, z, r);
+
+                auto visible = _mm_cmpeq_ps(r, r);
+                if (frustumCulling) {
+                    auto negR = _mm_sub_ps(_mm_setzero_ps(), r);
+                    for (const auto& plane : frustum.planes_) {
+                        auto d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+                            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w)));
+                        visible = _mm_and_ps(visible, _mm_cmpge_ps(d, negR));
+                    }
+                }
+
+                auto w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(frustum.wRow_.x), x), _mm_mul_ps(_mm_set1_ps(frustum.wRow_.y), y)),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(frustum.wRow_.z), z), _mm_set1_ps(frustum.wRow_.w)));
+                auto projectedRadius = _mm_mul_ps(r, _mm_set1_ps(frustum.projectionScale_));
+                visible = _mm_andnot_ps(_mm_cmplt_ps(projectedRadius, _mm_mul_ps(w, _mm_set1_ps(minimumRadius))), visible);
+                auto lowDetail = _mm_cmplt_ps(projectedRadius, _mm_mul_ps(w, _mm_set1_ps(lowDetailRadius)));
+
+                auto visibleMask = _mm_movemask_ps(visible), lowDetailMask = _mm_movemask_ps(lowDetail);
+                for (int j = 0; j < 4; ++j) {
+                    if ((visibleMask & (1 << j)) == 0) classes[i + j] = 0;
+                    else classes[i + j] = (lowDetailMask & (1 << j)) != 0 ? 2 : 1;
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                glm::vec4 center{ glm::vec3(spheres[i]), 1.0f };
+                auto radius = spheres[i].w;
+                auto visible = true;
+                if (frustumCulling) {
+                    for (const auto& plane : frustum.planes_) visible = visible && glm::dot(plane, center) >= -radius;
+                }
+
+                auto w = glm::dot(frustum.wRow_, center);
+                auto projectedRadius = radius * frustum.projectionScale_;
+                if (projectedRadius < w * minimumRadius) visible = false;
+                if (!visible) classes[i] = 0;
+                else classes[i] = projectedRadius < w * lowDetailRadius ? 2 : 1;
+            }
+        }
+    }
+
+    /**
+     *  Creates the renderer with its meshes and programs.
+     *  @param app the application node.
+     *  @param generateShapes whether to generate the shapes instead of loading them with the mesh manager of the core
+     *      (for hosts without the core resources, e.g. the headless benchmark).
+     */
+    SimpleMeshRenderer::SimpleMeshRenderer(ApplicationNodeBase* app, bool generateShapes) :
+        stateCache_(app->GetGLStateCache()),
+        simpleProgram_(std::make_unique<GLProgram>(std::vector<std::string>{"drawSimple.vert", "drawSimple.frag"}, app)),
+        instancedProgram_(std::make_unique<GLProgram>(std::vector<std::string>{"drawSimpleInstanced.vert", "drawSimpleInstanced.frag"}, app)),
+        instancedUniformIds_(instancedProgram_->GetUniformLocations({ "vpMatrix", "instanceOffset" })),
+        indirectProgram_(std::make_unique<GLProgram>(std::vector<std::string>{"drawSimpleIndirect.vert", "drawSimpleInstanced.frag"}, app)),
+        indirectUniformIds_(indirectProgram_->GetUniformLocations({ "vpMatrix" })),
+        instanceBuffer_(std::make_unique<ShaderBufferObject>("simpleInstanceBuffer", app->GetSSBOBindingPoints())),
+        indirectBuffer_(std::make_unique<GLBuffer>(gl::GL_DYNAMIC_DRAW))
     {
         std::vector<SimpleVertex> vertices;
         std::vector<unsigned int> indices;
+        std::size_t maxSubmeshVertices = 0;
+        auto addSubmesh = [this, &vertices, &indices, &maxSubmeshVertices](unsigned int submeshId, const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& meshIndices) {
+            glm::vec3 boundsMin{ std::numeric_limits<float>::max() }, boundsMax{ std::numeric_limits<float>::lowest() };
+            for (const auto& vtx : positions) {
+                boundsMin = glm::min(boundsMin, vtx);
+                boundsMax = glm::max(boundsMax, vtx);
+            }
+            auto bias = 0.5f * (boundsMax + boundsMin);
+            auto scale = 0.5f * (boundsMax - boundsMin);
+            for (int j = 0; j < 3; ++j) if (scale[j] <= 0.0f) scale[j] = 1.0f;
+            auto radius = 0.0f;
+            for (const auto& vtx : positions) radius = glm::max(radius, glm::distance(vtx, bias));
+
+            submeshInfo_[submeshId].firstIndex_ = static_cast<unsigned>(indices.size());
+            submeshInfo_[submeshId].indexCount_ = static_cast<unsigned>(meshIndices.size());
+            submeshInfo_[submeshId].baseVertex_ = static_cast<int>(vertices.size());
+            submeshInfo_[submeshId].dequantization_ = glm::scale(glm::translate(glm::mat4(1.0f), bias), scale);
+            submeshInfo_[submeshId].boundingSphere_ = glm::vec4(bias, radius);
+            submeshInfo_[submeshId].lowDetailSubmesh_ = submeshId;
+            maxSubmeshVertices = std::max(maxSubmeshVertices, positions.size());
+
+            vertices.reserve(vertices.size() + positions.size());
+            for (const auto& vtx : positions) vertices.emplace_back((vtx - bias) / scale);
+            indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+        };
+
         std::array<std::string, 6> submeshNames = { "mesh_cone", "mesh_cube", "mesh_cylinder", "mesh_octahedron", "mesh_sphere", "mesh_torus" };
         for (unsigned int i = 0; i < 6; ++i) {
-            auto mesh = app->GetMeshManager().GetResource("/models/simple/" + submeshNames[i] + ".obj");
-            std::vector<SimpleVertex> meshVertices;
-            for (const auto& vtx : mesh->GetVertices()) meshVertices.emplace_back(glm::vec4(vtx, 1.0f));
-
-            submeshInfo_[i].first = static_cast<unsigned>(indices.size());
-            submeshInfo_[i].second = static_cast<unsigned>(mesh->GetIndices().size());
-
-            auto verticesMin = static_cast<unsigned>(vertices.size());
-            vertices.reserve(vertices.size() + meshVertices.size());
-            vertices.insert(vertices.end(), meshVertices.begin(), meshVertices.end());
-
-            indices.reserve(indices.size() + mesh->GetIndices().size());
-            for (unsigned int j : mesh->GetIndices()) {
-                indices.push_back(j + verticesMin);
+            if (!generateShapes) {
+                auto mesh = app->GetMeshManager().GetResource("/models/simple/" + submeshNames[i] + ".obj");
+                addSubmesh(i, mesh->GetVertices(), mesh->GetIndices());
+                continue;
             }
+
+            std::vector<glm::vec3> positions;
+            std::vector<unsigned int> meshIndices;
+            if (i == 0) GenerateCone(32, positions, meshIndices);
+            else if (i == 1) GenerateCube(positions, meshIndices);
+            else if (i == 2) GenerateCylinder(32, positions, meshIndices);
+            else if (i == 3) GenerateOctahedron(positions, meshIndices);
+            else if (i == 4) GenerateSphere(32, 16, positions, meshIndices);
+            else GenerateTorus(48, 16, positions, meshIndices);
+            addSubmesh(i, positions, meshIndices);
         }
 
-        submeshInfo_[6].first = static_cast<unsigned>(indices.size());
-        submeshInfo_[6].second = 1;
-        submeshInfo_[7].first = static_cast<unsigned>(indices.size());
-        submeshInfo_[7].second = 2;
-        indices.push_back(static_cast<unsigned>(vertices.size()));
-        indices.push_back(static_cast<unsigned>(vertices.size() + 1));
-        vertices.emplace_back(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
-        vertices.emplace_back(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+        // point and line share their vertices.
+        addSubmesh(6, std::vector<glm::vec3>{ glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) }, std::vector<unsigned int>{ 0 });
+        indices.push_back(1);
+        submeshInfo_[7] = submeshInfo_[6];
+        submeshInfo_[7].indexCount_ = 2;
+        submeshInfo_[7].lowDetailSubmesh_ = 7;
+
+        // low detail variants of the more complex shapes, their bounding spheres are the ones of the full detail meshes.
+        std::array<unsigned int, 3> lowDetailShapes = { static_cast<unsigned int>(Shape::CYLINDER), static_cast<unsigned int>(Shape::SPHERE), static_cast<unsigned int>(Shape::TORUS) };
+        for (unsigned int i = 0; i < 3; ++i) {
+            std::vector<glm::vec3> positions;
+            std::vector<unsigned int> meshIndices;
+            if (i == 0) GenerateCylinder(8, positions, meshIndices);
+            else if (i == 1) GenerateSphere(8, 5, positions, meshIndices);
+            else GenerateTorus(12, 6, positions, meshIndices);
+
+            auto submeshId = static_cast<unsigned int>(NUM_SHAPES) + i;
+            addSubmesh(submeshId, positions, meshIndices);
+            submeshInfo_[submeshId].boundingSphere_ = submeshInfo_[lowDetailShapes[i]].boundingSphere_;
+            submeshInfo_[lowDetailShapes[i]].lowDetailSubmesh_ = submeshId;
+        }
 
         vBuffer_ = std::make_unique<GLBuffer>(gl::GL_STATIC_DRAW);
         gl::glBindBuffer(gl::GL_ARRAY_BUFFER, vBuffer_->GetBuffer());
         vBuffer_->InitializeData(vertices);
         gl::glBindBuffer(gl::GL_ARRAY_BUFFER, 0);
 
+        // indices are local to each sub mesh (see baseVertex_), so 16 bit are enough for all but very large meshes.
         iBuffer_ = std::make_unique<GLBuffer>(gl::GL_STATIC_DRAW);
         gl::glBindBuffer(gl::GL_ELEMENT_ARRAY_BUFFER, iBuffer_->GetBuffer());
-        iBuffer_->InitializeData(indices);
+        if (maxSubmeshVertices <= std::numeric_limits<std::uint16_t>::max() + std::size_t{ 1 }) {
+            std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+            iBuffer_->InitializeData(shortIndices);
+            indexType_ = gl::GL_UNSIGNED_SHORT;
+            indexSize_ = sizeof(std::uint16_t);
+        } else {
+            iBuffer_->InitializeData(indices);
+            indexType_ = gl::GL_UNSIGNED_INT;
+            indexSize_ = sizeof(unsigned int);
+        }
         gl::glBindBuffer(gl::GL_ELEMENT_ARRAY_BUFFER, 0);
 
         std::vector<std::string> attributeNames;
@@ -91,9 +367,16 @@ namespace viscom::enh {
         gl::glBindBuffer(gl::GL_ARRAY_BUFFER, 0);
 
         drawAttribBinds_.GetUniformIds() = simpleProgram_->GetUniformLocations({ "vpMatrix", "modelMatrix", "color", "pointSize" });
+
+        app->GetSSBOBindingPoints()->BindStorageBufferBlock(instancedProgram_->GetProgramId(), "simpleInstanceBuffer");
+        app->GetSSBOBindingPoints()->BindStorageBufferBlock(indirectProgram_->GetProgramId(), "simpleInstanceBuffer");
     }
 
-    SimpleMeshRenderer::~SimpleMeshRenderer() = default;
+    SimpleMeshRenderer::~SimpleMeshRenderer()
+    {
+        // the programs, buffers and vertex arrays are deleted with the renderer.
+        stateCache_->Invalidate();
+    }
 
     void SimpleMeshRenderer::DrawCone(const glm::mat4& VPMatrix, const glm::mat4& modelMatrix, const glm::vec4& color) const
     {
@@ -137,22 +420,197 @@ namespace viscom::enh {
 
     void SimpleMeshRenderer::DrawSubmesh(const glm::mat4& VPMatrix, const glm::mat4& modelMatrix, const glm::vec4& color, unsigned int submeshId, float pointSize) const
     {
-        gl::glUseProgram(simpleProgram_->getProgramId());
+        stateCache_->InvalidateExternalState();
+        stateCache_->UseProgram(simpleProgram_->GetProgramId());
         gl::glUniformMatrix4fv(drawAttribBinds_.GetUniformIds()[0], 1, gl::GL_FALSE, glm::value_ptr(VPMatrix));
-        gl::glUniformMatrix4fv(drawAttribBinds_.GetUniformIds()[1], 1, gl::GL_FALSE, glm::value_ptr(modelMatrix));
+        auto quantizedModelMatrix = modelMatrix * submeshInfo_[submeshId].dequantization_;
+        gl::glUniformMatrix4fv(drawAttribBinds_.GetUniformIds()[1], 1, gl::GL_FALSE, glm::value_ptr(quantizedModelMatrix));
         gl::glUniform4fv(drawAttribBinds_.GetUniformIds()[2], 1, glm::value_ptr(color));
         gl::glUniform1f(drawAttribBinds_.GetUniformIds()[3], pointSize);
 
-        gl::glBindBuffer(gl::GL_ARRAY_BUFFER, vBuffer_->GetBuffer());
-        drawAttribBinds_.GetVertexAttributes()[0]->EnableVertexAttributeArray();
+        drawAttribBinds_.GetVertexAttributes()[0]->EnableVertexAttributeArray(stateCache_);
+
+        gl::glDrawElementsBaseVertex(GetPrimitiveType(submeshId), submeshInfo_[submeshId].indexCount_, indexType_,
+            (static_cast<char*> (nullptr)) + (submeshInfo_[submeshId].firstIndex_ * indexSize_), submeshInfo_[submeshId].baseVertex_); //-V104
+
+        // the vertex array is unbound so later element buffer bindings do not modify it.
+        drawAttribBinds_.GetVertexAttributes()[0]->DisableVertexAttributeArray(stateCache_);
+        stateCache_->UseProgram(0);
+    }
+
+    gl::GLenum SimpleMeshRenderer::GetPrimitiveType(unsigned int submeshId)
+    {
+        if (submeshId == 6) return gl::GL_POINTS;
+        if (submeshId == 7) return gl::GL_LINES;
+        return gl::GL_TRIANGLES;
+    }
+
+    /**
+     *  Queues a mesh for batched rendering. Nothing is drawn until Flush is called.
+     *  @param shape the shape to draw.
+     *  @param modelMatrix the model matrix of the instance.
+     *  @param color the color of the instance.
+     *  @param pointSize the point size (only used for points).
+     */
+    void SimpleMeshRenderer::Submit(Shape shape, const glm::mat4& modelMatrix, const glm::vec4& color, float pointSize)
+    {
+        auto submeshId = static_cast<unsigned int>(shape);
+        instanceQueues_[submeshId].push_back(InstanceData{ modelMatrix * submeshInfo_[submeshId].dequantization_, color, pointSize, { 0.0f, 0.0f, 0.0f } });
+
+        const auto& sphere = submeshInfo_[submeshId].boundingSphere_;
+        auto maxScale = glm::max(glm::length(glm::vec3(modelMatrix[0])), glm::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+        boundingSphereQueues_[submeshId].emplace_back(glm::vec3(modelMatrix * glm::vec4(glm::vec3(sphere), 1.0f)), sphere.w * maxScale);
+    }
+
+    /**
+     *  Draws all instances submitted since the last flush.
+     *  The instances are first culled against the view frustum using their bounding spheres and the low detail
+     *  variants of cylinders, spheres and tori are selected for instances with a small projected size.
+     *  All remaining instances are uploaded to a single buffer that is re-specified each flush. Depending on the batch
+     *  mode this either issues one instanced draw call per sub mesh or a single multi draw indirect call for all
+     *  triangle meshes (points and lines need their own primitive types and get one indirect draw each).
+     *  @param VPMatrix the view projection matrix.
+     */
+    void SimpleMeshRenderer::Flush(const glm::mat4& VPMatrix)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        batchStatistics_ = BatchStatistics{};
+        stateCache_->InvalidateExternalState();
+        auto issuedStateCalls = stateCache_->GetStatistics().issuedCalls_;
+
+        auto frustum = ExtractFrustum(VPMatrix);
+        std::array<std::size_t, NUM_SUBMESHES> instanceCounts;
+        instanceCounts.fill(0);
+        instanceClasses_.clear();
+        for (unsigned int i = 0; i < NUM_SHAPES; ++i) {
+            auto firstInstance = instanceClasses_.size();
+            auto lowDetailSubmesh = submeshInfo_[i].lowDetailSubmesh_;
+            auto triangleMesh = GetPrimitiveType(i) == gl::GL_TRIANGLES;
+            instanceClasses_.resize(firstInstance + boundingSphereQueues_[i].size());
+            ClassifyBoundingSpheres(boundingSphereQueues_[i].data(), boundingSphereQueues_[i].size(), frustum, cullingParameters_.frustumCulling_,
+                lowDetailSubmesh != i ? cullingParameters_.lowDetailRadius_ : 0.0f, triangleMesh ? cullingParameters_.minimumRadius_ : 0.0f,
+                instanceClasses_.data() + firstInstance);
+
+            for (auto j = firstInstance; j < instanceClasses_.size(); ++j) {
+                if (instanceClasses_[j] == 1) instanceCounts[i] += 1;
+                else if (instanceClasses_[j] == 2) instanceCounts[lowDetailSubmesh] += 1;
+            }
+            batchStatistics_.instances_ += instanceQueues_[i].size();
+        }
+
+        std::array<std::size_t, NUM_SUBMESHES> instanceOffsets;
+        std::size_t drawnInstances = 0;
+        for (std::size_t i = 0; i < NUM_SUBMESHES; ++i) {
+            instanceOffsets[i] = drawnInstances;
+            drawnInstances += instanceCounts[i];
+        }
+
+        instanceData_.resize(drawnInstances);
+        auto writePositions = instanceOffsets;
+        std::size_t instanceClassIndex = 0;
+        for (unsigned int i = 0; i < NUM_SHAPES; ++i) {
+            // the instance matrices contain the dequantization of the full detail mesh.
+            auto lowDetailSubmesh = submeshInfo_[i].lowDetailSubmesh_;
+            auto lowDetailRequantization = glm::inverse(submeshInfo_[i].dequantization_) * submeshInfo_[lowDetailSubmesh].dequantization_;
+            for (const auto& instance : instanceQueues_[i]) {
+                auto instanceClass = instanceClasses_[instanceClassIndex++];
+                if (instanceClass == 0) continue;
+
+                auto submeshId = instanceClass == 1 ? i : lowDetailSubmesh;
+                auto& data = instanceData_[writePositions[submeshId]++];
+                data = instance;
+                if (submeshId != i) data.modelMatrix_ = data.modelMatrix_ * lowDetailRequantization;
+            }
+            instanceQueues_[i].clear();
+            boundingSphereQueues_[i].clear();
+        }
+
+        batchStatistics_.drawnInstances_ = drawnInstances;
+        batchStatistics_.culledInstances_ = batchStatistics_.instances_ - drawnInstances;
+        for (std::size_t i = NUM_SHAPES; i < NUM_SUBMESHES; ++i) batchStatistics_.lowDetailInstances_ += instanceCounts[i];
+
+        if (!instanceData_.empty()) {
+            instanceBuffer_->GetBuffer()->InitializeData(instanceData_);
+            instanceBuffer_->BindBuffer(stateCache_);
+            batchStatistics_.glCalls_ += 1;
+
+            if (batchMode_ == BatchMode::MULTI_DRAW_INDIRECT) FlushIndirect(VPMatrix, instanceOffsets, instanceCounts);
+            else FlushInstanced(VPMatrix, instanceOffsets, instanceCounts);
+        }
 
-        auto primitiveType = gl::GL_TRIANGLES;
-        if (submeshId == 6) primitiveType = gl::GL_POINTS;
-        if (submeshId == 7) primitiveType = gl::GL_LINES;
-        glDrawElements(primitiveType, submeshInfo_[submeshId].second, gl::GL_UNSIGNED_INT,
-            (static_cast<char*> (nullptr)) + (submeshInfo_[submeshId].first * sizeof(unsigned int))); //-V104
+        batchStatistics_.glCalls_ += stateCache_->GetStatistics().issuedCalls_ - issuedStateCalls;
+        batchStatistics_.cpuTime_ = std::chrono::steady_clock::now() - startTime;
+    }
+
+    void SimpleMeshRenderer::FlushInstanced(const glm::mat4& VPMatrix, const std::array<std::size_t, NUM_SUBMESHES>& instanceOffsets,
+        const std::array<std::size_t, NUM_SUBMESHES>& instanceCounts)
+    {
+        stateCache_->UseProgram(instancedProgram_->GetProgramId());
+        gl::glUniformMatrix4fv(instancedUniformIds_[0], 1, gl::GL_FALSE, glm::value_ptr(VPMatrix));
+        drawAttribBinds_.GetVertexAttributes()[0]->EnableVertexAttributeArray(stateCache_);
+        batchStatistics_.glCalls_ += 1;
+
+        for (unsigned int i = 0; i < static_cast<unsigned int>(NUM_SUBMESHES); ++i) {
+            if (instanceCounts[i] == 0) continue;
+
+            gl::glUniform1ui(instancedUniformIds_[1], static_cast<gl::GLuint>(instanceOffsets[i]));
+            gl::glDrawElementsInstancedBaseVertex(GetPrimitiveType(i), submeshInfo_[i].indexCount_, indexType_,
+                (static_cast<char*> (nullptr)) + (submeshInfo_[i].firstIndex_ * indexSize_), //-V104
+                static_cast<gl::GLsizei>(instanceCounts[i]), submeshInfo_[i].baseVertex_);
+            batchStatistics_.drawCalls_ += 1;
+            batchStatistics_.glCalls_ += 2;
+        }
+
+        drawAttribBinds_.GetVertexAttributes()[0]->DisableVertexAttributeArray(stateCache_);
+        stateCache_->UseProgram(0);
+    }
+
+    void SimpleMeshRenderer::FlushIndirect(const glm::mat4& VPMatrix, const std::array<std::size_t, NUM_SUBMESHES>& instanceOffsets,
+        const std::array<std::size_t, NUM_SUBMESHES>& instanceCounts)
+    {
+        // triangle meshes first, so they can be drawn with a single call, then points and lines.
+        indirectCommands_.clear();
+        std::array<std::size_t, 3> commandRanges = { 0, 0, 0 };
+        std::array<unsigned int, NUM_SUBMESHES> submeshOrder = { 0, 1, 2, 3, 4, 5, 8, 9, 10, 6, 7 };
+        for (auto i : submeshOrder) {
+            if (instanceCounts[i] == 0) continue;
+
+            DrawElementsIndirectCommand cmd;
+            cmd.count_ = submeshInfo_[i].indexCount_;
+            cmd.instanceCount_ = static_cast<gl::GLuint>(instanceCounts[i]);
+            cmd.firstIndex_ = submeshInfo_[i].firstIndex_;
+            cmd.baseVertex_ = submeshInfo_[i].baseVertex_;
+            cmd.baseInstance_ = static_cast<gl::GLuint>(instanceOffsets[i]);
+            indirectCommands_.push_back(cmd);
+
+            if (i == 6) commandRanges[1] += 1;
+            else if (i == 7) commandRanges[2] += 1;
+            else commandRanges[0] += 1;
+        }
+
+        indirectBuffer_->InitializeData(indirectCommands_);
+        stateCache_->BindBuffer(gl::GL_DRAW_INDIRECT_BUFFER, indirectBuffer_->GetBuffer());
+
+        stateCache_->UseProgram(indirectProgram_->GetProgramId());
+        gl::glUniformMatrix4fv(indirectUniformIds_[0], 1, gl::GL_FALSE, glm::value_ptr(VPMatrix));
+        drawAttribBinds_.GetVertexAttributes()[0]->EnableVertexAttributeArray(stateCache_);
+        batchStatistics_.glCalls_ += 2;
+
+        std::array<gl::GLenum, 3> primitiveTypes = { gl::GL_TRIANGLES, gl::GL_POINTS, gl::GL_LINES };
+        std::size_t firstCommand = 0;
+        for (std::size_t i = 0; i < commandRanges.size(); ++i) {
+            if (commandRanges[i] == 0) continue;
+
+            gl::glMultiDrawElementsIndirect(primitiveTypes[i], indexType_,
+                (static_cast<char*> (nullptr)) + (firstCommand * sizeof(DrawElementsIndirectCommand)), //-V104
+                static_cast<gl::GLsizei>(commandRanges[i]), 0);
+            firstCommand += commandRanges[i];
+            batchStatistics_.drawCalls_ += 1;
+            batchStatistics_.glCalls_ += 1;
+        }
 
-        drawAttribBinds_.GetVertexAttributes()[0]->DisableVertexAttributeArray();
-        gl::glUseProgram(0);
+        drawAttribBinds_.GetVertexAttributes()[0]->DisableVertexAttributeArray(stateCache_);
+        stateCache_->BindBuffer(gl::GL_DRAW_INDIRECT_BUFFER, 0);
+        stateCache_->UseProgram(0);
     }
 }
@@ -10,22 +10,78 @@
 
 #include "enh/gfx/gl/ShaderMeshAttributes.h"
 
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
 
-namespace viscom {
-    class GPUProgram;
-}
-
 namespace viscom::enh {
 
     class ApplicationNodeBase;
     class GLBuffer;
+    class GLProgram;
+    class GLStateCache;
+    class ShaderBufferObject;
 
     class SimpleMeshRenderer
     {
     public:
-        explicit SimpleMeshRenderer(ApplicationNodeBase* app);
+        /** The shapes available in the simple meshes (the values are the sub mesh ids). */
+        enum class Shape : unsigned int
+        {
+            CONE = 0,
+            CUBE = 1,
+            CYLINDER = 2,
+            OCTAHEDRON = 3,
+            SPHERE = 4,
+            TORUS = 5,
+            POINT = 6,
+            LINE = 7
+        };
+
+        /** The way batched meshes are drawn. */
+        enum class BatchMode
+        {
+            /** One instanced draw call per shape. */
+            INSTANCED,
+            /** One multi draw indirect call for all shapes (per primitive type). */
+            MULTI_DRAW_INDIRECT
+        };
+
+        /** Parameters of the culling and level of detail selection of batched meshes. */
+        struct CullingParameters
+        {
+            /** Holds whether batched instances outside the view frustum are culled. */
+            bool frustumCulling_ = true;
+            /** Holds the projected radius (in normalized device coordinates) below which the low detail meshes are used. */
+            float lowDetailRadius_ = 0.03f;
+            /** Holds the projected radius below which instances are not drawn at all (0 disables this). */
+            float minimumRadius_ = 0.0f;
+        };
+
+        /** Statistics of the last call to Flush. */
+        struct BatchStatistics
+        {
+            /** Holds the number of flushed instances. */
+            std::size_t instances_ = 0;
+            /** Holds the number of instances drawn. */
+            std::size_t drawnInstances_ = 0;
+            /** Holds the number of instances culled. */
+            std::size_t culledInstances_ = 0;
+            /** Holds the number of instances drawn with a low detail mesh. */
+            std::size_t lowDetailInstances_ = 0;
+            /** Holds the number of draw calls issued. */
+            std::size_t drawCalls_ = 0;
+            /** Holds the number of OpenGL calls issued. */
+            std::size_t glCalls_ = 0;
+            /** Holds the CPU time needed for the flush. */
+            std::chrono::duration<double, std::micro> cpuTime_{ 0.0 };
+        };
+
+        explicit SimpleMeshRenderer(ApplicationNodeBase* app, bool generateShapes = false);
         ~SimpleMeshRenderer();
 
         void DrawCone(const glm::mat4& VPMatrix, const glm::mat4& modelMatrix, const glm::vec4& color) const;
@@ -37,20 +93,107 @@ namespace viscom::enh {
         void DrawPoint(const glm::mat4& VPMatrix, const glm::mat4& modelMatrix, const glm::vec4& color, float pointSize) const;
         void DrawLine(const glm::mat4& VPMatrix, const glm::mat4& modelMatrix, const glm::vec4& color) const;
 
+        void Submit(Shape shape, const glm::mat4& modelMatrix, const glm::vec4& color, float pointSize = 1.0f);
+        void Flush(const glm::mat4& VPMatrix);
+        void SetBatchMode(BatchMode mode) { batchMode_ = mode; }
+        BatchMode GetBatchMode() const { return batchMode_; }
+        void SetCullingParameters(const CullingParameters& params) { cullingParameters_ = params; }
+        const CullingParameters& GetCullingParameters() const { return cullingParameters_; }
+        const BatchStatistics& GetBatchStatistics() const { return batchStatistics_; }
+
     private:
+        /** The number of shapes that can be submitted. */
+        static constexpr std::size_t NUM_SHAPES = 8;
+        /** The number of sub meshes (shapes and low detail variants). */
+        static constexpr std::size_t NUM_SUBMESHES = 11;
+
+        /** Per instance data of batched draws, layout matches the std430 buffer in drawSimpleInstanced.vert. */
+        struct InstanceData
+        {
+            glm::mat4 modelMatrix_;
+            glm::vec4 color_;
+            float pointSize_;
+            float padding_[3];
+        };
+
+        /** Layout of the commands in the draw indirect buffer as defined by OpenGL. */
+        struct DrawElementsIndirectCommand
+        {
+            gl::GLuint count_;
+            gl::GLuint instanceCount_;
+            gl::GLuint firstIndex_;
+            gl::GLint baseVertex_;
+            gl::GLuint baseInstance_;
+        };
+
         void DrawSubmesh(const glm::mat4& VPMatrix, const glm::mat4& modelMatrix, const glm::vec4& color, unsigned int submeshId, float pointSize = 1.0f) const;
+        void FlushInstanced(const glm::mat4& VPMatrix, const std::array<std::size_t, NUM_SUBMESHES>& instanceOffsets,
+            const std::array<std::size_t, NUM_SUBMESHES>& instanceCounts);
+        void FlushIndirect(const glm::mat4& VPMatrix, const std::array<std::size_t, NUM_SUBMESHES>& instanceOffsets,
+            const std::array<std::size_t, NUM_SUBMESHES>& instanceCounts);
+        static gl::GLenum GetPrimitiveType(unsigned int submeshId);
 
-        using SimpleSubMesh = std::pair<unsigned int, unsigned int>;
+        /** Describes a sub mesh in the merged vertex and index buffers. */
+        struct SimpleSubMesh
+        {
+            /** Holds the first index of the sub mesh in the index buffer. */
+            unsigned int firstIndex_ = 0;
+            /** Holds the number of indices of the sub mesh. */
+            unsigned int indexCount_ = 0;
+            /** Holds the vertex the sub mesh local indices are relative to. */
+            int baseVertex_ = 0;
+            /** Holds the matrix restoring the quantized positions from the sub mesh bounds (scale and bias). */
+            glm::mat4 dequantization_ = glm::mat4(1.0f);
+            /** Holds the object space bounding sphere (center and radius) of the sub mesh. */
+            glm::vec4 boundingSphere_ = glm::vec4(0.0f);
+            /** Holds the id of the low detail variant of the sub mesh (the sub mesh itself if there is none). */
+            unsigned int lowDetailSubmesh_ = 0;
+        };
 
+        /** Holds the OpenGL state cache. */
+        GLStateCache* stateCache_;
         /** Holds the sub mesh information. */
-        std::array<SimpleSubMesh, 8> submeshInfo_;
+        std::array<SimpleSubMesh, NUM_SUBMESHES> submeshInfo_;
         /** Holds the simple GPU program for mesh rendering. */
-        std::shared_ptr<GPUProgram> simpleProgram_;
+        std::unique_ptr<GLProgram> simpleProgram_;
         /** Holds the vertex buffer. */
         std::unique_ptr<GLBuffer> vBuffer_;
         /** Holds the index buffer of the mesh base. */
         std::unique_ptr<GLBuffer> iBuffer_;
+        /** Holds the type of the indices in the index buffer. */
+        gl::GLenum indexType_ = gl::GL_UNSIGNED_INT;
+        /** Holds the size of an index in bytes. */
+        std::size_t indexSize_ = sizeof(unsigned int);
         /** Holds the shader attribute bindings for the shader. */
         ShaderMeshAttributes drawAttribBinds_;
+
+        /** Holds the GPU program for instanced rendering of batched meshes. */
+        std::unique_ptr<GLProgram> instancedProgram_;
+        /** Holds the uniform ids of the instanced program. */
+        std::vector<gl::GLint> instancedUniformIds_;
+        /** Holds the GPU program for multi draw indirect rendering of batched meshes. */
+        std::unique_ptr<GLProgram> indirectProgram_;
+        /** Holds the uniform ids of the multi draw indirect program. */
+        std::vector<gl::GLint> indirectUniformIds_;
+        /** Holds the batch mode. */
+        BatchMode batchMode_ = BatchMode::INSTANCED;
+        /** Holds the culling and level of detail parameters. */
+        CullingParameters cullingParameters_;
+        /** Holds the instances submitted since the last flush for each shape. */
+        std::array<std::vector<InstanceData>, NUM_SHAPES> instanceQueues_;
+        /** Holds the world space bounding spheres of the submitted instances for each shape. */
+        std::array<std::vector<glm::vec4>, NUM_SHAPES> boundingSphereQueues_;
+        /** Holds the culling and level of detail classification of the submitted instances. */
+        std::vector<std::uint8_t> instanceClasses_;
+        /** Holds the instance data of all sub meshes for upload. */
+        std::vector<InstanceData> instanceData_;
+        /** Holds the per frame instance buffer. */
+        std::unique_ptr<ShaderBufferObject> instanceBuffer_;
+        /** Holds the draw commands for multi draw indirect rendering. */
+        std::vector<DrawElementsIndirectCommand> indirectCommands_;
+        /** Holds the draw indirect buffer. */
+        std::unique_ptr<GLBuffer> indirectBuffer_;
+        /** Holds the statistics of the last flush. */
+        BatchStatistics batchStatistics_;
     };
 }
@@ -0,0 +1,172 @@
+/**
+ * @file   AutoExposure.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the automatic exposure using a luminance histogram.
+ */
+
+#include "AutoExposure.h"
+#include "core/main.h"
+#include "enh/ApplicationNodeBase.h"
+#include "enh/core/profiler.h"
+#include "enh/gfx/gl/GLProgram.h"
+#include "enh/gfx/gl/ShaderBufferBindingPoints.h"
+#include "enh/gfx/gl/ShaderBufferObject.h"
+#include <glm/vec2.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <imgui.h>
+#include <algorithm>
+#include <cmath>
+
+namespace viscom::enh {
+
+    namespace {
+        /** The number of histogram bins, see NUM_BINS in luminanceHistogram.comp. */
+        constexpr std::size_t numBins = 256;
+        /** The work group size of the histogram, see GROUP_SIZE in luminanceHistogram.comp. */
+        constexpr unsigned int histogramGroupSize = 16;
+    }
+
+    AutoExposure::AutoExposure(ApplicationNodeBase* app) :
+        stateCache_{ app->GetGLStateCache() },
+        histogramProgram_{ std::make_unique<GLProgram>(std::vector<std::string>{ "tm/luminanceHistogram.comp" }, app) },
+        histogramUniformIds_{ histogramProgram_->GetUniformLocations({ "sampleCount", "minLogLuminance", "invLogLuminanceRange" }) },
+        adaptProgram_{ std::make_unique<GLProgram>(std::vector<std::string>{ "tm/adaptExposure.comp" }, app) },
+        adaptUniformIds_{ adaptProgram_->GetUniformLocations({ "sampleCount", "minLogLuminance", "logLuminanceRange", "adaptation", "middleGrey" }) },
+        histogramBuffer_{ std::make_unique<ShaderBufferObject>("luminanceHistogramBuffer", app->GetSSBOBindingPoints()) },
+        exposureBuffer_{ std::make_unique<ShaderBufferObject>("exposureBuffer", app->GetSSBOBindingPoints()) }
+    {
+        params_.minLogLuminance_ = -10.0f;
+        params_.maxLogLuminance_ = 4.0f;
+        params_.adaptationRate_ = 1.5f;
+        params_.middleGrey_ = 0.18f;
+
+        app->GetSSBOBindingPoints()->BindStorageBufferBlock(histogramProgram_->GetProgramId(), "luminanceHistogramBuffer");
+        app->GetSSBOBindingPoints()->BindStorageBufferBlock(adaptProgram_->GetProgramId(), "luminanceHistogramBuffer");
+        app->GetSSBOBindingPoints()->BindStorageBufferBlock(adaptProgram_->GetProgramId(), "exposureBuffer");
+
+        std::vector<std::uint32_t> emptyHistogram(numBins, 0);
+        histogramBuffer_->GetBuffer()->InitializeData(emptyHistogram);
+        // a negative adapted luminance lets the first frame start fully adapted.
+        std::array<float, 4> initialExposure{ { 0.0f, -1.0f, 1.0f, 0.0f } };
+        exposureBuffer_->GetBuffer()->InitializeData(initialExposure);
+        for (auto& readback : readbacks_) readback.buffer_.InitializeData(sizeof(initialExposure), nullptr);
+    }
+
+    AutoExposure::~AutoExposure()
+    {
+        for (auto& readback : readbacks_) if (readback.fence_) gl::glDeleteSync(readback.fence_);
+        // the programs and buffers are deleted with the object.
+        stateCache_->Invalidate();
+    }
+
+    void AutoExposure::RenderParameterSliders()
+    {
+        if (ImGui::TreeNode("Auto Exposure Parameters"))
+        {
+            ImGui::DragFloatRange2("Log Luminance Range", &params_.minLogLuminance_, &params_.maxLogLuminance_, 0.1f, -20.0f, 20.0f);
+            ImGui::InputFloat("Adaptation Rate", &params_.adaptationRate_, 0.1f);
+            ImGui::InputFloat("Middle Grey", &params_.middleGrey_, 0.01f);
+            ImGui::Text("Average Luminance: %.4f", GetAverageLuminance());
+            ImGui::Text("Adapted Luminance: %.4f", GetAdaptedLuminance());
+            ImGui::Text("Exposure: %.4f", GetExposure());
+            ImGui::Checkbox("Log Exposure", &log_);
+            ImGui::TreePop();
+        }
+    }
+
+    /**
+     *  Builds the luminance histogram of the source and adapts the exposure.
+     *  @param sourceTex the HDR image to compute the exposure for (may be down sampled).
+     *  @param elapsedTime the time since the last update in seconds.
+     */
+    void AutoExposure::Update(gl::GLuint sourceTex, float elapsedTime)
+    {
+        ENH_PROFILE_CPU("AutoExposure");
+        ENH_PROFILE_GPU("AutoExposure");
+
+        stateCache_->InvalidateExternalState();
+        CollectReadbacks();
+
+        glm::ivec2 sourceSize;
+        gl::glGetTextureLevelParameteriv(sourceTex, 0, gl::GL_TEXTURE_WIDTH, &sourceSize.x);
+        gl::glGetTextureLevelParameteriv(sourceTex, 0, gl::GL_TEXTURE_HEIGHT, &sourceSize.y);
+        // sample (at most) every second texel, bilinear filtering averages the texels in between.
+        glm::uvec2 sampleCount{ std::min(std::max(static_cast<unsigned int>(sourceSize.x) / 2u, 1u), MAX_SAMPLES),
+            std::min(std::max(static_cast<unsigned int>(sourceSize.y) / 2u, 1u), MAX_SAMPLES) };
+        auto logLuminanceRange = std::max(params_.maxLogLuminance_ - params_.minLogLuminance_, 0.001f);
+
+        histogramBuffer_->BindBuffer(stateCache_);
+        exposureBuffer_->BindBuffer(stateCache_);
+
+        stateCache_->UseProgram(histogramProgram_->GetProgramId());
+        stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, sourceTex);
+        gl::glUniform2uiv(histogramUniformIds_[0], 1, glm::value_ptr(sampleCount));
+        gl::glUniform1f(histogramUniformIds_[1], params_.minLogLuminance_);
+        gl::glUniform1f(histogramUniformIds_[2], 1.0f / logLuminanceRange);
+        gl::glDispatchCompute((sampleCount.x + histogramGroupSize - 1) / histogramGroupSize, (sampleCount.y + histogramGroupSize - 1) / histogramGroupSize, 1);
+        gl::glMemoryBarrier(gl::GL_SHADER_STORAGE_BARRIER_BIT);
+
+        stateCache_->UseProgram(adaptProgram_->GetProgramId());
+        gl::glUniform1ui(adaptUniformIds_[0], sampleCount.x * sampleCount.y);
+        gl::glUniform1f(adaptUniformIds_[1], params_.minLogLuminance_);
+        gl::glUniform1f(adaptUniformIds_[2], logLuminanceRange);
+        gl::glUniform1f(adaptUniformIds_[3], 1.0f - std::exp(-elapsedTime * params_.adaptationRate_));
+        gl::glUniform1f(adaptUniformIds_[4], params_.middleGrey_);
+        gl::glDispatchCompute(1, 1, 1);
+        gl::glMemoryBarrier(gl::GL_SHADER_STORAGE_BARRIER_BIT | gl::GL_BUFFER_UPDATE_BARRIER_BIT);
+
+        StartReadback();
+        lastUpdate_ = std::chrono::steady_clock::now();
+    }
+
+    /**
+     *  Builds the luminance histogram of the source and adapts the exposure by the time since the last update. If it
+     *  is called for multiple viewports per frame the adaptation is split between them.
+     *  @param sourceTex the HDR image to compute the exposure for (may be down sampled).
+     */
+    void AutoExposure::Update(gl::GLuint sourceTex)
+    {
+        // the first update has no previous one and starts fully adapted anyway.
+        auto elapsedTime = lastUpdate_ == std::chrono::steady_clock::time_point{} ? 0.0f
+            : std::chrono::duration<float>(std::chrono::steady_clock::now() - lastUpdate_).count();
+        Update(sourceTex, elapsedTime);
+    }
+
+    /** Binds the exposure buffer for the tone mapping. */
+    void AutoExposure::BindExposureBuffer() const
+    {
+        exposureBuffer_->BindBuffer(stateCache_);
+    }
+
+    /** Downloads the read backs the GPU has finished, oldest first. Never waits for the GPU. */
+    void AutoExposure::CollectReadbacks()
+    {
+        for (std::size_t i = 0; i < NUM_READBACKS; ++i) {
+            auto& readback = readbacks_[(nextReadback_ + i) % NUM_READBACKS];
+            if (!readback.fence_) continue;
+
+            auto status = gl::glClientWaitSync(readback.fence_, gl::GL_NONE_BIT, 0);
+            if (status != gl::GL_ALREADY_SIGNALED && status != gl::GL_CONDITION_SATISFIED) break;
+
+            readback.buffer_.DownloadData(readbackValues_);
+            gl::glDeleteSync(readback.fence_);
+            readback.fence_ = nullptr;
+
+            if (log_) LOG(DBUG) << "Auto exposure: average luminance " << readbackValues_[0] << ", adapted luminance "
+                << readbackValues_[1] << ", exposure " << readbackValues_[2] << ".";
+        }
+    }
+
+    /** Copies the exposure to the next free read back buffer. If all are in flight this frame is skipped. */
+    void AutoExposure::StartReadback()
+    {
+        auto& readback = readbacks_[nextReadback_];
+        if (readback.fence_) return;
+
+        gl::glCopyNamedBufferSubData(exposureBuffer_->GetBuffer()->GetBuffer(), readback.buffer_.GetBuffer(), 0, 0, sizeof(readbackValues_));
+        readback.fence_ = gl::glFenceSync(gl::GL_SYNC_GPU_COMMANDS_COMPLETE, gl::GL_NONE_BIT);
+        nextReadback_ = (nextReadback_ + 1) % NUM_READBACKS;
+    }
+}
@@ -0,0 +1,136 @@
+/**
+ * @file   AutoExposure.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the automatic exposure using a luminance histogram.
+ */
+
+#pragma once
+
+#include "enh/gfx/gl/GLBuffer.h"
+#include <array>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <glbinding/gl/gl.h>
+#include <cereal/cereal.hpp>
+#include <cereal/access.hpp>
+
+namespace viscom::enh {
+
+    class ApplicationNodeBase;
+    class GLProgram;
+    class GLStateCache;
+    class ShaderBufferObject;
+
+    struct AutoExposureParams
+    {
+        /** The minimum log2 luminance of the histogram. */
+        float minLogLuminance_;
+        /** The maximum log2 luminance of the histogram. */
+        float maxLogLuminance_;
+        /** The adaptation rate, the adapted luminance approaches the average by 1 - e^(-rate * time). */
+        float adaptationRate_;
+        /** The luminance the adapted luminance is mapped to. */
+        float middleGrey_;
+
+        template<class Archive> void serialize(Archive& ar, const std::uint32_t) {
+            ar(cereal::make_nvp("minLogLuminance", minLogLuminance_),
+                cereal::make_nvp("maxLogLuminance", maxLogLuminance_),
+                cereal::make_nvp("adaptationRate", adaptationRate_),
+                cereal::make_nvp("middleGrey", middleGrey_));
+        }
+    };
+
+    /**
+     * @brief  Computes the exposure from a luminance histogram of the rendered image.
+     *
+     *  The histogram is built on the GPU over a coarse grid of the source (use a down sampled source like the half
+     *  resolution HDR image if available) and the adapted exposure stays on the GPU in a shader storage buffer that is
+     *  read by the tone mapping. The results are copied to read back buffers guarded by fences and are only downloaded
+     *  once the GPU finished them, so GetAverageLuminance() and GetExposure() lag a few frames behind and never stall.
+     *  On a cluster each node only sees its part of the image, so the exposure may differ between nodes. The exposure
+     *  is applied by a FilmicTMOperator it is set on, PostProcessingGraph::AddTonemapping() also updates it each frame.
+     */
+    class AutoExposure
+    {
+    public:
+        explicit AutoExposure(ApplicationNodeBase* app);
+        AutoExposure(const AutoExposure&) = delete;
+        AutoExposure& operator=(const AutoExposure&) = delete;
+        ~AutoExposure();
+
+        void RenderParameterSliders();
+        void Update(gl::GLuint sourceTex, float elapsedTime);
+        void Update(gl::GLuint sourceTex);
+        void BindExposureBuffer() const;
+
+        /** Returns the last average luminance read back. */
+        float GetAverageLuminance() const { return readbackValues_[0]; }
+        /** Returns the last adapted luminance read back. */
+        float GetAdaptedLuminance() const { return readbackValues_[1]; }
+        /** Returns the last exposure read back. */
+        float GetExposure() const { return readbackValues_[2]; }
+        void SetLogging(bool log) { log_ = log; }
+
+        template<class Archive> void SaveParameters(Archive& ar, const std::uint32_t) const {
+            ar(cereal::make_nvp("params", params_));
+        }
+
+        template<class Archive> void LoadParameters(Archive& ar, const std::uint32_t) {
+            ar(cereal::make_nvp("params", params_));
+        }
+
+    private:
+        void CollectReadbacks();
+        void StartReadback();
+
+        /** The number of read back buffers in flight. */
+        static constexpr std::size_t NUM_READBACKS = 3;
+        /** The maximum number of samples of the histogram grid in each dimension. */
+        static constexpr unsigned int MAX_SAMPLES = 512;
+
+        /** A buffer the exposure is copied to for reading back. */
+        struct Readback
+        {
+            Readback() : buffer_{ gl::GL_STREAM_READ } {}
+
+            /** Holds the buffer. */
+            GLBuffer buffer_;
+            /** Holds the fence signaled when the copy finished, nullptr if no copy is pending. */
+            gl::GLsync fence_ = nullptr;
+        };
+
+        /** Holds the OpenGL state cache. */
+        GLStateCache* stateCache_;
+        /** Holds the parameters. */
+        AutoExposureParams params_;
+
+        /** Holds the histogram program. */
+        std::unique_ptr<GLProgram> histogramProgram_;
+        /** Holds the histogram program uniform ids. */
+        std::vector<gl::GLint> histogramUniformIds_;
+        /** Holds the adaptation program. */
+        std::unique_ptr<GLProgram> adaptProgram_;
+        /** Holds the adaptation program uniform ids. */
+        std::vector<gl::GLint> adaptUniformIds_;
+        /** Holds the luminance histogram. */
+        std::unique_ptr<ShaderBufferObject> histogramBuffer_;
+        /** Holds the average and adapted luminance and the exposure. */
+        std::unique_ptr<ShaderBufferObject> exposureBuffer_;
+
+        /** Holds the read back buffers. */
+        std::array<Readback, NUM_READBACKS> readbacks_;
+        /** Holds the next read back buffer to use. */
+        std::size_t nextReadback_ = 0;
+        /** Holds the last values read back (average luminance, adapted luminance, exposure). */
+        std::array<float, 3> readbackValues_ = { { 0.0f, 0.0f, 1.0f } };
+        /** Holds whether read back values are logged. */
+        bool log_ = false;
+        /** Holds the time of the last update, used if no elapsed time is given. */
+        std::chrono::steady_clock::time_point lastUpdate_;
+    };
+}
+
+CEREAL_CLASS_VERSION(viscom::enh::AutoExposureParams, 1)
@@ -7,32 +7,72 @@
  */
 
 #include "BloomEffect.h"
+#include "FilmicTMOperator.h"
 #include "core/gfx/FrameBuffer.h"
 #include "enh/ApplicationNodeBase.h"
+#include "enh/core/profiler.h"
 #include "enh/gfx/gl/GLTexture.h"
+#include "enh/gfx/gl/GLUniformBuffer.h"
+#include "enh/gfx/gl/ShaderBufferBindingPoints.h"
+#include <algorithm>
+#include <glm/common.hpp>
 #include <imgui.h>
 
 namespace viscom::enh {
 
     namespace bloom {
+        /**
+         *  Render targets of the compute pipeline. Level 0 of the mip chains has half, level 1 fourth resolution.
+         *  After the blurs blurTex_ holds the half and fourth resolution blurs and glareTex_ level 1 the second
+         *  fourth resolution blur.
+         */
+        struct ComputeTargets {
+            std::unique_ptr<GLTexture> glareTex_;
+            std::unique_ptr<GLTexture> blurTempTex_;
+            std::unique_ptr<GLTexture> blurTex_;
+            /** Holds the sizes of the mip levels. */
+            std::array<glm::uvec2, 2> levelSizes_;
+            /** Holds views of the blurred levels for the combine pass. */
+            std::array<std::unique_ptr<GLTexture>, 3> combineViews_;
+            /** Holds the frame of the render target pool the targets were last used in. */
+            std::size_t lastUsedFrame_ = 0;
+        };
+
+        /** The pass parameters, the frame buffers are acquired from the render target pool for the current frame. */
         struct BloomPassParams {
-            GLuint colorTex_;
-            const FrameBuffer* halfResRT_;
-            const FrameBuffer* fourthResRT_;
+            GLuint colorTex_ = 0;
+            /** Holds the half resolution targets (0: glare half, blur pong, 1: blur ping). */
+            const FrameBuffer* halfResRT_ = nullptr;
+            /** Holds the fourth resolution targets (0: glare fourth, blur pong, 1: blur 2 pong, 2: blur ping). */
+            const FrameBuffer* fourthResRT_ = nullptr;
+            const ComputeTargets* computeTargets_ = nullptr;
+            /** Holds the targets of each dual filter level (0: down sampled, 1: up sampled). */
+            std::vector<const FrameBuffer*> dualFilterRTs_;
         };
+
+        /** The standard deviation of the blur in texels for a bloom width of one. */
+        constexpr float BLUR_SIGMA = 1.0f;
     }
 
     BloomEffect::BloomEffect(ApplicationNodeBase* app) :
         app_{ app },
+        stateCache_{ app->GetGLStateCache() },
         glareDetectQuad_("tm/glareDetect.frag", app),
-        glareUniformIds_(glareDetectQuad_.GetGPUProgram()->GetUniformLocations({ "sourceTex" })),
+        glareUniformIds_(glareDetectQuad_.GetProgram()->GetUniformLocations({ "sourceTex" })),
         downsampleQuad_("tm/downsampleBloom.frag", app),
-        downsampleUniformIds_(downsampleQuad_.GetGPUProgram()->GetUniformLocations({ "sourceTex" })),
-        blurQuads_{ FullscreenQuad{ "tm/blurBloomX.frag", "tm/blurBloom.frag", std::vector<std::string>{ "HORIZONTAL" }, app },
-            FullscreenQuad{ "tm/blurBloomY.frag", "tm/blurBloom.frag", std::vector<std::string>{ "VERTICAL" }, app } },
-        blurUniformIds_{ blurQuads_[0].GetGPUProgram()->GetUniformLocations({ "sourceTex", "bloomWidth" }), blurQuads_[1].GetGPUProgram()->GetUniformLocations({ "sourceTex", "bloomWidth" }) },
+        downsampleUniformIds_(downsampleQuad_.GetProgram()->GetUniformLocations({ "sourceTex" })),
+        blurKernelUBO_{ std::make_unique<GLUniformBuffer>("blurKernelBuffer", sizeof(glm::vec4) * SeparableKernel::MAX_TAPS, app->GetUBOBindingPoints()) },
         combineQuad_("tm/combineBloom.frag", app),
-        combineUniformIds_(combineQuad_.GetGPUProgram()->GetUniformLocations({ "sourceTex", "blurTex", "bloomIntensity" }))
+        combineUniformIds_(combineQuad_.GetProgram()->GetUniformLocations({ "sourceTex", "blurTex", "bloomIntensity" })),
+        dualFilterCombineQuad_("tm/combineBloom.frag", std::vector<std::string>{ "DUAL_FILTER" }, app),
+        dualFilterCombineUniformIds_(dualFilterCombineQuad_.GetProgram()->GetUniformLocations({ "sourceTex", "blurTex", "bloomIntensity" })),
+        dualFilterDownsampleQuads_{ ScreenQuad{ "tm/dualFilterDownsample.frag", std::vector<std::string>{ "GLARE" }, app },
+            ScreenQuad{ "tm/dualFilterDownsample.frag", app } },
+        dualFilterDownsampleUniformIds_{ dualFilterDownsampleQuads_[0].GetProgram()->GetUniformLocations({ "sourceTex", "bloomWidth" }),
+            dualFilterDownsampleQuads_[1].GetProgram()->GetUniformLocations({ "sourceTex", "bloomWidth" }) },
+        dualFilterUpsampleQuad_("tm/dualFilterUpsample.frag", app),
+        dualFilterUpsampleUniformIds_(dualFilterUpsampleQuad_.GetProgram()->GetUniformLocations({ "sourceTex", "addTex", "bloomWidth" })),
+        glareDownsampleProgram_(std::make_unique<GLProgram>(std::vector<std::string>{ "tm/glareDownsample.comp" }, app))
     {
         params_.bloomWidth_ = 1.0f;
         params_.bloomIntensity_ = 0.4f;
@@ -40,7 +80,11 @@ namespace viscom::enh {
         Resize();
     }
 
-    BloomEffect::~BloomEffect() = default;
+    BloomEffect::~BloomEffect()
+    {
+        // the compute targets, programs and uniform buffers are deleted with the effect.
+        stateCache_->Invalidate();
+    }
 
     void BloomEffect::RenderParameterSliders()
     {
@@ -48,31 +92,95 @@ namespace viscom::enh {
         {
             ImGui::SliderFloat("Bloom Width", &params_.bloomWidth_, 0.2f, 1.8f);
             ImGui::InputFloat("Bloom Intensity", &params_.bloomIntensity_, 0.1f);
+            auto pipeline = static_cast<int>(pipeline_);
+            if (ImGui::Combo("Pipeline", &pipeline, "Fragment\0Compute\0Dual Filter\0")) pipeline_ = static_cast<BloomPipeline>(pipeline);
+            if (pipeline_ == BloomPipeline::DUAL_FILTER) ImGui::SliderInt("Dual Filter Levels", &params_.dualFilterLevels_, 1, MAX_DUAL_FILTER_LEVELS);
+            auto precision = static_cast<int>(precision_);
+            if (ImGui::Combo("Precision", &precision, "Full (RGBA32F)\0Reduced (R11G11B10F)\0")) SetPrecision(static_cast<RenderTargetPrecision>(precision));
+            ImGui::Text("GPU Time (Fragment): %.3f ms", GetGPUTime(BloomPipeline::FRAGMENT).count());
+            ImGui::Text("GPU Time (Compute): %.3f ms", GetGPUTime(BloomPipeline::COMPUTE).count());
+            ImGui::Text("GPU Time (Dual Filter): %.3f ms", GetGPUTime(BloomPipeline::DUAL_FILTER).count());
             ImGui::TreePop();
         }
     }
 
     void BloomEffect::ApplyEffect(GLuint sourceTex, const FrameBuffer* targetFBO, std::size_t drawBufferIndex)
     {
+        ENH_PROFILE_CPU("Bloom");
+        ENH_PROFILE_GPU("Bloom");
+
+        auto& timer = timers_[static_cast<std::size_t>(pipeline_)];
+        timer.Begin();
         bloom::BloomPassParams passParams;
-        ApplyEffectInternal(passParams, sourceTex);
+        ApplyEffectInternal(passParams, sourceTex, glm::uvec2(targetFBO->GetWidth(), targetFBO->GetHeight()));
 
         targetFBO->DrawToFBO(std::vector<std::size_t>{drawBufferIndex}, [this, &passParams]() { CombinePass(passParams); });
+        ReleaseTargets(passParams);
+        timer.End();
     }
 
     void BloomEffect::ApplyEffect(GLuint sourceTex, const FrameBuffer* targetFBO)
     {
+        ENH_PROFILE_CPU("Bloom");
+        ENH_PROFILE_GPU("Bloom");
+
+        auto& timer = timers_[static_cast<std::size_t>(pipeline_)];
+        timer.Begin();
         bloom::BloomPassParams passParams;
-        ApplyEffectInternal(passParams, sourceTex);
+        ApplyEffectInternal(passParams, sourceTex, glm::uvec2(targetFBO->GetWidth(), targetFBO->GetHeight()));
 
         targetFBO->DrawToFBO([this, &passParams]() { CombinePass(passParams); });
+        ReleaseTargets(passParams);
+        timer.End();
     }
 
-    void BloomEffect::ApplyEffectInternal(bloom::BloomPassParams& passParams, GLuint sourceTex)
+    /**
+     *  Runs the passes before combining, only the targets of the selected pipeline are acquired.
+     *  @param size the size of the target the bloom is combined into.
+     */
+    void BloomEffect::ApplyEffectInternal(bloom::BloomPassParams& passParams, GLuint sourceTex, const glm::uvec2& size)
     {
+        stateCache_->InvalidateExternalState();
+
         passParams.colorTex_ = sourceTex;
-        passParams.halfResRT_ = app_->SelectOffscreenBuffer(glaresHalfRTs_);
-        passParams.fourthResRT_ = app_->SelectOffscreenBuffer(glaresFourthRTs_);
+        auto pool = app_->GetRenderTargetPool();
+        auto format = GetTargetFormat();
+
+        if (pipeline_ != BloomPipeline::DUAL_FILTER) UpdateBlurKernel();
+
+        if (pipeline_ == BloomPipeline::COMPUTE) {
+            passParams.computeTargets_ = GetComputeTargets(glm::max(size / 2u, glm::uvec2(1)));
+            const auto& targets = *passParams.computeTargets_;
+            ComputeGlareDownsamplePass(passParams);
+
+            // blur half
+            ComputeBlurPass(passParams, *targets.glareTex_, *targets.blurTempTex_, 0, 0);
+            ComputeBlurPass(passParams, *targets.blurTempTex_, *targets.blurTex_, 0, 1);
+
+            // blur fourth
+            ComputeBlurPass(passParams, *targets.glareTex_, *targets.blurTempTex_, 1, 0);
+            ComputeBlurPass(passParams, *targets.blurTempTex_, *targets.blurTex_, 1, 1);
+
+            ComputeBlurPass(passParams, *targets.blurTex_, *targets.blurTempTex_, 1, 0);
+            ComputeBlurPass(passParams, *targets.blurTempTex_, *targets.glareTex_, 1, 1);
+
+            gl::glMemoryBarrier(gl::GL_TEXTURE_FETCH_BARRIER_BIT);
+            return;
+        }
+
+        if (pipeline_ == BloomPipeline::DUAL_FILTER) {
+            // parameters may have been loaded with a different number of levels, level i has 1 / 2^(i+1) of the size.
+            auto levels = static_cast<std::size_t>(glm::clamp(params_.dualFilterLevels_, 1, MAX_DUAL_FILTER_LEVELS));
+            passParams.dualFilterRTs_.resize(levels);
+            for (std::size_t i = 0; i < levels; ++i) passParams.dualFilterRTs_[i] = pool->Acquire(glm::max(size / (2u << i), glm::uvec2(1)), { format, format });
+
+            for (std::size_t i = 0; i < levels; ++i) DualFilterDownsamplePass(passParams, i);
+            for (std::size_t i = levels - 1; i > 0; --i) DualFilterUpsamplePass(passParams, i - 1);
+            return;
+        }
+
+        passParams.halfResRT_ = pool->Acquire(glm::max(size / 2u, glm::uvec2(1)), { format, format });
+        passParams.fourthResRT_ = pool->Acquire(glm::max(size / 4u, glm::uvec2(1)), { format, format, format });
 
         GlareDetectPass(passParams);
         DownsamplePass(passParams);
@@ -91,75 +199,286 @@ namespace viscom::enh {
 
     void BloomEffect::GlareDetectPass(const bloom::BloomPassParams& passParams)
     {
+        ENH_PROFILE_GPU("Bloom/GlareDetect");
+
         passParams.halfResRT_->DrawToFBO(glarePassDrawBuffers_, [this, &passParams] {
-            gl::glUseProgram(glareDetectQuad_.GetGPUProgram()->getProgramId());
+            stateCache_->UseProgram(glareDetectQuad_.GetProgram()->GetProgramId());
             gl::glUniform1i(glareUniformIds_[0], 0);
-            gl::glActiveTexture(gl::GL_TEXTURE0);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.colorTex_);
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.colorTex_);
             glareDetectQuad_.Draw();
         });
     }
 
     void BloomEffect::DownsamplePass(const bloom::BloomPassParams& passParams)
     {
+        ENH_PROFILE_GPU("Bloom/Downsample");
+
         passParams.fourthResRT_->DrawToFBO(dsPassDrawBuffers_, [this, &passParams] {
-            gl::glUseProgram(downsampleQuad_.GetGPUProgram()->getProgramId());
+            stateCache_->UseProgram(downsampleQuad_.GetProgram()->GetProgramId());
             gl::glUniform1i(downsampleUniformIds_[0], 0);
-            gl::glActiveTexture(gl::GL_TEXTURE0);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.halfResRT_->GetTextures()[0]);
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.halfResRT_->GetTextures()[0]);
             downsampleQuad_.Draw();
         });
     }
 
     void BloomEffect::BlurPass(const FrameBuffer* fbo, const std::array<std::vector<std::size_t>, 2>& drawBuffers, std::size_t pass, std::size_t sourceTex)
     {
-       fbo->DrawToFBO(drawBuffers[pass], [this, fbo, pass, sourceTex] {
-            gl::glUseProgram(blurQuads_[pass].GetGPUProgram()->getProgramId());
+        ENH_PROFILE_GPU("Bloom/Blur");
 
-            gl::glActiveTexture(gl::GL_TEXTURE0);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, fbo->GetTextures()[sourceTex]);
+        // may create the quad, so do this before drawing.
+        const auto& quad = GetBlurQuad(pass);
+        const auto& uniformIds = blurUniformIds_[blurNumTaps_ - 1][pass];
+        fbo->DrawToFBO(drawBuffers[pass], [this, fbo, &quad, &uniformIds, sourceTex] {
+            stateCache_->UseProgram(quad.GetProgram()->GetProgramId());
+            blurKernelUBO_->BindBuffer(stateCache_);
 
-            gl::glUniform1i(blurUniformIds_[pass][0], 0);
-            gl::glUniform1f(blurUniformIds_[pass][1], params_.bloomWidth_);
-            blurQuads_[pass].Draw();
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, fbo->GetTextures()[sourceTex]);
+
+            gl::glUniform1i(uniformIds[0], 0);
+            quad.Draw();
         });
     }
 
+    /**
+     *  Adds the blurred glare to the source. With a tone-mapping set the result is tone-mapped in the same pass, which
+     *  saves writing and reading the full resolution HDR image.
+     */
     void BloomEffect::CombinePass(const bloom::BloomPassParams& passParams)
     {
-        gl::glUseProgram(combineQuad_.GetGPUProgram()->getProgramId());
-        gl::glActiveTexture(gl::GL_TEXTURE0);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.colorTex_);
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 1);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.halfResRT_->GetTextures()[0]);
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 2);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.fourthResRT_->GetTextures()[0]);
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 3);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.fourthResRT_->GetTextures()[1]);
+        ENH_PROFILE_GPU("Bloom/Combine");
+
+        const auto dualFilter = pipeline_ == BloomPipeline::DUAL_FILTER;
+        const ScreenQuad* quad = dualFilter ? &dualFilterCombineQuad_ : &combineQuad_;
+        const std::vector<gl::GLint>* uniformIds = dualFilter ? &dualFilterCombineUniformIds_ : &combineUniformIds_;
+        if (tonemapping_) {
+            // may bake the LUT, so do this before binding anything else.
+            tonemapping_->PrepareTonemapping(4);
+            auto quadIndex = GetTonemapCombineQuad(tonemapping_->GetVariant());
+            quad = tonemapCombineQuads_[quadIndex].get();
+            uniformIds = &tonemapCombineUniformIds_[quadIndex];
+        }
+
+        stateCache_->UseProgram(quad->GetProgram()->GetProgramId());
+        stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.colorTex_);
+        gl::glUniform1i((*uniformIds)[0], 0);
+        if (tonemapping_) gl::glUniform1i((*uniformIds)[3], 4);
+
+        if (dualFilter) {
+            // the up sampled levels add up the down sampled ones, the intensity is normalized by the number of levels.
+            const auto levels = passParams.dualFilterRTs_.size();
+            const auto resultTex = levels == 1 ? 0 : 1;
+            stateCache_->BindTexture(1, gl::GL_TEXTURE_2D, passParams.dualFilterRTs_[0]->GetTextures()[resultTex]);
+
+            gl::glUniform1i((*uniformIds)[1], 1);
+            gl::glUniform1f((*uniformIds)[2], params_.bloomIntensity_ / static_cast<float>(levels));
+
+            quad->Draw();
+            return;
+        }
+
+        if (pipeline_ == BloomPipeline::COMPUTE) {
+            for (unsigned int i = 0; i < 3; ++i) passParams.computeTargets_->combineViews_[i]->ActivateTexture(stateCache_, i + 1);
+        } else {
+            stateCache_->BindTexture(1, gl::GL_TEXTURE_2D, passParams.halfResRT_->GetTextures()[0]);
+            stateCache_->BindTexture(2, gl::GL_TEXTURE_2D, passParams.fourthResRT_->GetTextures()[0]);
+            stateCache_->BindTexture(3, gl::GL_TEXTURE_2D, passParams.fourthResRT_->GetTextures()[1]);
+        }
 
         std::array<int, 3> blurTextureUnitIds{ 1, 2, 3 };
-        gl::glUniform1i(combineUniformIds_[0], 0);
-        gl::glUniform1iv(combineUniformIds_[1], static_cast<GLsizei>(blurTextureUnitIds.size()), blurTextureUnitIds.data());
-        gl::glUniform1f(combineUniformIds_[2], params_.bloomIntensity_);
+        gl::glUniform1iv((*uniformIds)[1], static_cast<GLsizei>(blurTextureUnitIds.size()), blurTextureUnitIds.data());
+        gl::glUniform1f((*uniformIds)[2], params_.bloomIntensity_);
 
-        combineQuad_.Draw();
+        quad->Draw();
     }
 
-    void BloomEffect::Resize()
+    /**
+     *  Returns the index of the quad combining the current pipeline with a tone-mapping variant, the quad is created if
+     *  it was not used before.
+     *  @param tonemapVariant the variant of the tone-mapping (see FilmicTMOperator::GetVariant()).
+     */
+    std::size_t BloomEffect::GetTonemapCombineQuad(std::size_t tonemapVariant)
+    {
+        const auto dualFilter = pipeline_ == BloomPipeline::DUAL_FILTER;
+        const auto quadIndex = (dualFilter ? 4 : 0) + tonemapVariant;
+        if (tonemapCombineQuads_[quadIndex]) return quadIndex;
+
+        auto defines = FilmicTMOperator::GetVariantDefines(tonemapVariant);
+        defines.emplace_back("TONEMAP");
+        if (dualFilter) defines.emplace_back("DUAL_FILTER");
+        tonemapCombineQuads_[quadIndex] = std::make_unique<ScreenQuad>("tm/combineBloom.frag", defines, app_);
+        auto program = tonemapCombineQuads_[quadIndex]->GetProgram();
+        tonemapCombineUniformIds_[quadIndex] = program->GetUniformLocations({ "sourceTex", "blurTex", "bloomIntensity", "lutTex" });
+        tonemapping_->RegisterProgram(program->GetProgramId(), tonemapVariant);
+        // linking may change the program binding.
+        stateCache_->Invalidate();
+        return quadIndex;
+    }
+
+    /**
+     *  Creates the Gaussian kernel of the blur passes, its standard deviation scales with the bloom width.
+     *  @param bloomWidth the bloom width (see BloomParams).
+     */
+    SeparableKernel BloomEffect::CreateBlurKernel(float bloomWidth)
+    {
+        return SeparableKernel::Gaussian(BLUR_SIGMA * bloomWidth);
+    }
+
+    /** Recreates and uploads the blur kernel if the bloom width changed. */
+    void BloomEffect::UpdateBlurKernel()
+    {
+        if (blurKernelWidth_ == params_.bloomWidth_) return;
+
+        auto kernel = CreateBlurKernel(params_.bloomWidth_);
+        blurKernelUBO_->UploadData(0, sizeof(glm::vec4) * SeparableKernel::MAX_TAPS, kernel.GetTaps().data());
+        blurKernelWidth_ = params_.bloomWidth_;
+        blurNumTaps_ = kernel.GetNumTaps();
+    }
+
+    /**
+     *  Returns the blur quad for the number of taps of the current kernel, the quad is created if it was not used before.
+     *  @param pass the blur direction (0 horizontal, 1 vertical).
+     */
+    const ScreenQuad& BloomEffect::GetBlurQuad(std::size_t pass)
+    {
+        auto& quad = blurQuads_[blurNumTaps_ - 1][pass];
+        if (quad) return *quad;
+
+        const auto numTaps = std::to_string(blurNumTaps_);
+        std::vector<std::string> defines{ pass == 0 ? "HORIZONTAL" : "VERTICAL", "NUM_TAPS " + numTaps };
+        quad = std::make_unique<ScreenQuad>("tm/blurBloom.frag", defines, app_);
+        auto program = quad->GetProgram();
+        blurUniformIds_[blurNumTaps_ - 1][pass] = program->GetUniformLocations({ "sourceTex" });
+        app_->GetUBOBindingPoints()->BindBufferBlock(program->GetProgramId(), "blurKernelBuffer");
+        // linking may change the program binding.
+        stateCache_->Invalidate();
+        return *quad;
+    }
+
+    /**
+     *  Returns the blur compute program for the number of taps of the current kernel, the program is created if it was
+     *  not used before.
+     *  @param pass the blur direction (0 horizontal, 1 vertical).
+     */
+    const GLProgram& BloomEffect::GetBlurProgram(std::size_t pass)
+    {
+        auto& program = blurPrograms_[blurNumTaps_ - 1][pass];
+        if (program) return *program;
+
+        const auto numTaps = std::to_string(blurNumTaps_);
+        std::vector<std::string> defines{ pass == 0 ? "HORIZONTAL" : "VERTICAL", "NUM_TAPS " + numTaps };
+        program = std::make_unique<GLProgram>(std::vector<std::string>{ "tm/blurBloom.comp" }, defines, app_);
+        blurComputeUniformIds_[blurNumTaps_ - 1][pass] = program->GetUniformLocations({ "sourceLevel" });
+        app_->GetUBOBindingPoints()->BindBufferBlock(program->GetProgramId(), "blurKernelBuffer");
+        // linking may change the program binding.
+        stateCache_->Invalidate();
+        return *program;
+    }
+
+    /**
+     *  Down samples into a level of the dual filter mip chain. The first level is down sampled from the source and
+     *  detects the glare.
+     */
+    void BloomEffect::DualFilterDownsamplePass(const bloom::BloomPassParams& passParams, std::size_t level)
+    {
+        ENH_PROFILE_GPU("Bloom/DualFilterDownsample");
+
+        const auto& quad = dualFilterDownsampleQuads_[level == 0 ? 0 : 1];
+        const auto& uniformIds = dualFilterDownsampleUniformIds_[level == 0 ? 0 : 1];
+        auto sourceTex = level == 0 ? passParams.colorTex_ : passParams.dualFilterRTs_[level - 1]->GetTextures()[0];
+
+        passParams.dualFilterRTs_[level]->DrawToFBO(std::vector<std::size_t>{ 0 }, [this, &quad, &uniformIds, sourceTex] {
+            stateCache_->UseProgram(quad.GetProgram()->GetProgramId());
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, sourceTex);
+            gl::glUniform1i(uniformIds[0], 0);
+            gl::glUniform1f(uniformIds[1], params_.bloomWidth_);
+            quad.Draw();
+        });
+    }
+
+    /**
+     *  Up samples the next smaller level (the down sampled result for the smallest one) into a level of the dual filter
+     *  mip chain and adds the down sampled result of this level.
+     */
+    void BloomEffect::DualFilterUpsamplePass(const bloom::BloomPassParams& passParams, std::size_t level)
     {
-        FrameBufferDescriptor glareDetectHalfRTDesc{ { 
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGBA32F) }, // 0: glare half, blur pong
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGBA32F) } // 0: glare half, blur ping
-            },{} };
-        glaresHalfRTs_ = app_->CreateOffscreenBuffers(glareDetectHalfRTDesc, 2);
+        ENH_PROFILE_GPU("Bloom/DualFilterUpsample");
+
+        const auto* smallerRT = passParams.dualFilterRTs_[level + 1];
+        auto sourceTex = level + 2 == passParams.dualFilterRTs_.size() ? smallerRT->GetTextures()[0] : smallerRT->GetTextures()[1];
+        const auto* fbo = passParams.dualFilterRTs_[level];
+
+        fbo->DrawToFBO(std::vector<std::size_t>{ 1 }, [this, fbo, sourceTex] {
+            stateCache_->UseProgram(dualFilterUpsampleQuad_.GetProgram()->GetProgramId());
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, sourceTex);
+            stateCache_->BindTexture(1, gl::GL_TEXTURE_2D, fbo->GetTextures()[0]);
+            gl::glUniform1i(dualFilterUpsampleUniformIds_[0], 0);
+            gl::glUniform1i(dualFilterUpsampleUniformIds_[1], 1);
+            gl::glUniform1f(dualFilterUpsampleUniformIds_[2], params_.bloomWidth_);
+            dualFilterUpsampleQuad_.Draw();
+        });
+    }
+
+    void BloomEffect::ComputeGlareDownsamplePass(const bloom::BloomPassParams& passParams)
+    {
+        ENH_PROFILE_GPU("Bloom/ComputeGlareDownsample");
+
+        const auto& targets = *passParams.computeTargets_;
+        stateCache_->UseProgram(glareDownsampleProgram_->GetProgramId());
+        stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.colorTex_);
+        targets.glareTex_->ActivateImage(0, 0, gl::GL_WRITE_ONLY);
+        targets.glareTex_->ActivateImage(1, 1, gl::GL_WRITE_ONLY);
+
+        // see TILE_SIZE in glareDownsample.comp.
+        const unsigned int tileSize = 16;
+        gl::glDispatchCompute((targets.levelSizes_[0].x + tileSize - 1) / tileSize, (targets.levelSizes_[0].y + tileSize - 1) / tileSize, 1);
+        gl::glMemoryBarrier(gl::GL_TEXTURE_FETCH_BARRIER_BIT | gl::GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    /**
+     *  Blurs a mip level of a texture in one direction.
+     *  @param passParams the pass parameters.
+     *  @param source the texture to blur.
+     *  @param target the texture to write the result to.
+     *  @param level the mip level to blur.
+     *  @param pass the blur direction (0 horizontal, 1 vertical).
+     */
+    void BloomEffect::ComputeBlurPass(const bloom::BloomPassParams& passParams, const GLTexture& source, const GLTexture& target, unsigned int level, std::size_t pass)
+    {
+        ENH_PROFILE_GPU("Bloom/ComputeBlur");
+
+        stateCache_->UseProgram(GetBlurProgram(pass).GetProgramId());
+        blurKernelUBO_->BindBuffer(stateCache_);
+        source.ActivateTexture(stateCache_, 0);
+        target.ActivateImage(0, static_cast<gl::GLint>(level), gl::GL_WRITE_ONLY);
+        gl::glUniform1i(blurComputeUniformIds_[blurNumTaps_ - 1][pass][0], static_cast<gl::GLint>(level));
 
-        FrameBufferDescriptor glareDetectFourthRTDesc{ {
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGBA32F) }, // 0: glare fourth, blur pong
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGBA32F) }, // 0: glare fourth, blur 2 pong
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGBA32F) } // 0: glare fourth, blur ping
-            },{} };
-        glaresFourthRTs_ = app_->CreateOffscreenBuffers(glareDetectFourthRTDesc, 4);
+        // see TILE_SIZE in blurBloom.comp, work groups run along the blur direction.
+        const unsigned int tileSize = 128;
+        const auto& size = passParams.computeTargets_->levelSizes_[level];
+        auto lineLength = pass == 0 ? size.x : size.y;
+        auto lineCount = pass == 0 ? size.y : size.x;
+        gl::glDispatchCompute((lineLength + tileSize - 1) / tileSize, lineCount, 1);
+        gl::glMemoryBarrier(gl::GL_TEXTURE_FETCH_BARRIER_BIT | gl::GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    /**
+     *  Sets the precision of the render targets and recreates them.
+     *  All targets only hold positive colors (the alpha channel of the glare targets is always one), so the reduced
+     *  precision uses R11G11B10F which needs a fourth of the memory and bandwidth of RGBA32F.
+     */
+    void BloomEffect::SetPrecision(RenderTargetPrecision precision)
+    {
+        if (precision_ == precision) return;
+        precision_ = precision;
+        Resize();
+    }
 
+    /**
+     *  Frees the render targets of the compute pipeline, they are recreated for the new size on next use.
+     *  The frame buffers of the other pipelines are taken from the render target pool each frame.
+     */
+    void BloomEffect::Resize()
+    {
         glarePassDrawBuffers_ = { 0 };
         blurHalfPassDrawBuffers_[0] = { 1 };
         blurHalfPassDrawBuffers_[1] = { 0 };
@@ -168,6 +487,70 @@ namespace viscom::enh {
         blur1FourthPassDrawBuffers_[1] = { 0 };
         blur2FourthPassDrawBuffers_[0] = { 2 };
         blur2FourthPassDrawBuffers_[1] = { 1 };
+
+        for (const auto& targets : computeTargets_) ForgetComputeTargets(targets);
+        computeTargets_.clear();
+    }
+
+    /** Returns the format of the render targets for the current precision. */
+    gl::GLenum BloomEffect::GetTargetFormat() const
+    {
+        return precision_ == RenderTargetPrecision::FULL ? gl::GL_RGBA32F : gl::GL_R11F_G11F_B10F;
     }
 
+    /** Returns the acquired targets to the render target pool. */
+    void BloomEffect::ReleaseTargets(const bloom::BloomPassParams& passParams)
+    {
+        auto pool = app_->GetRenderTargetPool();
+        if (passParams.halfResRT_) pool->Release(passParams.halfResRT_);
+        if (passParams.fourthResRT_) pool->Release(passParams.fourthResRT_);
+        for (auto rt : passParams.dualFilterRTs_) pool->Release(rt);
+    }
+
+    /**
+     *  Returns the render targets of the compute pipeline for a size, they are created on first use. The viewports of a
+     *  node are rendered one after another, so viewports of the same size share them. Targets of sizes not used for
+     *  as many frames as the render target pool keeps its targets are freed.
+     *  @param halfSize the size of the half resolution level.
+     */
+    const bloom::ComputeTargets* BloomEffect::GetComputeTargets(const glm::uvec2& halfSize)
+    {
+        auto frame = app_->GetRenderTargetPool()->GetFrame();
+        auto unused = std::stable_partition(computeTargets_.begin(), computeTargets_.end(), [frame](const bloom::ComputeTargets& t) {
+            return frame - t.lastUsedFrame_ < RenderTargetPool::MAX_UNUSED_FRAMES; });
+        for (auto it = unused; it != computeTargets_.end(); ++it) ForgetComputeTargets(*it);
+        computeTargets_.erase(unused, computeTargets_.end());
+
+        for (auto& targets : computeTargets_) {
+            if (targets.levelSizes_[0] != halfSize) continue;
+            targets.lastUsedFrame_ = frame;
+            return &targets;
+        }
+
+        auto computeTargetDesc = precision_ == RenderTargetPrecision::FULL ? TextureDescriptor{ 16, gl::GL_RGBA32F, gl::GL_RGBA, gl::GL_FLOAT }
+            : TextureDescriptor{ 4, gl::GL_R11F_G11F_B10F, gl::GL_RGB, gl::GL_FLOAT };
+        computeTargets_.emplace_back();
+        auto& targets = computeTargets_.back();
+        targets.levelSizes_ = { { halfSize, glm::max(halfSize / 2u, glm::uvec2(1)) } };
+        targets.lastUsedFrame_ = frame;
+        targets.glareTex_ = std::make_unique<GLTexture>(halfSize.x, halfSize.y, computeTargetDesc, nullptr, 2);
+        targets.blurTempTex_ = std::make_unique<GLTexture>(halfSize.x, halfSize.y, computeTargetDesc, nullptr, 2);
+        targets.blurTex_ = std::make_unique<GLTexture>(halfSize.x, halfSize.y, computeTargetDesc, nullptr, 2);
+        targets.combineViews_[0] = targets.blurTex_->CreateMipLevelView(0);
+        targets.combineViews_[1] = targets.blurTex_->CreateMipLevelView(1);
+        targets.combineViews_[2] = targets.glareTex_->CreateMipLevelView(1);
+
+        // creating the textures changes the texture bindings.
+        stateCache_->Invalidate();
+        return &targets;
+    }
+
+    /** Removes the textures of the compute pipeline from the state cache before they are deleted. */
+    void BloomEffect::ForgetComputeTargets(const bloom::ComputeTargets& targets) const
+    {
+        targets.glareTex_->ForgetBindings(stateCache_);
+        targets.blurTempTex_->ForgetBindings(stateCache_);
+        targets.blurTex_->ForgetBindings(stateCache_);
+        for (const auto& view : targets.combineViews_) view->ForgetBindings(stateCache_);
+    }
 }
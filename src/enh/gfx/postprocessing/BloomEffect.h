@@ -8,7 +8,11 @@
 
 #pragma once
 
-#include "core/gfx/FullscreenQuad.h"
+#include "enh/gfx/gl/ScreenQuad.h"
+#include "enh/gfx/gl/GLTimerQuery.h"
+#include "enh/gfx/postprocessing/RenderTargetPrecision.h"
+#include "enh/gfx/postprocessing/SeparableKernel.h"
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
@@ -18,28 +22,43 @@
 #include <cereal/access.hpp>
 
 namespace viscom {
-    class GPUProgram;
     class FrameBuffer;
 }
 
 namespace viscom::enh {
 
     class ApplicationNodeBase;
+    class FilmicTMOperator;
+    class GLStateCache;
     class GLTexture;
-
+    class GLUniformBuffer;
 
     namespace bloom {
         struct BloomPassParams;
+        struct ComputeTargets;
     }
 
+    /** The implementations of the bloom passes. */
+    enum class BloomPipeline
+    {
+        /** Full screen fragment passes into frame buffers. */
+        FRAGMENT,
+        /** Compute passes with fused glare detection and down sampling and shared memory blurs. */
+        COMPUTE,
+        /** Dual filter down and up sampling through a mip chain with a configurable number of levels. */
+        DUAL_FILTER
+    };
+
     struct BloomParams
     {
         float bloomWidth_;
         float bloomIntensity_;
+        int dualFilterLevels_ = 5;
 
-        template<class Archive> void serialize(Archive& ar, const std::uint32_t) {
+        template<class Archive> void serialize(Archive& ar, const std::uint32_t version) {
             ar(cereal::make_nvp("bloomWidth", bloomWidth_),
                 cereal::make_nvp("bloomIntensity", bloomIntensity_));
+            if (version >= 2) ar(cereal::make_nvp("dualFilterLevels", dualFilterLevels_));
         }
     };
 
@@ -53,6 +72,16 @@ namespace viscom::enh {
         void ApplyEffect(GLuint sourceTex, const FrameBuffer* targetFBO, std::size_t drawBufferIndex);
         void ApplyEffect(GLuint sourceTex, const FrameBuffer* targetFBO);
         void Resize();
+        void SetPipeline(BloomPipeline pipeline) { pipeline_ = pipeline; }
+        BloomPipeline GetPipeline() const { return pipeline_; }
+        void SetPrecision(RenderTargetPrecision precision);
+        RenderTargetPrecision GetPrecision() const { return precision_; }
+        /** Sets the tone-mapping applied in the combine pass (nullptr to output the HDR result). */
+        void SetTonemapping(FilmicTMOperator* tonemapping) { tonemapping_ = tonemapping; }
+        /** Returns the last GPU time measured for a pipeline (including the combine pass). */
+        std::chrono::duration<double, std::milli> GetGPUTime(BloomPipeline pipeline) const { return timers_[static_cast<std::size_t>(pipeline)].GetLastTime(); }
+
+        static SeparableKernel CreateBlurKernel(float bloomWidth);
 
         template<class Archive> void SaveParameters(Archive& ar, const std::uint32_t) const {
             ar(cereal::make_nvp("params", params_));
@@ -63,39 +92,90 @@ namespace viscom::enh {
         }
 
     private:
-        void ApplyEffectInternal(bloom::BloomPassParams& passParams, GLuint sourceTex);
+        void ApplyEffectInternal(bloom::BloomPassParams& passParams, GLuint sourceTex, const glm::uvec2& size);
+        void ReleaseTargets(const bloom::BloomPassParams& passParams);
+        const bloom::ComputeTargets* GetComputeTargets(const glm::uvec2& halfSize);
+        void ForgetComputeTargets(const bloom::ComputeTargets& targets) const;
+        gl::GLenum GetTargetFormat() const;
         void GlareDetectPass(const bloom::BloomPassParams& passParams);
         void DownsamplePass(const bloom::BloomPassParams& passParams);
         void BlurPass(const FrameBuffer* fbo, const std::array<std::vector<std::size_t>, 2>& drawBuffers, std::size_t pass, std::size_t sourceTex);
         void CombinePass(const bloom::BloomPassParams& passParams);
+        void ComputeGlareDownsamplePass(const bloom::BloomPassParams& passParams);
+        void ComputeBlurPass(const bloom::BloomPassParams& passParams, const GLTexture& source, const GLTexture& target, unsigned int level, std::size_t pass);
+        void DualFilterDownsamplePass(const bloom::BloomPassParams& passParams, std::size_t level);
+        void DualFilterUpsamplePass(const bloom::BloomPassParams& passParams, std::size_t level);
+        std::size_t GetTonemapCombineQuad(std::size_t tonemapVariant);
+        void UpdateBlurKernel();
+        const ScreenQuad& GetBlurQuad(std::size_t pass);
+        const GLProgram& GetBlurProgram(std::size_t pass);
+
+        /** The maximum number of levels of the dual filter mip chain. */
+        static constexpr int MAX_DUAL_FILTER_LEVELS = 8;
 
         /** Holds the base application object. */
         ApplicationNodeBase* app_;
-
-        /** Holds the frame buffers for glare detection. */
-        std::vector<FrameBuffer> glaresHalfRTs_;
-        /** Holds the frame buffers for glare detection. */
-        std::vector<FrameBuffer> glaresFourthRTs_;
+        /** Holds the OpenGL state cache. */
+        GLStateCache* stateCache_;
 
         /** Holds the bloom parameters. */
         BloomParams params_;
+        /** Holds the pipeline used for the bloom passes. */
+        BloomPipeline pipeline_ = BloomPipeline::FRAGMENT;
+        /** Holds the precision of the render targets. */
+        RenderTargetPrecision precision_ = RenderTargetPrecision::FULL;
+        /** Holds the GPU timers for each pipeline. */
+        std::array<GLTimerQuery, 3> timers_;
 
         /** Holds the full screen quad used for glare detection. */
-        FullscreenQuad glareDetectQuad_;
+        ScreenQuad glareDetectQuad_;
         /** Holds the glare program uniform ids. */
         std::vector<gl::GLint> glareUniformIds_;
         /** Holds the full screen quad used for down sampling. */
-        FullscreenQuad downsampleQuad_;
+        ScreenQuad downsampleQuad_;
         /** Holds the down sampling program uniform ids. */
         std::vector<gl::GLint> downsampleUniformIds_;
-        /** Holds the full screen quad used for blurring. */
-        std::array<FullscreenQuad, 2> blurQuads_;
+        /** Holds the uniform buffer with the taps of the blur kernel. */
+        std::unique_ptr<GLUniformBuffer> blurKernelUBO_;
+        /** Holds the bloom width the uploaded blur kernel was created for. */
+        float blurKernelWidth_ = -1.0f;
+        /** Holds the number of taps of the uploaded blur kernel. */
+        std::size_t blurNumTaps_ = 0;
+        /** Holds the full screen quads used for blurring for each number of taps and direction, created on first use. */
+        std::array<std::array<std::unique_ptr<ScreenQuad>, 2>, SeparableKernel::MAX_TAPS> blurQuads_;
         /** Holds the blur program uniform ids. */
-        std::array<std::vector<gl::GLint>, 2> blurUniformIds_;
+        std::array<std::array<std::vector<gl::GLint>, 2>, SeparableKernel::MAX_TAPS> blurUniformIds_;
         /** Holds the full screen quad used for combining. */
-        FullscreenQuad combineQuad_;
+        ScreenQuad combineQuad_;
         /** Holds the combining program uniform ids. */
         std::vector<gl::GLint> combineUniformIds_;
+        /** Holds the full screen quad used for combining the dual filter bloom. */
+        ScreenQuad dualFilterCombineQuad_;
+        /** Holds the dual filter combining program uniform ids. */
+        std::vector<gl::GLint> dualFilterCombineUniformIds_;
+        /** Holds the tone-mapping fused into the combine pass (may be nullptr). */
+        FilmicTMOperator* tonemapping_ = nullptr;
+        /** Holds the full screen quads combining and tone-mapping (+4 for dual filter, + tone-mapping variant), created on first use. */
+        std::array<std::unique_ptr<ScreenQuad>, 8> tonemapCombineQuads_;
+        /** Holds the combining and tone-mapping program uniform ids. */
+        std::array<std::vector<gl::GLint>, 8> tonemapCombineUniformIds_;
+        /** Holds the full screen quads used for dual filter down sampling (with and without glare detection). */
+        std::array<ScreenQuad, 2> dualFilterDownsampleQuads_;
+        /** Holds the dual filter down sampling program uniform ids. */
+        std::array<std::vector<gl::GLint>, 2> dualFilterDownsampleUniformIds_;
+        /** Holds the full screen quad used for dual filter up sampling. */
+        ScreenQuad dualFilterUpsampleQuad_;
+        /** Holds the dual filter up sampling program uniform ids. */
+        std::vector<gl::GLint> dualFilterUpsampleUniformIds_;
+
+        /** Holds the compute program for glare detection and down sampling. */
+        std::unique_ptr<GLProgram> glareDownsampleProgram_;
+        /** Holds the compute programs for blurring for each number of taps and direction, created on first use. */
+        std::array<std::array<std::unique_ptr<GLProgram>, 2>, SeparableKernel::MAX_TAPS> blurPrograms_;
+        /** Holds the blur compute program uniform ids. */
+        std::array<std::array<std::vector<gl::GLint>, 2>, SeparableKernel::MAX_TAPS> blurComputeUniformIds_;
+        /** Holds the render targets of the compute pipeline for each viewport size used. */
+        std::vector<bloom::ComputeTargets> computeTargets_;
 
         /** The draw buffers used in the glare pass. */
         std::vector<std::size_t> glarePassDrawBuffers_;
@@ -110,4 +190,4 @@ namespace viscom::enh {
     };
 }
 
-CEREAL_CLASS_VERSION(viscom::enh::BloomParams, 1)
+CEREAL_CLASS_VERSION(viscom::enh::BloomParams, 2)
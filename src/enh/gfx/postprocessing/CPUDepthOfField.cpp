@@ -0,0 +1,378 @@
+/**
+ * @file   CPUDepthOfField.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the CPU version of the depth of field effect.
+ */
+
+#include "CPUDepthOfField.h"
+#include "DepthOfField.h"
+#include "enh/core/profiler.h"
+
+namespace viscom::enh {
+
+    namespace {
+        /** The radius of the tile min/max and near CoC blur passes. */
+        constexpr int TILE_RADIUS = 6;
+
+        /** Returns the texel fetched for a target texel when the source has a different size (ivec2(texCoord * textureSize)). */
+        int GetFetchCoordinate(unsigned int targetCoord, unsigned int targetSize, unsigned int sourceSize)
+        {
+            return static_cast<int>((static_cast<float>(targetCoord) + 0.5f) / static_cast<float>(targetSize) * static_cast<float>(sourceSize));
+        }
+
+        float Saturate(float value) { return std::clamp(value, 0.0f, 1.0f); }
+
+        /** The positions and weight of the two linear samples of a cubic B-spline along one axis (see bicubic_sampling.glsl). */
+        struct CubicSamples
+        {
+            explicit CubicSamples(float coord)
+            {
+                auto coordHG = coord - 0.5f;
+                auto x = coordHG - std::floor(coordHG);
+                auto x2 = x * x;
+                auto x3 = x2 * x;
+                std::array<float, 4> w{ (1.0f - 3.0f * x + 3.0f * x2 - x3) / 6.0f, (3.0f * x3 - 6.0f * x2 + 4.0f) / 6.0f,
+                    (1.0f + 3.0f * x + 3.0f * x2 - 3.0f * x3) / 6.0f, x3 / 6.0f };
+                weight_ = w[0] + w[1];
+                first_ = coord - (1.0f - (w[1] / weight_) + x);
+                second_ = coord + (1.0f + (w[3] / (w[2] + w[3])) - x);
+            }
+
+            /** Holds the position of the first (lower) sample. */
+            float first_;
+            /** Holds the position of the second (upper) sample. */
+            float second_;
+            /** Holds the weight of the first sample. */
+            float weight_;
+        };
+
+        /** CPU version of sampleBiCubic(), the coordinates are in pixels. */
+        float4 SampleBiCubic(const CPUImage& image, float x, float y)
+        {
+            const CubicSamples hgX{ x }, hgY{ y };
+            auto left = Mix(image.SampleLinear(hgX.first_, hgY.second_), image.SampleLinear(hgX.first_, hgY.first_), hgY.weight_);
+            auto right = Mix(image.SampleLinear(hgX.second_, hgY.second_), image.SampleLinear(hgX.second_, hgY.first_), hgY.weight_);
+            return Mix(right, left, hgX.weight_);
+        }
+
+        /** CPU version of sampleBiCubicBilateral(), the coordinates are in pixels. */
+        float4 SampleBiCubicBilateral(const CPUImage& image, float x, float y, const float4& bilateralWeights)
+        {
+            const CubicSamples hgX{ x }, hgY{ y };
+            auto weights = float4(hgY.weight_ * hgX.weight_, hgY.weight_ * (1.0f - hgX.weight_),
+                (1.0f - hgY.weight_) * hgX.weight_, (1.0f - hgY.weight_) * (1.0f - hgX.weight_)) / (bilateralWeights + float4(0.001f));
+
+            auto result = image.SampleLinear(hgX.first_, hgY.first_) * weights[0];
+            result += image.SampleLinear(hgX.second_, hgY.first_) * weights[1];
+            result += image.SampleLinear(hgX.first_, hgY.second_) * weights[2];
+            result += image.SampleLinear(hgX.second_, hgY.second_) * weights[3];
+            return result * (1.0f / weights.HorizontalSum());
+        }
+
+        /** Returns the number of bokeh taps used for a CoC (see dofSampling.glsl). */
+        std::size_t BokehTapCount(float coc)
+        {
+            if (coc < 1.0f / 3.0f) return 8;
+            if (coc < 2.0f / 3.0f) return 24;
+            return 48;
+        }
+
+        /** Returns the first of the bokeh taps in the tap sets (see dofSampling.glsl). */
+        std::size_t BokehFirstTap(std::size_t tapCount)
+        {
+            if (tapCount == 8) return 0;
+            if (tapCount == 24) return 8;
+            return 32;
+        }
+    }
+
+    /**
+     *  Runs all stages like DepthOfField::ApplyEffect().
+     *  @param params the lens parameters.
+     *  @param projection the projection matrix of the camera.
+     *  @param color the color image, the result has the same size.
+     *  @param depth the depth buffer values in [0, 1] in the first channel.
+     */
+    CPUImage CPUDepthOfField::ApplyEffect(const DOFParams& params, const glm::mat4& projection, const CPUImage& color, const CPUImage& depth) const
+    {
+        ENH_PROFILE_CPU("CPUDepthOfField");
+        auto coc = CoC(depth, DepthOfField::CalculateCoCParams(params, projection, color.GetHeight()));
+        auto lowRes = Downsample(color, coc);
+        const auto& cocHalf = lowRes[2];
+
+        auto cocTile = TileMinMax(TileMinMax(cocHalf, true), false);
+        auto cocNearBlur = NearCoCBlur(NearCoCBlur(cocTile, true), false);
+
+        auto fields = Gather(cocHalf, cocNearBlur, lowRes[0], lowRes[1], DepthOfField::CalculateBokehTaps(params));
+        auto filledFields = Fill(cocHalf, cocNearBlur, fields[0], fields[1]);
+        return Composite(color, coc, cocHalf, cocNearBlur, filledFields[0], filledFields[1]);
+    }
+
+    /**
+     *  CPU version of coc.frag.
+     *  @param depth the depth buffer values in [0, 1] in the first channel.
+     *  @param cocParams the CoC parameters (see DepthOfField::CalculateCoCParams()).
+     *  @return the near CoC, far CoC and view space depth.
+     */
+    CPUImage CPUDepthOfField::CoC(const CPUImage& depth, const DoFCoCParams& cocParams) const
+    {
+        ENH_PROFILE_CPU("CPUDepthOfField/CoC");
+        CPUImage result{ depth.GetWidth(), depth.GetHeight() };
+        ForEachTile(result.GetSize(), [&depth, &result, &cocParams](const glm::uvec2& begin, const glm::uvec2& end) {
+            for (auto y = begin.y; y < end.y; ++y) {
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto depthNDC = 2.0f * depth.Get(x, y)[0] - 1.0f;
+                    auto coc = depthNDC * cocParams.cocParams_.x + cocParams.cocParams_.y;
+                    auto viewDepth = cocParams.projParams_.y / (depthNDC + cocParams.projParams_.x);
+                    if (coc < 0.0f) result.Set(x, y, float4(0.0f, Saturate(-coc), viewDepth, 0.0f));
+                    else result.Set(x, y, float4(Saturate(coc), 0.0f, viewDepth, 0.0f));
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /**
+     *  CPU version of downsample.frag.
+     *  @param color the color image.
+     *  @param coc the result of CoC().
+     *  @return the half resolution color, color weighted with the far CoC and near/far CoC.
+     */
+    std::array<CPUImage, 3> CPUDepthOfField::Downsample(const CPUImage& color, const CPUImage& coc) const
+    {
+        ENH_PROFILE_CPU("CPUDepthOfField/Downsample");
+        const auto lowResWidth = std::max(color.GetWidth() / 2, 1u), lowResHeight = std::max(color.GetHeight() / 2, 1u);
+        std::array<CPUImage, 3> result{ CPUImage{ lowResWidth, lowResHeight }, CPUImage{ lowResWidth, lowResHeight }, CPUImage{ lowResWidth, lowResHeight } };
+        ForEachTile(result[0].GetSize(), [&color, &coc, &result](const glm::uvec2& begin, const glm::uvec2& end) {
+            const std::array<glm::ivec2, 4> offsets{ glm::ivec2(1, 1), glm::ivec2(0, 1), glm::ivec2(1, 0), glm::ivec2(0, 0) };
+            for (auto y = begin.y; y < end.y; ++y) {
+                auto sy = GetFetchCoordinate(y, result[0].GetHeight(), color.GetHeight());
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto sx = GetFetchCoordinate(x, result[0].GetWidth(), color.GetWidth());
+
+                    std::array<float4, 4> colors;
+                    std::array<float, 4> depths, cocFar;
+                    auto depthMin = 1000000000.0f, cocNearMax = 0.0f, cocFarMin = 1000000000.0f;
+                    for (std::size_t i = 0; i < 4; ++i) {
+                        colors[i] = color.GetClamped(sx + offsets[i].x, sy + offsets[i].y);
+                        auto sampleCoC = coc.GetClamped(sx + offsets[i].x, sy + offsets[i].y);
+                        depths[i] = sampleCoC[2];
+                        cocFar[i] = sampleCoC[1];
+                        depthMin = std::min(depthMin, depths[i]);
+                        cocNearMax = std::max(cocNearMax, sampleCoC[0]);
+                        cocFarMin = std::min(cocFarMin, cocFar[i]);
+                    }
+
+                    float4 colorHalf, colorMulCoCFar;
+                    auto depthWSum = 0.0f, cocWSum = 0.0f;
+                    for (std::size_t i = 0; i < 4; ++i) {
+                        auto depthW = 1.0f / (std::abs(depths[i] - depthMin) + 0.001f);
+                        depthWSum += depthW;
+                        colorHalf += colors[i] * depthW;
+
+                        auto cocW = 1.0f / (std::abs(cocFar[i] - cocFarMin) + 0.001f);
+                        cocWSum += cocW;
+                        colorMulCoCFar += colors[i] * cocW;
+                    }
+
+                    // the targets have 3 channels, so alpha reads as 1.
+                    result[0].Set(x, y, WithW(colorHalf * (1.0f / depthWSum), float4(1.0f)));
+                    result[1].Set(x, y, WithW(colorMulCoCFar * (cocFarMin / cocWSum), float4(1.0f)));
+                    result[2].Set(x, y, float4(cocNearMax, cocFarMin, 0.0f, 0.0f));
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /**
+     *  CPU version of tileMinMaxCoC.frag.
+     *  @param cocHalf the CoC to find the maximum near and minimum far CoC in.
+     *  @param horizontal whether to search horizontally (HORIZONTAL) or vertically (VERTICAL).
+     */
+    CPUImage CPUDepthOfField::TileMinMax(const CPUImage& cocHalf, bool horizontal) const
+    {
+        ENH_PROFILE_CPU("CPUDepthOfField/TileMinMax");
+        CPUImage result{ cocHalf.GetWidth(), cocHalf.GetHeight() };
+        const glm::ivec2 direction = horizontal ? glm::ivec2(1, 0) : glm::ivec2(0, 1);
+        ForEachTile(result.GetSize(), [&cocHalf, &result, direction](const glm::uvec2& begin, const glm::uvec2& end) {
+            for (auto y = begin.y; y < end.y; ++y) {
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto cocNearMax = 0.0f, cocFarMin = 1000000000.0f;
+                    for (int i = -TILE_RADIUS; i <= TILE_RADIUS; ++i) {
+                        auto coc = cocHalf.GetClamped(static_cast<int>(x) + i * direction.x, static_cast<int>(y) + i * direction.y);
+                        cocNearMax = std::max(cocNearMax, coc[0]);
+                        cocFarMin = std::min(cocFarMin, coc[1]);
+                    }
+                    result.Set(x, y, float4(cocNearMax, cocFarMin, 0.0f, 0.0f));
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /**
+     *  CPU version of nearCoCBlur.frag.
+     *  @param cocTile the tile min/max CoC to blur the near CoC of.
+     *  @param horizontal whether to blur horizontally (HORIZONTAL) or vertically (VERTICAL).
+     */
+    CPUImage CPUDepthOfField::NearCoCBlur(const CPUImage& cocTile, bool horizontal) const
+    {
+        ENH_PROFILE_CPU("CPUDepthOfField/NearCoCBlur");
+        CPUImage result{ cocTile.GetWidth(), cocTile.GetHeight() };
+        const glm::ivec2 direction = horizontal ? glm::ivec2(1, 0) : glm::ivec2(0, 1);
+        ForEachTile(result.GetSize(), [&cocTile, &result, direction](const glm::uvec2& begin, const glm::uvec2& end) {
+            for (auto y = begin.y; y < end.y; ++y) {
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto center = cocTile.Get(x, y);
+                    // the bilinear taps of the shader average the clamped texels with equal weights.
+                    auto cocNear = 0.0f;
+                    for (int i = -TILE_RADIUS; i <= TILE_RADIUS; ++i) {
+                        cocNear += cocTile.GetClamped(static_cast<int>(x) + i * direction.x, static_cast<int>(y) + i * direction.y)[0];
+                    }
+                    result.Set(x, y, float4(cocNear / static_cast<float>(2 * TILE_RADIUS + 1), center[1], 0.0f, 0.0f));
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /**
+     *  CPU version of dof.frag gathering the near and far fields with the bokeh taps.
+     *  @param cocHalf the half resolution CoC.
+     *  @param cocNearBlur the blurred near CoC.
+     *  @param colorHalf the half resolution color.
+     *  @param colorMulCoCFarHalf the half resolution color weighted with the far CoC.
+     *  @param bokehTaps the bokeh tap sets (see DepthOfField::CalculateBokehTaps()).
+     *  @return the near and far fields.
+     */
+    std::array<CPUImage, 2> CPUDepthOfField::Gather(const CPUImage& cocHalf, const CPUImage& cocNearBlur, const CPUImage& colorHalf,
+        const CPUImage& colorMulCoCFarHalf, const std::array<glm::vec4, 80>& bokehTaps) const
+    {
+        ENH_PROFILE_CPU("CPUDepthOfField/Gather");
+        std::array<CPUImage, 2> result{ CPUImage{ cocHalf.GetWidth(), cocHalf.GetHeight() }, CPUImage{ cocHalf.GetWidth(), cocHalf.GetHeight() } };
+        ForEachTile(cocHalf.GetSize(), [&](const glm::uvec2& begin, const glm::uvec2& end) {
+            for (auto y = begin.y; y < end.y; ++y) {
+                auto centerY = static_cast<float>(y) + 0.5f;
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto centerX = static_cast<float>(x) + 0.5f;
+                    auto cocNearBlurred = Saturate(cocNearBlur.Get(x, y)[0]);
+                    auto cocFar = Saturate(cocHalf.Get(x, y)[1]);
+
+                    float4 nearField;
+                    if (cocNearBlurred > 0.0f) {
+                        auto tapCount = BokehTapCount(cocNearBlurred);
+                        auto firstTap = BokehFirstTap(tapCount);
+                        nearField = colorHalf.Get(x, y);
+                        for (std::size_t i = firstTap; i < firstTap + tapCount; ++i) {
+                            nearField += colorHalf.SampleLinear(centerX + cocNearBlurred * bokehTaps[i].x, centerY + cocNearBlurred * bokehTaps[i].y);
+                        }
+                        nearField = nearField * (cocNearBlurred / static_cast<float>(tapCount + 1));
+                    }
+
+                    float4 farField;
+                    if (cocFar > 0.0f) {
+                        auto tapCount = BokehTapCount(cocFar);
+                        auto firstTap = BokehFirstTap(tapCount);
+                        farField = colorMulCoCFarHalf.Get(x, y);
+                        auto weightsSum = 0.0f;
+                        for (std::size_t i = firstTap; i < firstTap + tapCount; ++i) {
+                            auto sampleX = centerX + cocFar * bokehTaps[i].x, sampleY = centerY + cocFar * bokehTaps[i].y;
+                            auto coc = Saturate(cocHalf.SampleLinear(sampleX, sampleY)[1]);
+                            farField += colorMulCoCFarHalf.SampleLinear(sampleX, sampleY) * coc;
+                            weightsSum += coc;
+                        }
+                        farField = farField * (cocFar / weightsSum);
+                    }
+
+                    result[0].Set(x, y, nearField);
+                    result[1].Set(x, y, farField);
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /**
+     *  CPU version of fill.frag.
+     *  @param cocHalf the half resolution CoC.
+     *  @param cocNearBlur the blurred near CoC.
+     *  @param nearField the near field from Gather().
+     *  @param farField the far field from Gather().
+     *  @return the filled near and far fields.
+     */
+    std::array<CPUImage, 2> CPUDepthOfField::Fill(const CPUImage& cocHalf, const CPUImage& cocNearBlur, const CPUImage& nearField, const CPUImage& farField) const
+    {
+        ENH_PROFILE_CPU("CPUDepthOfField/Fill");
+        std::array<CPUImage, 2> result{ CPUImage{ cocHalf.GetWidth(), cocHalf.GetHeight() }, CPUImage{ cocHalf.GetWidth(), cocHalf.GetHeight() } };
+        ForEachTile(cocHalf.GetSize(), [&](const glm::uvec2& begin, const glm::uvec2& end) {
+            auto maxNeighborhood = [](const CPUImage& field, unsigned int x, unsigned int y) {
+                auto result = field.Get(x, y);
+                for (int i = -1; i <= 1; ++i) {
+                    for (int j = -1; j <= 1; ++j) result = Max(result, field.GetClamped(static_cast<int>(x) + i, static_cast<int>(y) + j));
+                }
+                return result;
+            };
+
+            for (auto y = begin.y; y < end.y; ++y) {
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto nearColor = cocNearBlur.Get(x, y)[0] > 0.0f ? maxNeighborhood(nearField, x, y) : nearField.Get(x, y);
+                    auto farColor = cocHalf.Get(x, y)[1] > 0.0f ? maxNeighborhood(farField, x, y) : farField.Get(x, y);
+                    // the targets have 3 channels, so alpha reads as 1.
+                    result[0].Set(x, y, WithW(nearColor, float4(1.0f)));
+                    result[1].Set(x, y, WithW(farColor, float4(1.0f)));
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /**
+     *  CPU version of composite.frag blending the filled fields into the full resolution color.
+     *  @param color the color image, the result has the same size.
+     *  @param coc the full resolution CoC.
+     *  @param cocHalf the half resolution CoC.
+     *  @param cocNearBlur the blurred near CoC.
+     *  @param nearField the filled near field.
+     *  @param farField the filled far field.
+     */
+    CPUImage CPUDepthOfField::Composite(const CPUImage& color, const CPUImage& coc, const CPUImage& cocHalf, const CPUImage& cocNearBlur,
+        const CPUImage& nearField, const CPUImage& farField) const
+    {
+        ENH_PROFILE_CPU("CPUDepthOfField/Composite");
+        CPUImage result{ color.GetWidth(), color.GetHeight() };
+        const auto halfScale = glm::vec2(cocHalf.GetSize()) / glm::vec2(color.GetSize());
+        ForEachTile(result.GetSize(), [&](const glm::uvec2& begin, const glm::uvec2& end) {
+            auto blend = [](const float4& current, const float4& dof, float blendCoC) {
+                auto blendWeightDoF = blendCoC * blendCoC * blendCoC;
+                return current * (1.0f - blendWeightDoF * blendCoC) + dof * blendWeightDoF;
+            };
+
+            for (auto y = begin.y; y < end.y; ++y) {
+                auto halfY = (static_cast<float>(y) + 0.5f) * halfScale.y;
+                auto gatherY = static_cast<int>(std::floor(halfY - 0.5f));
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto halfX = (static_cast<float>(x) + 0.5f) * halfScale.x;
+                    auto gatherX = static_cast<int>(std::floor(halfX - 0.5f));
+                    auto resultColor = color.Get(x, y);
+
+                    // the bilateral weights are ordered like the bicubic samples: lower left, lower right, upper left, upper right.
+                    auto cocFar = coc.Get(x, y)[1];
+                    auto cocFarDiffs = Abs(float4(cocFar) - float4(cocHalf.GetClamped(gatherX, gatherY)[1], cocHalf.GetClamped(gatherX + 1, gatherY)[1],
+                        cocHalf.GetClamped(gatherX, gatherY + 1)[1], cocHalf.GetClamped(gatherX + 1, gatherY + 1)[1]));
+                    auto dofFar = SampleBiCubicBilateral(farField, halfX, halfY, cocFarDiffs);
+                    resultColor = blend(resultColor, dofFar, Saturate(cocFar));
+
+                    auto cocNear = Saturate(SampleBiCubic(cocNearBlur, halfX, halfY)[0]);
+                    auto dofNear = SampleBiCubic(nearField, halfX, halfY);
+                    resultColor = blend(resultColor, dofNear, cocNear);
+
+                    result.Set(x, y, resultColor);
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+}
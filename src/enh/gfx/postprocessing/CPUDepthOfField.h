@@ -0,0 +1,53 @@
+/**
+ * @file   CPUDepthOfField.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the CPU version of the depth of field effect.
+ */
+
+#pragma once
+
+#include "CPUImage.h"
+#include <array>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+namespace viscom::enh {
+
+    struct DOFParams;
+    struct DoFCoCParams;
+
+    /**
+     * @brief  CPU reference of the depth of field shaders (fragment pipeline).
+     *
+     *  Each stage mirrors one shader of DepthOfField and returns the render targets it writes, so intermediate
+     *  results can be compared to downloaded GPU targets. Out of range texel fetches are clamped to the edge. The
+     *  stages are tiled across threads and process pixels with SSE. ApplyEffect() runs all stages on color and depth
+     *  images without a GL context, e.g. for offline renders.
+     */
+    class CPUDepthOfField
+    {
+    public:
+        explicit CPUDepthOfField(unsigned int numThreads = 0) : numThreads_{ numThreads } {}
+
+        CPUImage ApplyEffect(const DOFParams& params, const glm::mat4& projection, const CPUImage& color, const CPUImage& depth) const;
+
+        CPUImage CoC(const CPUImage& depth, const DoFCoCParams& cocParams) const;
+        std::array<CPUImage, 3> Downsample(const CPUImage& color, const CPUImage& coc) const;
+        CPUImage TileMinMax(const CPUImage& cocHalf, bool horizontal) const;
+        CPUImage NearCoCBlur(const CPUImage& cocTile, bool horizontal) const;
+        std::array<CPUImage, 2> Gather(const CPUImage& cocHalf, const CPUImage& cocNearBlur, const CPUImage& colorHalf,
+            const CPUImage& colorMulCoCFarHalf, const std::array<glm::vec4, 80>& bokehTaps) const;
+        std::array<CPUImage, 2> Fill(const CPUImage& cocHalf, const CPUImage& cocNearBlur, const CPUImage& nearField, const CPUImage& farField) const;
+        CPUImage Composite(const CPUImage& color, const CPUImage& coc, const CPUImage& cocHalf, const CPUImage& cocNearBlur,
+            const CPUImage& nearField, const CPUImage& farField) const;
+
+        /** Sets the number of threads used (0 to use all hardware threads). */
+        void SetNumThreads(unsigned int numThreads) { numThreads_ = numThreads; }
+
+    private:
+        /** Holds the number of threads used. */
+        unsigned int numThreads_;
+    };
+}
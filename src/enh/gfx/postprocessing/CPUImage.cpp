@@ -0,0 +1,157 @@
+/**
+ * @file   CPUImage.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of a float RGBA image for the CPU versions of the post-processing effects.
+ */
+
+#include "CPUImage.h"
+#include "core/main.h"
+#include "enh/core/profiler.h"
+#include <atomic>
+#include <thread>
+#include <glbinding/gl/gl.h>
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+namespace viscom::enh {
+
+    namespace {
+        /** The size of the tiles distributed to the threads. */
+        constexpr unsigned int TILE_SIZE = 64;
+    }
+
+    CPUImage::CPUImage(unsigned int width, unsigned int height) :
+        width_{ width },
+        height_{ height },
+        data_(static_cast<std::size_t>(width) * height * 4, 0.0f)
+    {
+    }
+
+    /**
+     *  Loads an image with stb_image, LDR images are converted to linear floats by stb_image.
+     *  @param filename the file to load.
+     */
+    CPUImage CPUImage::Load(const std::string& filename)
+    {
+        ENH_PROFILE_CPU("CPUImage/Load");
+        stbi_set_flip_vertically_on_load(1);
+        auto imgWidth = 0, imgHeight = 0, imgChannels = 0;
+        auto image = stbi_loadf(filename.c_str(), &imgWidth, &imgHeight, &imgChannels, 4);
+        if (!image) {
+            LOG(FATAL) << R"(Could not load image ")" << filename.c_str() << R"(".)";
+            throw std::runtime_error(R"(Could not load image ")" + filename + R"(".)");
+        }
+
+        CPUImage result{ static_cast<unsigned int>(imgWidth), static_cast<unsigned int>(imgHeight) };
+        std::copy(image, image + result.data_.size(), result.data_.begin());
+        stbi_image_free(image);
+        return result;
+    }
+
+    /**
+     *  Downloads the first level of a 2D texture (e.g. the output of a GPU effect) for comparison.
+     *  @param texture the texture to download.
+     */
+    CPUImage CPUImage::Download(gl::GLuint texture)
+    {
+        ENH_PROFILE_CPU("CPUImage/Download");
+        gl::GLint width = 0, height = 0;
+        gl::glGetTextureLevelParameteriv(texture, 0, gl::GL_TEXTURE_WIDTH, &width);
+        gl::glGetTextureLevelParameteriv(texture, 0, gl::GL_TEXTURE_HEIGHT, &height);
+
+        CPUImage result{ static_cast<unsigned int>(width), static_cast<unsigned int>(height) };
+        auto bufferSize = result.data_.size() * sizeof(float);
+        gl::glGetTextureImage(texture, 0, gl::GL_RGBA, gl::GL_FLOAT, static_cast<gl::GLsizei>(bufferSize), result.data_.data());
+        ENH_PROFILE_COUNT(DOWNLOADED_BYTES, bufferSize);
+        return result;
+    }
+
+    /**
+     *  Saves the image as Radiance HDR file, the alpha channel is not stored.
+     *  @param filename the file to write.
+     *  @return whether the file was written.
+     */
+    bool CPUImage::SaveHDR(const std::string& filename) const
+    {
+        ENH_PROFILE_CPU("CPUImage/Save");
+        // files are stored top to bottom.
+        std::vector<float> flipped(data_.size());
+        auto rowSize = static_cast<std::size_t>(width_) * 4;
+        for (unsigned int y = 0; y < height_; ++y) std::copy_n(GetRow(y), rowSize, &flipped[(height_ - y - 1) * rowSize]);
+
+        if (stbi_write_hdr(filename.c_str(), static_cast<int>(width_), static_cast<int>(height_), 4, flipped.data()) == 0) {
+            LOG(WARNING) << R"(Could not write image ")" << filename.c_str() << R"(".)";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     *  Samples the image with linear filtering and clamping to the edge like texture().
+     *  @param x the horizontal coordinate in pixels (the texture coordinate multiplied by the width).
+     *  @param y the vertical coordinate in pixels.
+     */
+    float4 CPUImage::SampleLinear(float x, float y) const
+    {
+        auto fx = x - 0.5f, fy = y - 0.5f;
+        auto x0 = std::floor(fx), y0 = std::floor(fy);
+        auto tx = fx - x0, ty = fy - y0;
+        auto ix = static_cast<int>(x0), iy = static_cast<int>(y0);
+        auto bottom = Mix(GetClamped(ix, iy), GetClamped(ix + 1, iy), tx);
+        auto top = Mix(GetClamped(ix, iy + 1), GetClamped(ix + 1, iy + 1), tx);
+        return Mix(bottom, top, ty);
+    }
+
+    /**
+     *  Compares the image to another one of the same size.
+     *  @param other the image to compare to.
+     */
+    ImageDifference CPUImage::Compare(const CPUImage& other) const
+    {
+        if (width_ != other.width_ || height_ != other.height_) {
+            LOG(FATAL) << "Cannot compare images of different sizes.";
+            throw std::runtime_error("Cannot compare images of different sizes.");
+        }
+
+        ImageDifference result;
+        if (data_.empty()) return result;
+
+        double squaredError = 0.0;
+        for (std::size_t i = 0; i < data_.size(); i += 4) {
+            auto difference = Abs(float4::Load(&data_[i]) - float4::Load(&other.data_[i]));
+            result.maxError_ = std::max(result.maxError_, difference.HorizontalMax());
+            squaredError += (difference * difference).HorizontalSum();
+        }
+        result.rmse_ = static_cast<float>(std::sqrt(squaredError / static_cast<double>(data_.size())));
+        return result;
+    }
+
+    /**
+     *  Calls a function for all tiles of an image, the tiles are distributed over several threads.
+     *  @param size the size of the image.
+     *  @param function the function called with the first pixel of a tile and the pixel after its last one.
+     *  @param numThreads the number of threads to use (0 to use all hardware threads).
+     */
+    void ForEachTile(const glm::uvec2& size, const TileFunction& function, unsigned int numThreads)
+    {
+        const glm::uvec2 numTiles = (size + glm::uvec2(TILE_SIZE - 1)) / TILE_SIZE;
+        const auto tileCount = numTiles.x * numTiles.y;
+        if (numThreads == 0) numThreads = std::thread::hardware_concurrency();
+        numThreads = std::max(std::min(numThreads, tileCount), 1u);
+
+        std::atomic<unsigned int> nextTile{ 0 };
+        auto processTiles = [&]() {
+            for (auto tile = nextTile++; tile < tileCount; tile = nextTile++) {
+                glm::uvec2 begin{ (tile % numTiles.x) * TILE_SIZE, (tile / numTiles.x) * TILE_SIZE };
+                function(begin, glm::min(begin + glm::uvec2(TILE_SIZE), size));
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < numThreads; ++i) threads.emplace_back(processTiles);
+        processTiles();
+        for (auto& thread : threads) thread.join();
+    }
+}
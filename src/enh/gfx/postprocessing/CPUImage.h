@@ -0,0 +1,75 @@
+/**
+ * @file   CPUImage.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of a float RGBA image for the CPU versions of the post-processing effects.
+ */
+
+#pragma once
+
+#include "enh/core/float4.h"
+#include <functional>
+#include <string>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glbinding/gl/types.h>
+
+namespace viscom::enh {
+
+    /** The difference between two images. */
+    struct ImageDifference
+    {
+        /** Holds the maximum absolute difference of a channel. */
+        float maxError_ = 0.0f;
+        /** Holds the root mean square error over all channels. */
+        float rmse_ = 0.0f;
+    };
+
+    /**
+     * @brief  A float RGBA image in CPU memory.
+     *
+     *  The rows are stored from bottom to top like OpenGL textures, so texture coordinates map to the same pixels as on
+     *  the GPU. Images are loaded with stb_image (Radiance HDR and the LDR formats), EXR files need to be converted.
+     */
+    class CPUImage
+    {
+    public:
+        CPUImage() = default;
+        CPUImage(unsigned int width, unsigned int height);
+
+        static CPUImage Load(const std::string& filename);
+        static CPUImage Download(gl::GLuint texture);
+        bool SaveHDR(const std::string& filename) const;
+        ImageDifference Compare(const CPUImage& other) const;
+
+        unsigned int GetWidth() const { return width_; }
+        unsigned int GetHeight() const { return height_; }
+        glm::uvec2 GetSize() const { return glm::uvec2(width_, height_); }
+        /** Returns the first channel of a row. */
+        float* GetRow(unsigned int y) { return &data_[static_cast<std::size_t>(y) * width_ * 4]; }
+        /** Returns the first channel of a row. */
+        const float* GetRow(unsigned int y) const { return &data_[static_cast<std::size_t>(y) * width_ * 4]; }
+        /** Returns a pixel. */
+        float4 Get(unsigned int x, unsigned int y) const { return float4::Load(GetRow(y) + 4 * static_cast<std::size_t>(x)); }
+        /** Returns a pixel, the coordinates are clamped to the image like GL_CLAMP_TO_EDGE. */
+        float4 GetClamped(int x, int y) const { return Get(ClampX(x), ClampY(y)); }
+        float4 SampleLinear(float x, float y) const;
+        /** Sets a pixel. */
+        void Set(unsigned int x, unsigned int y, const float4& value) { value.Store(GetRow(y) + 4 * static_cast<std::size_t>(x)); }
+        unsigned int ClampX(int x) const { return static_cast<unsigned int>(std::clamp(x, 0, static_cast<int>(width_) - 1)); }
+        unsigned int ClampY(int y) const { return static_cast<unsigned int>(std::clamp(y, 0, static_cast<int>(height_) - 1)); }
+        const std::vector<float>& GetData() const { return data_; }
+
+    private:
+        /** Holds the width. */
+        unsigned int width_ = 0;
+        /** Holds the height. */
+        unsigned int height_ = 0;
+        /** Holds the pixels, 4 floats each. */
+        std::vector<float> data_;
+    };
+
+    using TileFunction = std::function<void(const glm::uvec2& begin, const glm::uvec2& end)>;
+    void ForEachTile(const glm::uvec2& size, const TileFunction& function, unsigned int numThreads = 0);
+}
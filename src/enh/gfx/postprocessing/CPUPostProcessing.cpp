@@ -0,0 +1,287 @@
+/**
+ * @file   CPUPostProcessing.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the CPU versions of the bloom and tone-mapping passes.
+ */
+
+#include "CPUPostProcessing.h"
+#include "BloomEffect.h"
+#include "FilmicTMOperator.h"
+#include "SeparableKernel.h"
+#include "enh/core/profiler.h"
+#include <memory>
+
+namespace viscom::enh {
+
+    namespace {
+        /** The weights of the blur levels in combineBloom.frag. */
+        constexpr std::array<float, 3> COMBINE_WEIGHTS{ 1.0f / 12.0f, 3.0f / 12.0f, 8.0f / 12.0f };
+
+        /** A texel read by a filter and its weight. */
+        struct FilterTap
+        {
+            unsigned int index_;
+            float weight_;
+        };
+
+        /**
+         *  Returns the taps of a kernel along one axis for each output texel, the linear samples are split into two taps
+         *  each. The taps of texel i start at i * 4 * kernel.GetNumTaps().
+         */
+        std::vector<FilterTap> GetBlurTaps(unsigned int size, const SeparableKernel& kernel)
+        {
+            const auto tapsPerTexel = 4 * kernel.GetNumTaps();
+            std::vector<FilterTap> taps(size * tapsPerTexel);
+            const auto maxIndex = static_cast<int>(size) - 1;
+            for (unsigned int i = 0; i < size; ++i) {
+                auto tap = i * tapsPerTexel;
+                for (std::size_t k = 0; k < kernel.GetNumTaps(); ++k) {
+                    for (auto sign : { 1.0f, -1.0f }) {
+                        auto coord = static_cast<float>(i) + sign * kernel.GetOffset(k);
+                        auto first = std::floor(coord);
+                        auto fraction = coord - first;
+                        auto firstIndex = static_cast<int>(first);
+                        taps[tap++] = FilterTap{ static_cast<unsigned int>(std::clamp(firstIndex, 0, maxIndex)), kernel.GetWeight(k) * (1.0f - fraction) };
+                        taps[tap++] = FilterTap{ static_cast<unsigned int>(std::clamp(firstIndex + 1, 0, maxIndex)), kernel.GetWeight(k) * fraction };
+                    }
+                }
+            }
+            return taps;
+        }
+
+        /** Returns the cubic B-spline taps of bicubic_sampling.glsl when sampling a texture of sourceSize for each texel of targetSize. */
+        std::vector<std::array<FilterTap, 4>> GetBicubicTaps(unsigned int sourceSize, unsigned int targetSize)
+        {
+            std::vector<std::array<FilterTap, 4>> taps(targetSize);
+            const auto maxIndex = static_cast<int>(sourceSize) - 1;
+            for (unsigned int i = 0; i < targetSize; ++i) {
+                auto coord = (static_cast<float>(i) + 0.5f) / static_cast<float>(targetSize) * static_cast<float>(sourceSize) - 0.5f;
+                auto first = std::floor(coord);
+                auto x = coord - first;
+                auto x2 = x * x;
+                auto x3 = x2 * x;
+                std::array<float, 4> w{ (1.0f - 3.0f * x + 3.0f * x2 - x3) / 6.0f, (3.0f * x3 - 6.0f * x2 + 4.0f) / 6.0f,
+                    (1.0f + 3.0f * x + 3.0f * x2 - 3.0f * x3) / 6.0f, x3 / 6.0f };
+                for (int k = 0; k < 4; ++k) {
+                    taps[i][k] = FilterTap{ static_cast<unsigned int>(std::clamp(static_cast<int>(first) + k - 1, 0, maxIndex)), w[k] };
+                }
+            }
+            return taps;
+        }
+
+        /** Returns the texel fetched by glareDetect.frag and downsampleBloom.frag for a target texel (before the offsets). */
+        int GetFetchCoordinate(unsigned int targetCoord, unsigned int targetSize, unsigned int sourceSize)
+        {
+            return static_cast<int>((static_cast<float>(targetCoord) + 0.5f) / static_cast<float>(targetSize) * static_cast<float>(sourceSize));
+        }
+
+        /** Sums the four texels fetched by glareDetect.frag and downsampleBloom.frag. */
+        float4 FetchQuad(const CPUImage& source, int x, int y)
+        {
+            return source.GetClamped(x + 1, y + 1) + source.GetClamped(x, y + 1) + source.GetClamped(x + 1, y) + source.GetClamped(x, y);
+        }
+
+        /** The constants of the filmic curve in filmicCurve.glsl. */
+        struct FilmicCurve
+        {
+            explicit FilmicCurve(const FilmicTMParameters& params) :
+                a_{ params.sStrength_ },
+                b_{ params.linStrength_ },
+                cb_{ params.linAngle_ * params.linStrength_ },
+                de_{ params.toeStrength_ * params.toeNumerator_ },
+                df_{ params.toeStrength_ * params.toeDenominator_ },
+                toeAngle_{ params.toeNumerator_ / params.toeDenominator_ },
+                exposure_{ params.exposure_ }
+            {
+                scale_ = 2.0f / Uncharted2Tonemap(params.white_);
+            }
+
+            float Uncharted2Tonemap(float x) const { return (x * (a_ * x + cb_) + de_) / (x * (a_ * x + b_) + df_) - toeAngle_; }
+
+            /** Tone-maps the color channels, the alpha is kept. */
+            float4 Tonemap(const float4& color) const
+            {
+                auto x = color * exposure_;
+                auto ax = x * a_;
+                auto curve = (x * (ax + float4(cb_)) + float4(de_)) / (x * (ax + float4(b_)) + float4(df_)) - float4(toeAngle_);
+                return WithW(curve * scale_, color);
+            }
+
+            float a_, b_, cb_, de_, df_, toeAngle_, exposure_, scale_;
+        };
+    }
+
+    /** CPU version of glareDetect.frag, returns the half resolution glare. */
+    CPUImage CPUPostProcessing::GlareDetect(const CPUImage& source) const
+    {
+        ENH_PROFILE_CPU("CPUBloom/GlareDetect");
+        CPUImage result{ std::max(source.GetWidth() / 2, 1u), std::max(source.GetHeight() / 2, 1u) };
+        ForEachTile(result.GetSize(), [&source, &result](const glm::uvec2& begin, const glm::uvec2& end) {
+            for (auto y = begin.y; y < end.y; ++y) {
+                auto sy = GetFetchCoordinate(y, result.GetHeight(), source.GetHeight());
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto sx = GetFetchCoordinate(x, result.GetWidth(), source.GetWidth());
+                    // each fetch has an alpha of 1, so the division by alpha averages.
+                    auto color = FetchQuad(source, sx, sy) * 0.25f;
+                    result.Set(x, y, WithW(Max(color - float4(1.0f), float4(0.0f)), float4(1.0f)));
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /** CPU version of downsampleBloom.frag, returns the source down sampled to half its resolution. */
+    CPUImage CPUPostProcessing::DownsampleBloom(const CPUImage& source) const
+    {
+        ENH_PROFILE_CPU("CPUBloom/Downsample");
+        CPUImage result{ std::max(source.GetWidth() / 2, 1u), std::max(source.GetHeight() / 2, 1u) };
+        ForEachTile(result.GetSize(), [&source, &result](const glm::uvec2& begin, const glm::uvec2& end) {
+            for (auto y = begin.y; y < end.y; ++y) {
+                auto sy = GetFetchCoordinate(y, result.GetHeight(), source.GetHeight());
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto sx = GetFetchCoordinate(x, result.GetWidth(), source.GetWidth());
+                    auto color = FetchQuad(source, sx, sy);
+                    if (color[3] > 1.0f) color = color * (1.0f / color[3]);
+                    result.Set(x, y, color);
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /**
+     *  CPU version of blurBloom.frag.
+     *  @param source the image to blur.
+     *  @param bloomWidth the bloom width the Gaussian kernel is created for (see BloomEffect::CreateBlurKernel()).
+     *  @param horizontal whether to blur horizontally (HORIZONTAL) or vertically (VERTICAL).
+     */
+    CPUImage CPUPostProcessing::BlurBloom(const CPUImage& source, float bloomWidth, bool horizontal) const
+    {
+        ENH_PROFILE_CPU("CPUBloom/Blur");
+        CPUImage result{ source.GetWidth(), source.GetHeight() };
+        const auto kernel = BloomEffect::CreateBlurKernel(bloomWidth);
+        const auto taps = GetBlurTaps(horizontal ? source.GetWidth() : source.GetHeight(), kernel);
+        const auto tapsPerTexel = 4 * kernel.GetNumTaps();
+        ForEachTile(result.GetSize(), [&source, &result, &taps, tapsPerTexel, horizontal](const glm::uvec2& begin, const glm::uvec2& end) {
+            for (auto y = begin.y; y < end.y; ++y) {
+                for (auto x = begin.x; x < end.x; ++x) {
+                    float4 color;
+                    const auto* texelTaps = &taps[(horizontal ? x : y) * tapsPerTexel];
+                    for (std::size_t i = 0; i < tapsPerTexel; ++i) {
+                        const auto& tap = texelTaps[i];
+                        color += horizontal ? source.Get(tap.index_, y) * tap.weight_ : source.Get(x, tap.index_) * tap.weight_;
+                    }
+                    result.Set(x, y, WithW(color, float4(1.0f)));
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /**
+     *  CPU version of combineBloom.frag (without DUAL_FILTER).
+     *  @param source the HDR source image, the result has the same size.
+     *  @param blurred the blurred half resolution glare and the fourth resolution glare blurred once and twice.
+     *  @param bloomIntensity the intensity of the bloom.
+     *  @param tonemapping the parameters of the tone-mapping fused into the pass (TONEMAP) or nullptr.
+     */
+    CPUImage CPUPostProcessing::CombineBloom(const CPUImage& source, const std::array<const CPUImage*, 3>& blurred,
+        float bloomIntensity, const FilmicTMParameters* tonemapping) const
+    {
+        ENH_PROFILE_CPU("CPUBloom/Combine");
+        CPUImage result{ source.GetWidth(), source.GetHeight() };
+        std::array<std::vector<std::array<FilterTap, 4>>, 3> tapsX, tapsY;
+        for (std::size_t i = 0; i < blurred.size(); ++i) {
+            tapsX[i] = GetBicubicTaps(blurred[i]->GetWidth(), source.GetWidth());
+            tapsY[i] = GetBicubicTaps(blurred[i]->GetHeight(), source.GetHeight());
+        }
+        std::unique_ptr<FilmicCurve> curve;
+        if (tonemapping) curve = std::make_unique<FilmicCurve>(*tonemapping);
+
+        ForEachTile(result.GetSize(), [&](const glm::uvec2& begin, const glm::uvec2& end) {
+            for (auto y = begin.y; y < end.y; ++y) {
+                for (auto x = begin.x; x < end.x; ++x) {
+                    auto originalColor = source.Get(x, y);
+                    // subtracting the glare clamps the color to 1.
+                    auto color = Min(originalColor, float4(1.0f));
+                    for (std::size_t i = 0; i < blurred.size(); ++i) {
+                        float4 bloom;
+                        for (const auto& tapY : tapsY[i][y]) {
+                            float4 row;
+                            for (const auto& tapX : tapsX[i][x]) row += blurred[i]->Get(tapX.index_, tapY.index_) * tapX.weight_;
+                            bloom += row * tapY.weight_;
+                        }
+                        color += bloom * (bloomIntensity * COMBINE_WEIGHTS[i]);
+                    }
+                    color = WithW(color, originalColor);
+                    if (curve) color = curve->Tonemap(color);
+                    result.Set(x, y, color);
+                }
+            }
+        }, numThreads_);
+        return result;
+    }
+
+    /**
+     *  Runs the passes of the fragment bloom pipeline (BloomPipeline::FRAGMENT) like BloomEffect::ApplyEffect().
+     *  @param source the HDR source image, the result has the same size.
+     *  @param params the bloom parameters.
+     *  @param tonemapping the parameters of the tone-mapping fused into the combine pass or nullptr.
+     */
+    CPUImage CPUPostProcessing::ApplyBloom(const CPUImage& source, const BloomParams& params, const FilmicTMParameters* tonemapping) const
+    {
+        ENH_PROFILE_CPU("CPUBloom");
+        auto blur = [this, &params](const CPUImage& image) {
+            return BlurBloom(BlurBloom(image, params.bloomWidth_, true), params.bloomWidth_, false);
+        };
+
+        auto glare = GlareDetect(source);
+        auto blurHalf = blur(glare);
+        auto blurFourth1 = blur(DownsampleBloom(glare));
+        auto blurFourth2 = blur(blurFourth1);
+        return CombineBloom(source, { &blurHalf, &blurFourth1, &blurFourth2 }, params.bloomIntensity_, tonemapping);
+    }
+
+    /**
+     *  CPU version of filmic.frag with the analytic curve, automatic exposure and LUTs are not supported.
+     *  @param source the HDR source image.
+     *  @param params the tone-mapping parameters.
+     */
+    CPUImage CPUPostProcessing::ApplyFilmicTonemapping(const CPUImage& source, const FilmicTMParameters& params) const
+    {
+        ENH_PROFILE_CPU("CPUFilmicTM");
+        CPUImage result{ source.GetWidth(), source.GetHeight() };
+        const FilmicCurve curve{ params };
+        ForEachTile(result.GetSize(), [&source, &result, &curve](const glm::uvec2& begin, const glm::uvec2& end) {
+            for (auto y = begin.y; y < end.y; ++y) {
+                const auto* sourceRow = source.GetRow(y);
+                auto* resultRow = result.GetRow(y);
+                auto x = begin.x;
+#ifdef __AVX__
+                // two pixels per register, the alpha lanes are blended back in.
+                const auto exposure = _mm256_set1_ps(curve.exposure_);
+                const auto a = _mm256_set1_ps(curve.a_);
+                const auto b = _mm256_set1_ps(curve.b_);
+                const auto cb = _mm256_set1_ps(curve.cb_);
+                const auto de = _mm256_set1_ps(curve.de_);
+                const auto df = _mm256_set1_ps(curve.df_);
+                const auto toeAngle = _mm256_set1_ps(curve.toeAngle_);
+                const auto scale = _mm256_set1_ps(curve.scale_);
+                for (; x + 1 < end.x; x += 2) {
+                    auto color = _mm256_loadu_ps(sourceRow + 4 * static_cast<std::size_t>(x));
+                    auto c = _mm256_mul_ps(color, exposure);
+                    auto ax = _mm256_mul_ps(a, c);
+                    auto numerator = _mm256_add_ps(_mm256_mul_ps(c, _mm256_add_ps(ax, cb)), de);
+                    auto denominator = _mm256_add_ps(_mm256_mul_ps(c, _mm256_add_ps(ax, b)), df);
+                    auto mapped = _mm256_mul_ps(_mm256_sub_ps(_mm256_div_ps(numerator, denominator), toeAngle), scale);
+                    _mm256_storeu_ps(resultRow + 4 * static_cast<std::size_t>(x), _mm256_blend_ps(mapped, color, 0x88));
+                }
+#endif
+                for (; x < end.x; ++x) curve.Tonemap(float4::Load(sourceRow + 4 * static_cast<std::size_t>(x))).Store(resultRow + 4 * static_cast<std::size_t>(x));
+            }
+        }, numThreads_);
+        return result;
+    }
+}
@@ -0,0 +1,47 @@
+/**
+ * @file   CPUPostProcessing.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the CPU versions of the bloom and tone-mapping passes.
+ */
+
+#pragma once
+
+#include "CPUImage.h"
+#include <array>
+
+namespace viscom::enh {
+
+    struct BloomParams;
+    struct FilmicTMParameters;
+
+    /**
+     * @brief  CPU reference of the bloom (fragment pipeline) and filmic tone-mapping shaders.
+     *
+     *  Each method mirrors one shader and samples like the GPU does (clamp to edge, linear filtering for texture()),
+     *  so results can be compared to downloaded GPU targets. The passes are tiled across threads, pixels are processed
+     *  with SSE and the tone-mapping curve with AVX when compiled for it. Images are processed without a GL context,
+     *  e.g. offline on HDR frames.
+     */
+    class CPUPostProcessing
+    {
+    public:
+        explicit CPUPostProcessing(unsigned int numThreads = 0) : numThreads_{ numThreads } {}
+
+        CPUImage GlareDetect(const CPUImage& source) const;
+        CPUImage DownsampleBloom(const CPUImage& source) const;
+        CPUImage BlurBloom(const CPUImage& source, float bloomWidth, bool horizontal) const;
+        CPUImage CombineBloom(const CPUImage& source, const std::array<const CPUImage*, 3>& blurred, float bloomIntensity,
+            const FilmicTMParameters* tonemapping = nullptr) const;
+        CPUImage ApplyBloom(const CPUImage& source, const BloomParams& params, const FilmicTMParameters* tonemapping = nullptr) const;
+        CPUImage ApplyFilmicTonemapping(const CPUImage& source, const FilmicTMParameters& params) const;
+
+        /** Sets the number of threads used (0 to use all hardware threads). */
+        void SetNumThreads(unsigned int numThreads) { numThreads_ = numThreads; }
+
+    private:
+        /** Holds the number of threads used. */
+        unsigned int numThreads_;
+    };
+}
@@ -7,15 +7,23 @@
  */
 
 #include "DepthOfField.h"
+#include "SeparableKernel.h"
 #include "core/gfx/FrameBuffer.h"
 #include "enh/ApplicationNodeBase.h"
+#include "enh/core/profiler.h"
+#include "enh/gfx/gl/GLBuffer.h"
 #include "enh/gfx/gl/GLTexture.h"
+#include "enh/gfx/gl/GLUniformBuffer.h"
+#include "enh/gfx/gl/ShaderBufferBindingPoints.h"
+#include "enh/gfx/gl/ShaderBufferObject.h"
+#include <glm/common.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <imgui.h>
 
 namespace viscom::enh {
 
     namespace dof {
+        /** The pass parameters, the frame buffers are acquired from the render target pool for the current frame. */
         struct DoFPassParams {
             GLuint colorTex_ = 0;
             GLuint depthTex_ = 1;
@@ -25,6 +33,11 @@ namespace viscom::enh {
             glm::vec2 cocParams_;
         };
 
+        /** The radius of the near CoC blur in low resolution texels (the tile size of tileMinMaxCoC.frag). */
+        constexpr std::size_t NEAR_COC_BLUR_RADIUS = 6;
+        /** The define selecting the number of taps of the near CoC blur. */
+        const std::string NEAR_COC_BLUR_TAPS = "NUM_TAPS " + std::to_string(SeparableKernel::GetNumTaps(NEAR_COC_BLUR_RADIUS));
+
         std::array<glm::vec3, 48> circleBokeh = {
             glm::vec3(1.000000f, 0.000000f, 2.0f),
             glm::vec3(0.707107f, 0.707107f, 2.0f),
@@ -81,23 +94,35 @@ namespace viscom::enh {
 
     DepthOfField::DepthOfField(ApplicationNodeBase* app) :
         app_{ app },
+        stateCache_{ app->GetGLStateCache() },
+        bokehUBO_{ std::make_unique<GLUniformBuffer>("dofBokehBuffer", sizeof(bokehTaps_), app->GetUBOBindingPoints()) },
+        nearCoCBlurUBO_{ std::make_unique<GLUniformBuffer>("blurKernelBuffer", sizeof(glm::vec4) * SeparableKernel::MAX_TAPS, app->GetUBOBindingPoints()) },
         cocQuad_{ "dof/coc.frag", app },
-        cocUniformIds_{ cocQuad_.GetGPUProgram()->GetUniformLocations({ "depthTex", "projParams", "cocParams" }) },
+        cocUniformIds_{ cocQuad_.GetProgram()->GetUniformLocations({ "depthTex", "projParams", "cocParams" }) },
         downsampleQuad_{ "dof/downsample.frag", app },
-        downsampleUniformIds_{ downsampleQuad_.GetGPUProgram()->GetUniformLocations({ "colorTex", "cocTex" }) },
-        tileMinMaxCoCQuad_{ FullscreenQuad{"dof/tileMinMaxXCoC.frag", "dof/tileMinMaxCoC.frag", std::vector<std::string>{ "HORIZONTAL" }, app},
-            FullscreenQuad{"dof/tileMinMaxYCoC.frag", "dof/tileMinMaxCoC.frag", std::vector<std::string>{ "VERTICAL" }, app} },
-        tileMinMaxCoCUniformIds_{ tileMinMaxCoCQuad_[0].GetGPUProgram()->GetUniformLocations({ "cocTex" }), 
-            tileMinMaxCoCQuad_[1].GetGPUProgram()->GetUniformLocations({ "cocTex" }) },
-        nearCoCBlurQuad_{ FullscreenQuad{"dof/nearCoCBlurX.frag", "dof/nearCoCBlur.frag", std::vector<std::string>{ "HORIZONTAL" }, app},
-            FullscreenQuad{ "dof/nearCoCBlurY.frag", "dof/nearCoCBlur.frag", std::vector<std::string>{ "VERTICAL" }, app } },
-        nearCoCBlurUniformIds_{ nearCoCBlurQuad_[0].GetGPUProgram()->GetUniformLocations({ "cocTex" }), nearCoCBlurQuad_[1].GetGPUProgram()->GetUniformLocations({ "cocTex" }) },
+        downsampleUniformIds_{ downsampleQuad_.GetProgram()->GetUniformLocations({ "colorTex", "cocTex" }) },
+        tileMinMaxCoCQuad_{ ScreenQuad{ "dof/tileMinMaxCoC.frag", std::vector<std::string>{ "HORIZONTAL" }, app},
+            ScreenQuad{ "dof/tileMinMaxCoC.frag", std::vector<std::string>{ "VERTICAL" }, app} },
+        tileMinMaxCoCUniformIds_{ tileMinMaxCoCQuad_[0].GetProgram()->GetUniformLocations({ "cocTex" }), 
+            tileMinMaxCoCQuad_[1].GetProgram()->GetUniformLocations({ "cocTex" }) },
+        nearCoCBlurQuad_{ ScreenQuad{ "dof/nearCoCBlur.frag", std::vector<std::string>{ "HORIZONTAL", dof::NEAR_COC_BLUR_TAPS }, app},
+            ScreenQuad{ "dof/nearCoCBlur.frag", std::vector<std::string>{ "VERTICAL", dof::NEAR_COC_BLUR_TAPS }, app } },
+        nearCoCBlurUniformIds_{ nearCoCBlurQuad_[0].GetProgram()->GetUniformLocations({ "cocTex" }), nearCoCBlurQuad_[1].GetProgram()->GetUniformLocations({ "cocTex" }) },
         dofQuad_{ "dof/dof.frag", app },
-        dofUniformIds_{ dofQuad_.GetGPUProgram()->GetUniformLocations({ "cocTex", "cocNearBlurTex", "colorTex", "colorMulCoCFarTex", "offsets" }) },
+        dofUniformIds_{ dofQuad_.GetProgram()->GetUniformLocations({ "cocTex", "cocNearBlurTex", "colorTex", "colorMulCoCFarTex" }) },
         fillQuad_{ "dof/fill.frag", app },
-        fillUniformIds_{ fillQuad_.GetGPUProgram()->GetUniformLocations({ "cocTex", "cocNearBlurTex", "dofNearTex", "dofFarTex" }) },
+        fillUniformIds_{ fillQuad_.GetProgram()->GetUniformLocations({ "cocTex", "cocNearBlurTex", "dofNearTex", "dofFarTex" }) },
         compositeQuad_{ "dof/composite.frag", app },
-        compositeUniformIds_{ compositeQuad_.GetGPUProgram()->GetUniformLocations({ "colorTex", "cocTex", "cocHalfTex", "cocNearBlurHalfTex", "dofNearHalfTex", "dofFarHalfTex", "hgTex" }) }
+        compositeUniformIds_{ compositeQuad_.GetProgram()->GetUniformLocations({ "colorTex", "cocTex", "cocHalfTex", "cocNearBlurHalfTex", "dofNearHalfTex", "dofFarHalfTex", "hgTex" }) },
+        tileClassifyProgram_{ std::make_unique<GLProgram>(std::vector<std::string>{ "dof/tileClassify.comp" }, app) },
+        tileClassifyUniformIds_{ tileClassifyProgram_->GetUniformLocations({ "maxTiles" }) },
+        tiledDoFPrograms_{ std::make_unique<GLProgram>(std::vector<std::string>{ "dof/dofTiled.comp" }, std::vector<std::string>{ "NEAR" }, app),
+            std::make_unique<GLProgram>(std::vector<std::string>{ "dof/dofTiled.comp" }, std::vector<std::string>{ "FAR" }, app),
+            std::make_unique<GLProgram>(std::vector<std::string>{ "dof/dofTiled.comp" }, std::vector<std::string>{ "NEAR", "FAR" }, app) },
+        tiledDoFUniformIds_{ tiledDoFPrograms_[0]->GetUniformLocations({ "tileListOffset" }),
+            tiledDoFPrograms_[1]->GetUniformLocations({ "tileListOffset" }),
+            tiledDoFPrograms_[2]->GetUniformLocations({ "tileListOffset" }) },
+        tileBuffer_{ std::make_unique<ShaderBufferObject>("dofTileBuffer", app->GetSSBOBindingPoints()) }
     {
         params_.focusZ_ = 12.0f;
         params_.imageDistance_ = 0.034f;
@@ -107,19 +132,16 @@ namespace viscom::enh {
         params_.bokehShape_ = 7;
         params_.rotateBokehMax_ = glm::pi<float>() / 3.0f;
 
-        FrameBufferDescriptor fullResRTDesc{ { FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGB32F) } }, {} }; // CoC near/far/depth
-        fullResRTs_ = app_->CreateOffscreenBuffers(fullResRTDesc);
+        app->GetSSBOBindingPoints()->BindStorageBufferBlock(tileClassifyProgram_->GetProgramId(), "dofTileBuffer");
+        app->GetUBOBindingPoints()->BindBufferBlock(dofQuad_.GetProgram()->GetProgramId(), "dofBokehBuffer");
+        for (const auto& program : tiledDoFPrograms_) {
+            app->GetSSBOBindingPoints()->BindStorageBufferBlock(program->GetProgramId(), "dofTileBuffer");
+            app->GetUBOBindingPoints()->BindBufferBlock(program->GetProgramId(), "dofBokehBuffer");
+        }
+        for (const auto& quad : nearCoCBlurQuad_) app->GetUBOBindingPoints()->BindBufferBlock(quad.GetProgram()->GetProgramId(), "blurKernelBuffer");
+        nearCoCBlurUBO_->UploadData(0, sizeof(glm::vec4) * SeparableKernel::MAX_TAPS, SeparableKernel::Box(dof::NEAR_COC_BLUR_RADIUS).GetTaps().data());
 
-        FrameBufferDescriptor lowResRTDesc{ {
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGB32F) }, // 0: color / nearFieldFill
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGB32F) }, // 1: colorMulCoCFar / farFieldFilled
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGB32F) }, // 2: nearField
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RGB32F) }, // 3: farField
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RG32F) }, // 4: CoC near/far
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RG32F) }, // 5: CoC near/far ping
-                FrameBufferTextureDescriptor{ static_cast<GLenum>(gl::GL_RG32F) } // 6: CoC near/far pong <- final
-            }, {} };
-        lowResRTs_ = app_->CreateOffscreenBuffers(lowResRTDesc, 2);
+        Resize();
 
         downsamplePassDrawBuffers_ = { 0, 1, 4 };
         tilePassDrawBuffers_[0] = { 5 };
@@ -128,7 +150,66 @@ namespace viscom::enh {
         fillPassDrawBuffers_ = { 0, 1 };
     }
 
-    DepthOfField::~DepthOfField() = default;
+    DepthOfField::~DepthOfField()
+    {
+        // the programs, uniform buffers and tile buffer are deleted with the effect.
+        stateCache_->Invalidate();
+    }
+
+    /**
+     *  Sets the precision of the render targets and recreates them.
+     *  The reduced precision uses R11G11B10F for the (positive) color targets and RG16F for the CoC targets. The full
+     *  resolution target keeps 32 bit floats as it holds the linear depth used for weighting the down sampling.
+     */
+    void DepthOfField::SetPrecision(RenderTargetPrecision precision)
+    {
+        if (precision_ == precision) return;
+        precision_ = precision;
+        Resize();
+    }
+
+    void DepthOfField::Resize()
+    {
+        auto colorFormat = precision_ == RenderTargetPrecision::FULL ? gl::GL_RGB32F : gl::GL_R11F_G11F_B10F;
+        auto cocFormat = precision_ == RenderTargetPrecision::FULL ? gl::GL_RG32F : gl::GL_RG16F;
+        // the tiled pipeline writes the near and far fields as images, RGB32F is no image format so full precision uses
+        // RGBA32F while R11G11B10F can be bound as an image directly.
+        fieldFormat_ = precision_ == RenderTargetPrecision::FULL ? gl::GL_RGBA32F : gl::GL_R11F_G11F_B10F;
+
+        // the full resolution target (CoC near/far/depth) is always RGB32F, the render targets are acquired each frame.
+        lowResFormats_ = {
+            colorFormat, // 0: color / nearFieldFill
+            colorFormat, // 1: colorMulCoCFar / farFieldFilled
+            fieldFormat_, // 2: nearField
+            fieldFormat_, // 3: farField
+            cocFormat, // 4: CoC near/far
+            cocFormat, // 5: CoC near/far ping
+            cocFormat // 6: CoC near/far pong <- final
+        };
+
+        // the tile lists are sized for the largest viewport on next use.
+        maxTiles_ = 0;
+    }
+
+    /** Grows the tile lists if the low resolution targets have more tiles than the lists can hold. */
+    void DepthOfField::ReserveTiles(const glm::uvec2& lowResSize)
+    {
+        auto tilesX = (lowResSize.x + TILE_SIZE - 1) / TILE_SIZE;
+        auto tilesY = (lowResSize.y + TILE_SIZE - 1) / TILE_SIZE;
+        if (tilesX * tilesY <= maxTiles_) return;
+
+        maxTiles_ = tilesX * tilesY;
+        tileBuffer_->GetBuffer()->InitializeData(3 * sizeof(glm::uvec4) + 3 * sizeof(std::uint32_t) * maxTiles_, nullptr);
+        // initializing the buffer changes the buffer binding.
+        stateCache_->Invalidate();
+    }
+
+    /** Returns the acquired targets to the render target pool. */
+    void DepthOfField::ReleaseTargets(const dof::DoFPassParams& passParams)
+    {
+        app_->GetRenderTargetPool()->Release(passParams.fullResRT_);
+        app_->GetRenderTargetPool()->Release(passParams.lowResRT_);
+    }
 
     void DepthOfField::RenderParameterSliders()
     {
@@ -141,38 +222,63 @@ namespace viscom::enh {
             if (ImGui::InputFloat("f-Stops Max", &params_.fStopsMax_, 0.1f)) recalcBokeh_ = true;
             if (ImGui::InputInt("Bokeh Shape", &params_.bokehShape_)) recalcBokeh_ = true;
             if (ImGui::InputFloat("Max Bokeh Rotation", &params_.rotateBokehMax_, 0.5f)) recalcBokeh_ = true;
+            auto precision = static_cast<int>(precision_);
+            if (ImGui::Combo("Precision", &precision, "Full (RGB32F/RG32F)\0Reduced (R11G11B10F/RG16F)\0")) SetPrecision(static_cast<RenderTargetPrecision>(precision));
+            auto pipeline = static_cast<int>(pipeline_);
+            if (ImGui::Combo("Pipeline", &pipeline, "Fragment\0Tiled Compute\0")) pipeline_ = static_cast<DoFPipeline>(pipeline);
+            ImGui::Text("GPU Time (Fragment): %.3f ms", GetGPUTime(DoFPipeline::FRAGMENT).count());
+            ImGui::Text("GPU Time (Tiled Compute): %.3f ms", GetGPUTime(DoFPipeline::TILED_COMPUTE).count());
             ImGui::TreePop();
         }
     }
 
-    void DepthOfField::RecalcBokeh()
+    /**
+     *  Shapes the bokeh tap sets. The sets with 8 and 24 taps use the inner rings of the 48 tap circle scaled to the
+     *  radius of the outer ring, so all sets cover the same area.
+     *  @param params the parameters defining the bokeh shape.
+     */
+    std::array<glm::vec4, 80> DepthOfField::CalculateBokehTaps(const DOFParams& params)
     {
-        auto f = (params_.fStops_ - params_.fStopsMax_) / (params_.fStopsMin_ - params_.fStopsMax_);
-        auto bokehRotation = f * params_.rotateBokehMax_;
-        auto N = static_cast<float>(params_.bokehShape_);
+        auto f = (params.fStops_ - params.fStopsMax_) / (params.fStopsMin_ - params.fStopsMax_);
+        auto bokehRotation = f * params.rotateBokehMax_;
+        auto N = static_cast<float>(params.bokehShape_);
         auto piDivN = glm::pi<float>() / N;
-        for (std::size_t i = 0; i < dof::circleBokeh.size(); ++i) {
-            float theta = glm::acos(dof::circleBokeh[i].x);
-            if (dof::circleBokeh[i].y < 0.0f) theta = glm::two_pi<float>() - theta;
+        auto shapeTap = [f, bokehRotation, N, piDivN](const glm::vec3& circleTap, float radiusScale) {
+            float theta = glm::acos(circleTap.x);
+            if (circleTap.y < 0.0f) theta = glm::two_pi<float>() - theta;
 
             float newTheta = theta + bokehRotation;
 
             float rScale = glm::cos(piDivN) / glm::cos(theta - 2.0f * piDivN * glm::floor((N * theta + glm::pi<float>()) / glm::two_pi<float>()));
-            float newR = dof::circleBokeh[i].z * glm::pow(rScale, f);
+            float newR = radiusScale * circleTap.z * glm::pow(rScale, f);
 
-            bokehTaps_[i] = newR * glm::vec2(glm::cos(newTheta), glm::sin(newTheta));
-        }
+            return glm::vec4(newR * glm::vec2(glm::cos(newTheta), glm::sin(newTheta)), 0.0f, 0.0f);
+        };
 
+        std::array<glm::vec4, 80> bokehTaps;
+        std::size_t tap = 0;
+        for (std::size_t i = 0; i < 8; ++i) bokehTaps[tap++] = shapeTap(dof::circleBokeh[i], 3.0f);
+        for (std::size_t i = 0; i < 24; ++i) bokehTaps[tap++] = shapeTap(dof::circleBokeh[i], 1.5f);
+        for (std::size_t i = 0; i < 48; ++i) bokehTaps[tap++] = shapeTap(dof::circleBokeh[i], 1.0f);
+        return bokehTaps;
+    }
+
+    /** Shapes the bokeh tap sets and uploads them. */
+    void DepthOfField::RecalcBokeh()
+    {
+        bokehTaps_ = CalculateBokehTaps(params_);
+        bokehUBO_->UploadData(0, sizeof(bokehTaps_), bokehTaps_.data());
         recalcBokeh_ = false;
     }
 
     void DepthOfField::CoCPass(const dof::DoFPassParams& passParams)
     {
+        ENH_PROFILE_GPU("DepthOfField/CoC");
+
         passParams.fullResRT_->DrawToFBO([this, &passParams]() {
-            gl::glUseProgram(cocQuad_.GetGPUProgram()->getProgramId());
+            stateCache_->UseProgram(cocQuad_.GetProgram()->GetProgramId());
 
-            gl::glActiveTexture(gl::GL_TEXTURE0);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.depthTex_);
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.depthTex_);
 
             gl::glUniform1i(cocUniformIds_[0], 0);
             gl::glUniform2fv(cocUniformIds_[1], 1, glm::value_ptr(passParams.projParams_));
@@ -183,13 +289,13 @@ namespace viscom::enh {
 
     void DepthOfField::DownsamplePass(const dof::DoFPassParams& passParams)
     {
+        ENH_PROFILE_GPU("DepthOfField/Downsample");
+
         passParams.lowResRT_->DrawToFBO(downsamplePassDrawBuffers_, [this, &passParams]() {
-            gl::glUseProgram(downsampleQuad_.GetGPUProgram()->getProgramId());
+            stateCache_->UseProgram(downsampleQuad_.GetProgram()->GetProgramId());
 
-            gl::glActiveTexture(gl::GL_TEXTURE0);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.colorTex_);
-            gl::glActiveTexture(gl::GL_TEXTURE1);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.fullResRT_->GetTextures()[0]);
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.colorTex_);
+            stateCache_->BindTexture(1, gl::GL_TEXTURE_2D, passParams.fullResRT_->GetTextures()[0]);
 
             gl::glUniform1i(downsampleUniformIds_[0], 0);
             gl::glUniform1i(downsampleUniformIds_[1], 1);
@@ -199,11 +305,12 @@ namespace viscom::enh {
 
     void DepthOfField::TileMinMaxPass(const dof::DoFPassParams& passParams, std::size_t pass, std::size_t sourceTex)
     {
+        ENH_PROFILE_GPU("DepthOfField/TileMinMax");
+
         passParams.lowResRT_->DrawToFBO(tilePassDrawBuffers_[pass], [this, &passParams, pass, sourceTex]() {
-            gl::glUseProgram(tileMinMaxCoCQuad_[pass].GetGPUProgram()->getProgramId());
+            stateCache_->UseProgram(tileMinMaxCoCQuad_[pass].GetProgram()->GetProgramId());
 
-            gl::glActiveTexture(gl::GL_TEXTURE0);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[sourceTex]);
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[sourceTex]);
 
             gl::glUniform1i(tileMinMaxCoCUniformIds_[pass][0], 0);
             tileMinMaxCoCQuad_[pass].Draw();
@@ -212,11 +319,13 @@ namespace viscom::enh {
 
     void DepthOfField::NearCoCBlurPass(const dof::DoFPassParams& passParams, std::size_t pass, std::size_t sourceTex)
     {
+        ENH_PROFILE_GPU("DepthOfField/NearCoCBlur");
+
         passParams.lowResRT_->DrawToFBO(tilePassDrawBuffers_[pass], [this, &passParams, pass, sourceTex]() {
-            gl::glUseProgram(nearCoCBlurQuad_[pass].GetGPUProgram()->getProgramId());
+            stateCache_->UseProgram(nearCoCBlurQuad_[pass].GetProgram()->GetProgramId());
+            nearCoCBlurUBO_->BindBuffer(stateCache_);
 
-            gl::glActiveTexture(gl::GL_TEXTURE0);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[sourceTex]);
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[sourceTex]);
 
             gl::glUniform1i(nearCoCBlurUniformIds_[pass][0], 0);
             nearCoCBlurQuad_[pass].Draw();
@@ -225,40 +334,88 @@ namespace viscom::enh {
 
     void DepthOfField::ComputeDoFPass(const dof::DoFPassParams& passParams)
     {
+        ENH_PROFILE_GPU("DepthOfField/ComputeDoF");
+
         passParams.lowResRT_->DrawToFBO(dofPassDrawBuffers_, [this, &passParams]() {
-            gl::glUseProgram(dofQuad_.GetGPUProgram()->getProgramId());
+            stateCache_->UseProgram(dofQuad_.GetProgram()->GetProgramId());
+            bokehUBO_->BindBuffer(stateCache_);
 
-            gl::glActiveTexture(gl::GL_TEXTURE0 + 0);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[4]);
-            gl::glActiveTexture(gl::GL_TEXTURE0 + 1);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[6]);
-            gl::glActiveTexture(gl::GL_TEXTURE0 + 2);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[0]);
-            gl::glActiveTexture(gl::GL_TEXTURE0 + 3);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[1]);
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[4]);
+            stateCache_->BindTexture(1, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[6]);
+            stateCache_->BindTexture(2, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[0]);
+            stateCache_->BindTexture(3, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[1]);
 
             gl::glUniform1i(dofUniformIds_[0], 0);
             gl::glUniform1i(dofUniformIds_[1], 1);
             gl::glUniform1i(dofUniformIds_[2], 2);
             gl::glUniform1i(dofUniformIds_[3], 3);
-            gl::glUniform2fv(dofUniformIds_[4], static_cast<gl::GLsizei>(bokehTaps_.size()), reinterpret_cast<float*>(bokehTaps_.data()));
             dofQuad_.Draw();
         });
     }
 
+    /**
+     *  Classifies the low resolution tiles into tiles with near field, far field or both and appends them to the
+     *  respective tile list. The indirect dispatch commands count the tiles of each list.
+     */
+    void DepthOfField::ClassifyTilesPass(const dof::DoFPassParams& passParams)
+    {
+        ENH_PROFILE_GPU("DepthOfField/ClassifyTiles");
+
+        const std::array<glm::uvec4, 3> emptyDispatches{ { glm::uvec4(0, 1, 1, 0), glm::uvec4(0, 1, 1, 0), glm::uvec4(0, 1, 1, 0) } };
+        tileBuffer_->GetBuffer()->UploadData(0, emptyDispatches);
+        tileBuffer_->BindBuffer(stateCache_);
+
+        stateCache_->UseProgram(tileClassifyProgram_->GetProgramId());
+        stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[4]);
+        stateCache_->BindTexture(1, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[6]);
+        gl::glUniform1ui(tileClassifyUniformIds_[0], maxTiles_);
+
+        auto tilesX = (static_cast<unsigned int>(passParams.lowResRT_->GetWidth()) + TILE_SIZE - 1) / TILE_SIZE;
+        auto tilesY = (static_cast<unsigned int>(passParams.lowResRT_->GetHeight()) + TILE_SIZE - 1) / TILE_SIZE;
+        gl::glDispatchCompute(tilesX, tilesY, 1);
+        gl::glMemoryBarrier(gl::GL_COMMAND_BARRIER_BIT | gl::GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    /**
+     *  Computes the near and far fields with one indirect dispatch per tile list. The fields are cleared first, so in
+     *  focus tiles and the field not present in a tile cost nothing.
+     */
+    void DepthOfField::TiledDoFPass(const dof::DoFPassParams& passParams)
+    {
+        ENH_PROFILE_GPU("DepthOfField/TiledDoF");
+
+        const auto& textures = passParams.lowResRT_->GetTextures();
+        gl::glClearTexImage(textures[2], 0, gl::GL_RGBA, gl::GL_FLOAT, nullptr);
+        gl::glClearTexImage(textures[3], 0, gl::GL_RGBA, gl::GL_FLOAT, nullptr);
+
+        stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, textures[4]);
+        stateCache_->BindTexture(1, gl::GL_TEXTURE_2D, textures[6]);
+        stateCache_->BindTexture(2, gl::GL_TEXTURE_2D, textures[0]);
+        stateCache_->BindTexture(3, gl::GL_TEXTURE_2D, textures[1]);
+        gl::glBindImageTexture(0, textures[2], 0, gl::GL_FALSE, 0, gl::GL_WRITE_ONLY, fieldFormat_);
+        gl::glBindImageTexture(1, textures[3], 0, gl::GL_FALSE, 0, gl::GL_WRITE_ONLY, fieldFormat_);
+        stateCache_->BindBuffer(gl::GL_DISPATCH_INDIRECT_BUFFER, tileBuffer_->GetBuffer()->GetBuffer());
+        bokehUBO_->BindBuffer(stateCache_);
+
+        for (std::size_t i = 0; i < tiledDoFPrograms_.size(); ++i) {
+            stateCache_->UseProgram(tiledDoFPrograms_[i]->GetProgramId());
+            gl::glUniform1ui(tiledDoFUniformIds_[i][0], static_cast<gl::GLuint>(i) * maxTiles_);
+            gl::glDispatchComputeIndirect(static_cast<gl::GLintptr>(i * sizeof(glm::uvec4)));
+        }
+        gl::glMemoryBarrier(gl::GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+
     void DepthOfField::FillPass(const dof::DoFPassParams& passParams)
     {
+        ENH_PROFILE_GPU("DepthOfField/Fill");
+
         passParams.lowResRT_->DrawToFBO(fillPassDrawBuffers_, [this, &passParams]() {
-            gl::glUseProgram(fillQuad_.GetGPUProgram()->getProgramId());
+            stateCache_->UseProgram(fillQuad_.GetProgram()->GetProgramId());
 
-            gl::glActiveTexture(gl::GL_TEXTURE0 + 0);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[4]);
-            gl::glActiveTexture(gl::GL_TEXTURE0 + 1);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[6]);
-            gl::glActiveTexture(gl::GL_TEXTURE0 + 2);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[2]);
-            gl::glActiveTexture(gl::GL_TEXTURE0 + 3);
-            gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[3]);
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[4]);
+            stateCache_->BindTexture(1, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[6]);
+            stateCache_->BindTexture(2, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[2]);
+            stateCache_->BindTexture(3, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[3]);
 
             gl::glUniform1i(fillUniformIds_[0], 0);
             gl::glUniform1i(fillUniformIds_[1], 1);
@@ -270,21 +427,17 @@ namespace viscom::enh {
 
     void DepthOfField::CompositePass(const dof::DoFPassParams& passParams)
     {
-        gl::glUseProgram(compositeQuad_.GetGPUProgram()->getProgramId());
-
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 0);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.colorTex_);
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 1);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.fullResRT_->GetTextures()[0]);
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 2);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[4]);
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 3);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[6]);
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 4);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[0]);
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 5);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[1]);
-        app_->GetCubicWeightsTexture().ActivateTexture(gl::GL_TEXTURE0 + 6);
+        ENH_PROFILE_GPU("DepthOfField/Composite");
+
+        stateCache_->UseProgram(compositeQuad_.GetProgram()->GetProgramId());
+
+        stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, passParams.colorTex_);
+        stateCache_->BindTexture(1, gl::GL_TEXTURE_2D, passParams.fullResRT_->GetTextures()[0]);
+        stateCache_->BindTexture(2, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[4]);
+        stateCache_->BindTexture(3, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[6]);
+        stateCache_->BindTexture(4, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[0]);
+        stateCache_->BindTexture(5, gl::GL_TEXTURE_2D, passParams.lowResRT_->GetTextures()[1]);
+        app_->GetCubicWeightsTexture().ActivateTexture(stateCache_, 6);
 
         gl::glUniform1i(compositeUniformIds_[0], 0);
         gl::glUniform1i(compositeUniformIds_[1], 1);
@@ -296,27 +449,50 @@ namespace viscom::enh {
         compositeQuad_.Draw();
     }
 
-    void DepthOfField::ApplyEffectInternal(dof::DoFPassParams& passParams, const CameraHelper& cam, float resX, GLuint colorTex, GLuint depthTex)
+    /**
+     *  Calculates the parameters of the CoC from the lens parameters.
+     *  @param params the lens parameters.
+     *  @param projection the projection matrix of the camera.
+     *  @param height the height of the target in pixels.
+     */
+    DoFCoCParams DepthOfField::CalculateCoCParams(const DOFParams& params, const glm::mat4& projection, unsigned int height)
     {
-        passParams.colorTex_ = colorTex;
-        passParams.depthTex_ = depthTex;
-        passParams.fullResRT_ = app_->SelectOffscreenBuffer(fullResRTs_);
-        passParams.lowResRT_ = app_->SelectOffscreenBuffer(lowResRTs_);
-        passParams.projParams_.x = cam.GetPerspectiveMatrix()[2][2];
-        passParams.projParams_.y = cam.GetPerspectiveMatrix()[3][2];
+        DoFCoCParams result;
+        result.projParams_.x = projection[2][2];
+        result.projParams_.y = projection[3][2];
 
         // see https://stackoverflow.com/questions/6652253/getting-the-true-z-value-from-the-depth-buffer
         // linear solution should be: -B / (z_n + A)
         // also https://developer.nvidia.com/gpugems/GPUGems/gpugems_ch23.html
         // and http://www.crytek.com/download/Sousa_Graphics_Gems_CryENGINE3.pdf
 
-        auto cocPixelFactor = resX / 0.035f;
-        float F = (params_.imageDistance_ * params_.focusZ_) / (params_.imageDistance_ + params_.focusZ_);
-        float A = F / params_.fStops_;
-        float cocDiv = passParams.projParams_.y * (params_.focusZ_ - F);
-        float cocBias = A * F * ((params_.focusZ_ * passParams.projParams_.x) - passParams.projParams_.y);
-        passParams.cocParams_.x = cocPixelFactor * (A * F * params_.focusZ_) / cocDiv; // coc scale
-        passParams.cocParams_.y = cocPixelFactor * cocBias / cocDiv; // coc bias
+        auto cocPixelFactor = static_cast<float>(height) / 0.035f;
+        float F = (params.imageDistance_ * params.focusZ_) / (params.imageDistance_ + params.focusZ_);
+        float A = F / params.fStops_;
+        float cocDiv = result.projParams_.y * (params.focusZ_ - F);
+        float cocBias = A * F * ((params.focusZ_ * result.projParams_.x) - result.projParams_.y);
+        result.cocParams_.x = cocPixelFactor * (A * F * params.focusZ_) / cocDiv; // coc scale
+        result.cocParams_.y = cocPixelFactor * cocBias / cocDiv; // coc bias
+        return result;
+    }
+
+    /**
+     *  Runs the passes before compositing.
+     *  @param size the size of the target the result is composited into.
+     */
+    void DepthOfField::ApplyEffectInternal(dof::DoFPassParams& passParams, const CameraHelper& cam, const glm::uvec2& size, GLuint colorTex, GLuint depthTex)
+    {
+        stateCache_->InvalidateExternalState();
+
+        passParams.colorTex_ = colorTex;
+        passParams.depthTex_ = depthTex;
+        auto lowResSize = glm::max(size / 2u, glm::uvec2(1));
+        passParams.fullResRT_ = app_->GetRenderTargetPool()->Acquire(size, { gl::GL_RGB32F });
+        passParams.lowResRT_ = app_->GetRenderTargetPool()->Acquire(lowResSize, lowResFormats_);
+        if (pipeline_ == DoFPipeline::TILED_COMPUTE) ReserveTiles(lowResSize);
+        auto cocParams = CalculateCoCParams(params_, cam.GetPerspectiveMatrix(), size.y);
+        passParams.projParams_ = cocParams.projParams_;
+        passParams.cocParams_ = cocParams.cocParams_;
 
         if (recalcBokeh_) RecalcBokeh();
 
@@ -330,24 +506,42 @@ namespace viscom::enh {
         NearCoCBlurPass(passParams, 0, 6); // blur near x pass
         NearCoCBlurPass(passParams, 1, 5); // blur near y pass
 
-        ComputeDoFPass(passParams);
+        if (pipeline_ == DoFPipeline::TILED_COMPUTE) {
+            ClassifyTilesPass(passParams);
+            TiledDoFPass(passParams);
+        }
+        else ComputeDoFPass(passParams);
 
         FillPass(passParams);
     }
 
     void DepthOfField::ApplyEffect(const CameraHelper& cam, GLuint colorTex, GLuint depthTex, const FrameBuffer* targetFBO, std::size_t drawBufferIndex)
     {
+        ENH_PROFILE_CPU("DepthOfField");
+        ENH_PROFILE_GPU("DepthOfField");
+
+        auto& timer = timers_[static_cast<std::size_t>(pipeline_)];
+        timer.Begin();
         dof::DoFPassParams passParams;
-        ApplyEffectInternal(passParams, cam, static_cast<float>(targetFBO->GetHeight()), colorTex, depthTex);
+        ApplyEffectInternal(passParams, cam, glm::uvec2(targetFBO->GetWidth(), targetFBO->GetHeight()), colorTex, depthTex);
 
         targetFBO->DrawToFBO(std::vector<std::size_t>{drawBufferIndex}, [this, &passParams]() { CompositePass(passParams); });
+        ReleaseTargets(passParams);
+        timer.End();
     }
 
     void DepthOfField::ApplyEffect(const CameraHelper & cam, GLuint colorTex, GLuint depthTex, const FrameBuffer * targetFBO)
     {
+        ENH_PROFILE_CPU("DepthOfField");
+        ENH_PROFILE_GPU("DepthOfField");
+
+        auto& timer = timers_[static_cast<std::size_t>(pipeline_)];
+        timer.Begin();
         dof::DoFPassParams passParams;
-        ApplyEffectInternal(passParams, cam, static_cast<float>(targetFBO->GetHeight()), colorTex, depthTex);
+        ApplyEffectInternal(passParams, cam, glm::uvec2(targetFBO->GetWidth(), targetFBO->GetHeight()), colorTex, depthTex);
 
         targetFBO->DrawToFBO([this, &passParams]() { CompositePass(passParams); });
+        ReleaseTargets(passParams);
+        timer.End();
     }
 }
@@ -8,16 +8,19 @@
 
 #pragma once
 
-#include "core/gfx/FullscreenQuad.h"
+#include "enh/gfx/gl/ScreenQuad.h"
+#include "enh/gfx/gl/GLTimerQuery.h"
+#include "enh/gfx/postprocessing/RenderTargetPrecision.h"
 #include <array>
 #include <cereal/access.hpp>
 #include <cereal/cereal.hpp>
 #include <glbinding/gl/gl.h>
+#include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
 #include <memory>
 
 namespace viscom {
-    class GPUProgram;
     class CameraHelper;
     class FrameBuffer;
 }
@@ -25,12 +28,24 @@ namespace viscom {
 namespace viscom::enh {
 
     class ApplicationNodeBase;
+    class GLStateCache;
     class GLTexture;
+    class GLUniformBuffer;
+    class ShaderBufferObject;
 
     namespace dof {
         struct DoFPassParams;
     }
 
+    /** The implementations of the pass computing the near and far fields. */
+    enum class DoFPipeline
+    {
+        /** A full screen fragment pass over all low resolution pixels. */
+        FRAGMENT,
+        /** Compute passes over tiles classified by their CoC, in focus tiles are skipped. */
+        TILED_COMPUTE
+    };
+
     struct DOFParams
     {
         float focusZ_;
@@ -52,6 +67,15 @@ namespace viscom::enh {
         }
     };
 
+    /** The parameters of the CoC calculation in coc.frag. */
+    struct DoFCoCParams
+    {
+        /** Holds the projection matrix entries to reconstruct the view space depth. */
+        glm::vec2 projParams_;
+        /** Holds the scale and bias of the CoC. */
+        glm::vec2 cocParams_;
+    };
+
     class DepthOfField
     {
     public:
@@ -61,6 +85,17 @@ namespace viscom::enh {
         void RenderParameterSliders();
         void ApplyEffect(const CameraHelper& cam, GLuint colorTex, GLuint depthTex, const FrameBuffer* targetFBO, std::size_t drawBufferIndex);
         void ApplyEffect(const CameraHelper& cam, GLuint colorTex, GLuint depthTex, const FrameBuffer* targetFBO);
+        void Resize();
+        void SetPrecision(RenderTargetPrecision precision);
+        RenderTargetPrecision GetPrecision() const { return precision_; }
+        const DOFParams& GetParameters() const { return params_; }
+        void SetPipeline(DoFPipeline pipeline) { pipeline_ = pipeline; }
+        DoFPipeline GetPipeline() const { return pipeline_; }
+        /** Returns the last GPU time measured for a pipeline (including the composite pass). */
+        std::chrono::duration<double, std::milli> GetGPUTime(DoFPipeline pipeline) const { return timers_[static_cast<std::size_t>(pipeline)].GetLastTime(); }
+
+        static DoFCoCParams CalculateCoCParams(const DOFParams& params, const glm::mat4& projection, unsigned int height);
+        static std::array<glm::vec4, 80> CalculateBokehTaps(const DOFParams& params);
 
         template<class Archive> void SaveParameters(Archive& ar, const std::uint32_t) const {
             ar(cereal::make_nvp("params", params_));
@@ -71,57 +106,87 @@ namespace viscom::enh {
         }
 
     private:
-        void ApplyEffectInternal(dof::DoFPassParams& passParams, const CameraHelper& cam, float resX, GLuint colorTex, GLuint depthTex);
+        void ApplyEffectInternal(dof::DoFPassParams& passParams, const CameraHelper& cam, const glm::uvec2& size, GLuint colorTex, GLuint depthTex);
+        void ReleaseTargets(const dof::DoFPassParams& passParams);
+        void ReserveTiles(const glm::uvec2& lowResSize);
         void RecalcBokeh();
         void CoCPass(const dof::DoFPassParams& passParams);
         void DownsamplePass(const dof::DoFPassParams& passParams);
         void TileMinMaxPass(const dof::DoFPassParams& passParams, std::size_t pass, std::size_t sourceTex);
         void NearCoCBlurPass(const dof::DoFPassParams& passParams, std::size_t pass, std::size_t sourceTex);
         void ComputeDoFPass(const dof::DoFPassParams& passParams);
+        void ClassifyTilesPass(const dof::DoFPassParams& passParams);
+        void TiledDoFPass(const dof::DoFPassParams& passParams);
         void FillPass(const dof::DoFPassParams& passParams);
         void CompositePass(const dof::DoFPassParams& passParams);
 
         /** Holds the base application object. */
         ApplicationNodeBase* app_;
-
-        /** Holds the frame buffer with the full resolution render targets. */
-        std::vector<FrameBuffer> fullResRTs_;
-        /** Holds the frame buffer with the low resolution render targets. */
-        std::vector<FrameBuffer> lowResRTs_;
+        /** Holds the OpenGL state cache. */
+        GLStateCache* stateCache_;
 
         /** Holds the bloom parameters. */
         DOFParams params_;
-        /** Holds the filter taps for the bokeh shape. */
-        std::array<glm::vec2, 48> bokehTaps_;
+        /** Holds the precision of the render targets. */
+        RenderTargetPrecision precision_ = RenderTargetPrecision::FULL;
+        /** Holds the format of the near and far field targets. */
+        gl::GLenum fieldFormat_ = gl::GL_RGBA32F;
+        /** Holds the formats of the low resolution targets acquired from the render target pool. */
+        std::vector<gl::GLenum> lowResFormats_;
+        /** Holds the pipeline used for computing the near and far fields. */
+        DoFPipeline pipeline_ = DoFPipeline::FRAGMENT;
+        /** Holds the GPU timers for each pipeline. */
+        std::array<GLTimerQuery, 2> timers_;
+        /** Holds the filter tap sets (8, 24 and 48 taps) for the bokeh shape, padded to std140 array elements. */
+        std::array<glm::vec4, 80> bokehTaps_;
+        /** Holds the uniform buffer for the bokeh taps. */
+        std::unique_ptr<GLUniformBuffer> bokehUBO_;
+        /** Holds the uniform buffer with the box filter of the near CoC blur. */
+        std::unique_ptr<GLUniformBuffer> nearCoCBlurUBO_;
         /** Holds whether the bokeh taps need recalculation. */
         bool recalcBokeh_ = true;
 
         /** Holds the quad for calculating the CoC. */
-        FullscreenQuad cocQuad_;
+        ScreenQuad cocQuad_;
         /** Holds the CoC program uniform ids. */
         std::vector<gl::GLint> cocUniformIds_;
         /** Holds the quad for down sampling the textures. */
-        FullscreenQuad downsampleQuad_;
+        ScreenQuad downsampleQuad_;
         /** Holds the down sampling program uniform ids. */
         std::vector<gl::GLint> downsampleUniformIds_;
         /** Holds the quad for calculating the tile horizontal and vertical min/max CoC. */
-        std::array<FullscreenQuad, 2> tileMinMaxCoCQuad_;
+        std::array<ScreenQuad, 2> tileMinMaxCoCQuad_;
         /** Holds the tile horizontal and vertical min/max CoC program uniform ids. */
         std::array<std::vector<gl::GLint>, 2> tileMinMaxCoCUniformIds_;
         /** Holds the quad for blurring the near field CoC. */
-        std::array<FullscreenQuad, 2> nearCoCBlurQuad_;
+        std::array<ScreenQuad, 2> nearCoCBlurQuad_;
         /** Holds the near CoC blur program uniform ids. */
         std::array<std::vector<gl::GLint>, 2> nearCoCBlurUniformIds_;
         /** Holds the quad for calculating DoF effect. */
-        FullscreenQuad dofQuad_;
+        ScreenQuad dofQuad_;
         /** Holds the computation program uniform ids. */
         std::vector<gl::GLint> dofUniformIds_;
         /** Holds the quad for calculating the CoC. */
-        FullscreenQuad fillQuad_;
+        ScreenQuad fillQuad_;
         /** Holds the fill program uniform ids. */
         std::vector<gl::GLint> fillUniformIds_;
+
+        /** The size of the low resolution tiles classified for the tiled pipeline. */
+        static constexpr unsigned int TILE_SIZE = 8;
+        /** Holds the program classifying the tiles. */
+        std::unique_ptr<GLProgram> tileClassifyProgram_;
+        /** Holds the tile classification program uniform ids. */
+        std::vector<gl::GLint> tileClassifyUniformIds_;
+        /** Holds the programs for tiles with near field, far field and both. */
+        std::array<std::unique_ptr<GLProgram>, 3> tiledDoFPrograms_;
+        /** Holds the tiled program uniform ids. */
+        std::array<std::vector<gl::GLint>, 3> tiledDoFUniformIds_;
+        /** Holds the indirect dispatch commands and tile lists of the tile classes. */
+        std::unique_ptr<ShaderBufferObject> tileBuffer_;
+        /** Holds the maximum number of tiles in each list. */
+        unsigned int maxTiles_ = 0;
         /** Holds the quad for combining near and far field again. */
-        FullscreenQuad compositeQuad_;
+        ScreenQuad compositeQuad_;
         /** Holds the composite program uniform ids. */
         std::vector<gl::GLint> compositeUniformIds_;
 
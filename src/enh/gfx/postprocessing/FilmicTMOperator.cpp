@@ -7,17 +7,43 @@
  */
 
 #include "FilmicTMOperator.h"
+#include "AutoExposure.h"
 #include "enh/ApplicationNodeBase.h"
+#include "enh/core/profiler.h"
 #include "core/gfx/FrameBuffer.h"
 #include "enh/gfx/gl/GLUniformBuffer.h"
 #include "enh/gfx/gl/GLTexture.h"
+#include "enh/gfx/gl/ScreenQuad.h"
+#include <glm/common.hpp>
+#include <glm/exponential.hpp>
 #include <imgui.h>
+#include <algorithm>
+#include <fstream>
+#include <thread>
 
 namespace viscom::enh {
 
+    namespace {
+        /** The log2 luminance range covered by the LUT, see LUT_MIN_LOG and LUT_MAX_LOG in filmicCurve.glsl. */
+        constexpr float lutMinLog = -12.0f;
+        constexpr float lutMaxLog = 6.0f;
+
+        /** Returns whether two parameter sets result in the same curve (the exposure is applied before the LUT). */
+        bool IsSameCurve(const FilmicTMParameters& p0, const FilmicTMParameters& p1)
+        {
+            return p0.sStrength_ == p1.sStrength_ && p0.linStrength_ == p1.linStrength_ && p0.linAngle_ == p1.linAngle_
+                && p0.toeStrength_ == p1.toeStrength_ && p0.toeNumerator_ == p1.toeNumerator_
+                && p0.toeDenominator_ == p1.toeDenominator_ && p0.white_ == p1.white_;
+        }
+    }
+
     FilmicTMOperator::FilmicTMOperator(ApplicationNodeBase* app) :
-        renderable_(app->CreateFullscreenQuad("tm/filmic.frag")),
-        uniformIds_(renderable_->GetGPUProgram()->GetUniformLocations({ "sourceTex" })),
+        app_(app),
+        stateCache_(app->GetGLStateCache()),
+        renderables_{ std::make_unique<ScreenQuad>("tm/filmic.frag", app),
+            std::make_unique<ScreenQuad>("tm/filmic.frag", std::vector<std::string>{ "AUTO_EXPOSURE" }, app),
+            std::make_unique<ScreenQuad>("tm/filmic.frag", std::vector<std::string>{ "LUT" }, app),
+            std::make_unique<ScreenQuad>("tm/filmic.frag", std::vector<std::string>{ "LUT", "AUTO_EXPOSURE" }, app) },
         filmicUBO_(std::make_unique<GLUniformBuffer>("filmicBuffer", sizeof(FilmicTMParameters), app->GetUBOBindingPoints()))
     {
         params_.sStrength_ = 0.15f;
@@ -29,7 +55,10 @@ namespace viscom::enh {
         params_.white_ = 11.2f;
         params_.exposure_ = 2.0f;
 
-        app->GetUBOBindingPoints()->BindBufferBlock(renderable_->GetGPUProgram()->getProgramId(), "filmicBuffer");
+        for (std::size_t i = 0; i < renderables_.size(); ++i) {
+            uniformIds_[i] = renderables_[i]->GetProgram()->GetUniformLocations({ "sourceTex", "lutTex" });
+            RegisterProgram(renderables_[i]->GetProgram()->GetProgramId(), i);
+        }
 
         // Alternative values:
         /*params.sStrength = 0.22f;
@@ -42,8 +71,12 @@ namespace viscom::enh {
         params.exposure = 2.0f;*/
     }
 
-    /** Default destructor. */
-    FilmicTMOperator::~FilmicTMOperator() = default;
+    /** Destructor, forgets the cached bindings of the deleted objects. */
+    FilmicTMOperator::~FilmicTMOperator()
+    {
+        // the programs, the LUT texture and the parameter buffer are deleted with the operator.
+        stateCache_->Invalidate();
+    }
 
     void FilmicTMOperator::RenderParameterSliders()
     {
@@ -56,22 +89,68 @@ namespace viscom::enh {
             ImGui::InputFloat("Toe Numerator", &params_.toeNumerator_, 0.01f);
             ImGui::InputFloat("Toe Denominator", &params_.toeDenominator_, 0.1f);
             ImGui::InputFloat("White", &params_.white_, 0.1f);
+            auto mode = static_cast<int>(mode_);
+            if (ImGui::Combo("Evaluation", &mode, "Analytic\0LUT\0")) mode_ = static_cast<FilmicTMMode>(mode);
+            auto lutSizeIndex = lutSize_ == 64 ? 1 : 0;
+            if (ImGui::Combo("LUT Size", &lutSizeIndex, "32\00064\0")) SetLUTSize(lutSizeIndex == 1 ? 64 : 32);
             ImGui::TreePop();
         }
     }
 
     void FilmicTMOperator::ApplyTonemappingInternal(GLuint sourceTex)
     {
-        filmicUBO_->UploadData(0, sizeof(FilmicTMParameters), &params_);
-        filmicUBO_->BindBuffer();
+        ENH_PROFILE_CPU("FilmicTM");
+        ENH_PROFILE_GPU("FilmicTM");
+
+        stateCache_->InvalidateExternalState();
+        PrepareTonemapping(1);
+
+        auto variant = GetVariant();
+        stateCache_->UseProgram(renderables_[variant]->GetProgram()->GetProgramId());
+        stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, sourceTex);
+        gl::glUniform1i(uniformIds_[variant][0], 0);
+        if (mode_ == FilmicTMMode::LUT) gl::glUniform1i(uniformIds_[variant][1], 1);
+        renderables_[variant]->Draw();
+        stateCache_->UseProgram(0);
+    }
 
-        gl::glUseProgram(renderable_->GetGPUProgram()->getProgramId());
+    /**
+     *  Returns the defines a shader including tm/filmicCurve.glsl needs for a variant.
+     *  @param variant the variant as returned by GetVariant().
+     */
+    std::vector<std::string> FilmicTMOperator::GetVariantDefines(std::size_t variant)
+    {
+        std::vector<std::string> defines;
+        if (variant & 2) defines.emplace_back("LUT");
+        if (variant & 1) defines.emplace_back("AUTO_EXPOSURE");
+        return defines;
+    }
 
-        gl::glActiveTexture(gl::GL_TEXTURE0 + 0);
-        gl::glBindTexture(gl::GL_TEXTURE_2D, sourceTex);
-        gl::glUniform1i(uniformIds_[0], 0);
-        renderable_->Draw();
-        gl::glUseProgram(0);
+    /**
+     *  Binds the buffer blocks of a program including tm/filmicCurve.glsl, this is needed once after linking.
+     *  @param program the program.
+     *  @param variant the variant the program was compiled for.
+     */
+    void FilmicTMOperator::RegisterProgram(gl::GLuint program, std::size_t variant) const
+    {
+        app_->GetUBOBindingPoints()->BindBufferBlock(program, "filmicBuffer");
+        if (variant & 1) app_->GetSSBOBindingPoints()->BindStorageBufferBlock(program, "exposureBuffer");
+    }
+
+    /**
+     *  Uploads the parameters and binds the buffers and the LUT used by tm/filmicCurve.glsl for the current variant.
+     *  This may bake the LUT, so call it before binding other state. The caller sets the lutTex uniform in LUT mode.
+     *  @param lutTextureUnit the texture unit to bind the LUT to.
+     */
+    void FilmicTMOperator::PrepareTonemapping(gl::GLuint lutTextureUnit)
+    {
+        filmicUBO_->UploadData(0, sizeof(FilmicTMParameters), &params_);
+        filmicUBO_->BindBuffer(stateCache_);
+        if (autoExposure_) autoExposure_->BindExposureBuffer();
+        if (mode_ == FilmicTMMode::LUT) {
+            UpdateLUT();
+            lut_->ActivateTexture(stateCache_, lutTextureUnit);
+        }
     }
 
     void FilmicTMOperator::ApplyTonemapping(GLuint sourceTex, const FrameBuffer* fbo, std::size_t drawBufferIndex)
@@ -83,4 +162,104 @@ namespace viscom::enh {
     {
         fbo->DrawToFBO([this, sourceTex]() { ApplyTonemappingInternal(sourceTex); });
     }
+
+    /** Sets the LUT size (32 or 64 are sensible sizes), the LUT is baked again on next use. */
+    void FilmicTMOperator::SetLUTSize(unsigned int size)
+    {
+        if (lutSize_ == size) return;
+        lutSize_ = size;
+        lutDirty_ = true;
+    }
+
+    /**
+     *  Sets a color grading that is baked into the LUT after the tone-mapping curve.
+     *  @param colorGrading maps a tone-mapped color in [0, 1] to the graded color (may be empty), it is called from
+     *  several threads while baking.
+     */
+    void FilmicTMOperator::SetColorGrading(std::function<glm::vec3(const glm::vec3&)> colorGrading)
+    {
+        colorGrading_ = std::move(colorGrading);
+        lutDirty_ = true;
+    }
+
+    /** CPU version of the curve in filmic.frag for an exposed color. */
+    glm::vec3 FilmicTMOperator::EvaluateCurve(const glm::vec3& color) const
+    {
+        auto uncharted2Tonemap = [this](const glm::vec3& x) {
+            auto Ax = params_.sStrength_ * x;
+            auto toeAngle = params_.toeNumerator_ / params_.toeDenominator_;
+            return ((x * (Ax + params_.linAngle_ * params_.linStrength_) + params_.toeStrength_ * params_.toeNumerator_)
+                / (x * (Ax + params_.linStrength_) + params_.toeStrength_ * params_.toeDenominator_)) - toeAngle;
+        };
+
+        auto curr = 2.0f * uncharted2Tonemap(color);
+        auto whiteScale = 1.0f / uncharted2Tonemap(glm::vec3(params_.white_));
+        return curr * whiteScale;
+    }
+
+    /**
+     *  Bakes the curve and color grading into the LUT if the curve parameters changed. The LUT is indexed by the
+     *  log2 of the exposed color in [lutMinLog, lutMaxLog], the first entry holds the value for black.
+     *  The slices are baked in parallel.
+     */
+    void FilmicTMOperator::UpdateLUT()
+    {
+        if (!lutDirty_ && lut_ && IsSameCurve(params_, lutParams_)) return;
+        ENH_PROFILE_CPU("FilmicTM/BakeLUT");
+
+        lutData_.resize(static_cast<std::size_t>(lutSize_) * lutSize_ * lutSize_);
+        auto decode = [this](unsigned int i) {
+            if (i == 0) return 0.0f;
+            return glm::exp2(lutMinLog + (lutMaxLog - lutMinLog) * static_cast<float>(i) / static_cast<float>(lutSize_ - 1));
+        };
+        auto bakeSlices = [this, &decode](unsigned int firstSlice, unsigned int step) {
+            for (auto b = firstSlice; b < lutSize_; b += step) {
+                for (unsigned int g = 0; g < lutSize_; ++g) {
+                    for (unsigned int r = 0; r < lutSize_; ++r) {
+                        auto color = glm::clamp(EvaluateCurve(glm::vec3(decode(r), decode(g), decode(b))), 0.0f, 1.0f);
+                        if (colorGrading_) color = colorGrading_(color);
+                        lutData_[(static_cast<std::size_t>(b) * lutSize_ + g) * lutSize_ + r] = color;
+                    }
+                }
+            }
+        };
+
+        auto numThreads = std::max(std::min(std::thread::hardware_concurrency(), lutSize_), 1u);
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < numThreads; ++i) threads.emplace_back(bakeSlices, i, numThreads);
+        bakeSlices(0, numThreads);
+        for (auto& thread : threads) thread.join();
+
+        if (!lut_ || lut_->GetDimensions().x != lutSize_) {
+            lut_ = std::make_unique<GLTexture>(lutSize_, lutSize_, lutSize_, 1, TextureDescriptor{ 6, gl::GL_RGB16F, gl::GL_RGB, gl::GL_FLOAT }, lutData_.data());
+        }
+        else lut_->SetData(lutData_.data());
+        // creating and uploading the texture changes the texture bindings.
+        stateCache_->Invalidate();
+
+        lutParams_ = params_;
+        lutDirty_ = false;
+    }
+
+    /**
+     *  Exports the LUT as .cube file. The input of the LUT is log2 shaped, so it can only be applied offline to
+     *  exposed colors encoded the same way (see the header of the file).
+     *  @param filename the file to write.
+     *  @return whether the file could be written.
+     */
+    bool FilmicTMOperator::ExportLUT(const std::string& filename)
+    {
+        UpdateLUT();
+
+        std::ofstream cubeFile(filename);
+        if (!cubeFile) return false;
+
+        cubeFile << "TITLE \"filmic tone-mapping\"\n";
+        cubeFile << "# input: (log2(exposure * color) - (" << lutMinLog << ")) / " << (lutMaxLog - lutMinLog) << ", black maps to 0\n";
+        cubeFile << "LUT_3D_SIZE " << lutSize_ << "\n";
+        cubeFile << "DOMAIN_MIN 0.0 0.0 0.0\n";
+        cubeFile << "DOMAIN_MAX 1.0 1.0 1.0\n";
+        for (const auto& color : lutData_) cubeFile << color.r << " " << color.g << " " << color.b << "\n";
+        return static_cast<bool>(cubeFile);
+    }
 }
@@ -8,25 +8,29 @@
 
 #pragma once
 
-#include "core/gfx/FullscreenQuad.h"
+#include <array>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 #include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 #include <glbinding/gl/gl.h>
 #include <cereal/cereal.hpp>
 #include <cereal/access.hpp>
 
 namespace viscom {
-    class GPUProgram;
-    class FullscreenQuad;
     class FrameBuffer;
 }
 
 namespace viscom::enh {
 
     class ApplicationNodeBase;
+    class AutoExposure;
+    class GLStateCache;
     class GLUniformBuffer;
     class GLTexture;
+    class ScreenQuad;
 
 
     struct FilmicTMParameters
@@ -52,6 +56,15 @@ namespace viscom::enh {
         }
     };
 
+    /** The ways the filmic curve is evaluated. */
+    enum class FilmicTMMode
+    {
+        /** The curve is evaluated per pixel. */
+        ANALYTIC,
+        /** The curve and color grading are baked into a 3D LUT sampled once per pixel. */
+        LUT
+    };
+
     /**
      *  Filmic tone-mapping operator.
      *  @see http://filmicgames.com/archives/75
@@ -68,6 +81,20 @@ namespace viscom::enh {
 
         void SetExposure(float exposure) { params_.exposure_ = exposure; }
         float GetExposure() const { return params_.exposure_; }
+        /** Sets the automatic exposure to use (nullptr to disable it), the exposure parameter becomes a compensation. */
+        void SetAutoExposure(const AutoExposure* autoExposure) { autoExposure_ = autoExposure; }
+        void SetMode(FilmicTMMode mode) { mode_ = mode; }
+        FilmicTMMode GetMode() const { return mode_; }
+        void SetLUTSize(unsigned int size);
+        unsigned int GetLUTSize() const { return lutSize_; }
+        void SetColorGrading(std::function<glm::vec3(const glm::vec3&)> colorGrading);
+        bool ExportLUT(const std::string& filename);
+
+        /** Returns the shader variant for the current settings (+1 for automatic exposure, +2 for the LUT). */
+        std::size_t GetVariant() const { return (autoExposure_ ? 1 : 0) + (mode_ == FilmicTMMode::LUT ? 2 : 0); }
+        static std::vector<std::string> GetVariantDefines(std::size_t variant);
+        void RegisterProgram(gl::GLuint program, std::size_t variant) const;
+        void PrepareTonemapping(gl::GLuint lutTextureUnit);
 
         template<class Archive> void SaveParameters(Archive& ar, const std::uint32_t) const {
             ar(cereal::make_nvp("params", params_));
@@ -79,11 +106,33 @@ namespace viscom::enh {
 
     private:
         void ApplyTonemappingInternal(GLuint sourceTex);
-
-        /** Holds the screen renderable for the tone-mapping. */
-        std::unique_ptr<FullscreenQuad> renderable_;
-        /** Holds the shader uniform ids. */
-        std::vector<gl::GLint> uniformIds_;
+        void UpdateLUT();
+        glm::vec3 EvaluateCurve(const glm::vec3& color) const;
+
+        /** Holds the base application object. */
+        ApplicationNodeBase* app_;
+        /** Holds the OpenGL state cache. */
+        GLStateCache* stateCache_;
+        /** Holds the screen renderables for the tone-mapping variants (+1 for automatic exposure, +2 for the LUT). */
+        std::array<std::unique_ptr<ScreenQuad>, 4> renderables_;
+        /** Holds the shader uniform ids of the variants. */
+        std::array<std::vector<gl::GLint>, 4> uniformIds_;
+        /** Holds the automatic exposure used (may be nullptr). */
+        const AutoExposure* autoExposure_ = nullptr;
+        /** Holds the way the curve is evaluated. */
+        FilmicTMMode mode_ = FilmicTMMode::ANALYTIC;
+        /** Holds the size of the LUT in each dimension. */
+        unsigned int lutSize_ = 32;
+        /** Holds the color grading applied after the curve (may be empty). */
+        std::function<glm::vec3(const glm::vec3&)> colorGrading_;
+        /** Holds the baked LUT data, red changes fastest. */
+        std::vector<glm::vec3> lutData_;
+        /** Holds the LUT texture. */
+        std::unique_ptr<GLTexture> lut_;
+        /** Holds the parameters the LUT was baked with. */
+        FilmicTMParameters lutParams_;
+        /** Holds whether the LUT needs to be baked regardless of the parameters. */
+        bool lutDirty_ = true;
         /** Holds the parameters for the tone-mapping. */
         FilmicTMParameters params_;
         /** Holds the filmic uniform buffer. */
@@ -0,0 +1,296 @@
+/**
+ * @file   PostProcessingGraph.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of a graph of post-processing passes.
+ */
+
+#include "PostProcessingGraph.h"
+#include "AutoExposure.h"
+#include "BloomEffect.h"
+#include "DepthOfField.h"
+#include "FilmicTMOperator.h"
+#include "core/gfx/FrameBuffer.h"
+#include "enh/ApplicationNodeBase.h"
+#include "enh/gfx/gl/ScreenQuad.h"
+#include <algorithm>
+#include <cassert>
+
+namespace viscom::enh {
+
+    PostProcessingGraph::PostProcessingGraph(ApplicationNodeBase* app) :
+        app_{ app },
+        stateCache_{ app->GetGLStateCache() }
+    {
+    }
+
+    PostProcessingGraph::~PostProcessingGraph() = default;
+
+    /** Adds an external texture (e.g. the rendered color or depth), its texture is set with SetInput(). */
+    PostProcessingGraph::ResourceId PostProcessingGraph::AddInput(const std::string& name)
+    {
+        resources_.push_back(Resource{ name, NO_PASS, gl::GL_NONE });
+        dirty_ = true;
+        return resources_.size() - 1;
+    }
+
+    /** Sets the texture of an input for the next executions. */
+    void PostProcessingGraph::SetInput(ResourceId input, gl::GLuint texture)
+    {
+        assert(input < resources_.size() && resources_[input].producer_ == NO_PASS);
+        resources_[input].texture_ = texture;
+    }
+
+    /**
+     *  Adds a pass. The passes may be added in any order that respects their inputs.
+     *  @param name the name of the pass (used to enable and disable it).
+     *  @param inputs the resources read by the pass, a disabled pass forwards the first one.
+     *  @param execute the function executing the pass.
+     *  @param outputFormat the format of the resource written if it is an intermediate.
+     *  @return the resource written by the pass.
+     */
+    PostProcessingGraph::ResourceId PostProcessingGraph::AddPass(const std::string& name, const std::vector<ResourceId>& inputs, ExecuteFunction execute, gl::GLenum outputFormat)
+    {
+        assert(std::all_of(inputs.begin(), inputs.end(), [this](ResourceId r) { return r < resources_.size(); }));
+
+        resources_.push_back(Resource{ name, passes_.size(), outputFormat });
+        passes_.push_back(Pass{ name, PassType::CUSTOM, inputs, resources_.size() - 1, std::move(execute) });
+        dirty_ = true;
+        return resources_.size() - 1;
+    }
+
+    /** Adds a depth of field pass, the camera needs to stay valid while the graph is used. */
+    PostProcessingGraph::ResourceId PostProcessingGraph::AddDepthOfField(const std::string& name, DepthOfField* dof, const CameraHelper* camera, ResourceId color, ResourceId depth)
+    {
+        return AddPass(name, { color, depth }, [dof, camera](const std::vector<gl::GLuint>& inputs, const FrameBuffer* fbo, std::size_t drawBufferIndex) {
+            dof->ApplyEffect(*camera, inputs[0], inputs[1], fbo, drawBufferIndex);
+        });
+    }
+
+    /** Adds a bloom pass, it is fused with a tone-mapping pass that is its only consumer. */
+    PostProcessingGraph::ResourceId PostProcessingGraph::AddBloom(const std::string& name, BloomEffect* bloom, ResourceId source)
+    {
+        auto result = AddPass(name, { source }, [bloom](const std::vector<gl::GLuint>& inputs, const FrameBuffer* fbo, std::size_t drawBufferIndex) {
+            bloom->ApplyEffect(inputs[0], fbo, drawBufferIndex);
+        });
+        passes_.back().type_ = PassType::BLOOM;
+        passes_.back().bloom_ = bloom;
+        return result;
+    }
+
+    /**
+     *  Adds a tone-mapping pass, the result is stored with 8 bits per channel if it is an intermediate.
+     *  @param autoExposure the automatic exposure updated from the source before tone-mapping (nullptr to use the
+     *      exposure of the tone-mapping only), it is set on the tone-mapping.
+     */
+    PostProcessingGraph::ResourceId PostProcessingGraph::AddTonemapping(const std::string& name, FilmicTMOperator* tonemapping, ResourceId source, AutoExposure* autoExposure)
+    {
+        tonemapping->SetAutoExposure(autoExposure);
+        auto result = AddPass(name, { source }, [tonemapping](const std::vector<gl::GLuint>& inputs, const FrameBuffer* fbo, std::size_t drawBufferIndex) {
+            tonemapping->ApplyTonemapping(inputs[0], fbo, drawBufferIndex);
+        }, gl::GL_RGBA8);
+        passes_.back().type_ = PassType::TONEMAPPING;
+        passes_.back().tonemapping_ = tonemapping;
+        passes_.back().autoExposure_ = autoExposure;
+        return result;
+    }
+
+    /** Sets the resource written to the target frame buffer. */
+    void PostProcessingGraph::SetOutput(ResourceId output)
+    {
+        assert(output < resources_.size());
+        output_ = output;
+        dirty_ = true;
+    }
+
+    /** Enables or disables all passes with a name, a disabled pass forwards its first input. */
+    void PostProcessingGraph::SetPassEnabled(const std::string& name, bool enabled)
+    {
+        for (auto& pass : passes_) {
+            if (pass.name_ != name || pass.enabled_ == enabled) continue;
+            assert(!pass.inputs_.empty());
+            pass.enabled_ = enabled;
+            dirty_ = true;
+        }
+    }
+
+    bool PostProcessingGraph::IsPassEnabled(const std::string& name) const
+    {
+        auto it = std::find_if(passes_.begin(), passes_.end(), [&name](const Pass& pass) { return pass.name_ == name; });
+        return it != passes_.end() && it->enabled_;
+    }
+
+    /** Returns the resource actually holding a resource when disabled passes forward their input. */
+    PostProcessingGraph::ResourceId PostProcessingGraph::Resolve(ResourceId resource) const
+    {
+        while (resources_[resource].producer_ != NO_PASS && !passes_[resources_[resource].producer_].enabled_) {
+            resource = passes_[resources_[resource].producer_].inputs_[0];
+        }
+        return resource;
+    }
+
+    /** Marks the pass writing a resource and all passes it depends on as live. */
+    void PostProcessingGraph::AddLivePasses(ResourceId resource, std::vector<bool>& live) const
+    {
+        auto pass = resources_[Resolve(resource)].producer_;
+        if (pass == NO_PASS || live[pass]) return;
+
+        live[pass] = true;
+        for (auto input : passes_[pass].inputs_) AddLivePasses(input, live);
+    }
+
+    /**
+     *  Fuses each bloom pass with a tone-mapping pass that is the only consumer of its result. The bloom pass then
+     *  writes the resource of the tone-mapping pass.
+     */
+    void PostProcessingGraph::FusePasses(const std::vector<bool>& live)
+    {
+        for (auto& pass : passes_) pass.fusedPass_ = NO_PASS;
+
+        auto finalResource = Resolve(output_);
+        for (std::size_t i = 0; i < passes_.size(); ++i) {
+            if (!live[i] || passes_[i].type_ != PassType::TONEMAPPING || passes_[i].inputs_.size() != 1) continue;
+
+            auto source = Resolve(passes_[i].inputs_[0]);
+            auto bloomPass = resources_[source].producer_;
+            if (bloomPass == NO_PASS || passes_[bloomPass].type_ != PassType::BLOOM || source == finalResource) continue;
+
+            std::size_t consumers = 0;
+            for (std::size_t j = 0; j < passes_.size(); ++j) {
+                if (!live[j]) continue;
+                for (auto input : passes_[j].inputs_) if (Resolve(input) == source) consumers += 1;
+            }
+            if (consumers == 1) passes_[bloomPass].fusedPass_ = i;
+        }
+    }
+
+    /** Appends a live pass to the execution order after the passes it depends on. */
+    void PostProcessingGraph::OrderPasses(std::size_t pass, const std::vector<bool>& live, std::vector<bool>& visited)
+    {
+        if (visited[pass]) return;
+        visited[pass] = true;
+
+        for (auto input : passes_[pass].inputs_) {
+            auto dependency = resources_[Resolve(input)].producer_;
+            if (dependency == NO_PASS) continue;
+            // a fused pass is executed by the pass it was fused into.
+            if (!live[dependency]) {
+                dependency = static_cast<std::size_t>(std::find_if(passes_.begin(), passes_.end(),
+                    [dependency](const Pass& p) { return p.fusedPass_ == dependency; }) - passes_.begin());
+            }
+            OrderPasses(dependency, live, visited);
+        }
+        executionOrder_.push_back(pass);
+    }
+
+    /**
+     *  Culls, fuses and orders the passes. This is done on the next Execute() after the graph changed, call it
+     *  explicitly to avoid the work in the first frame.
+     */
+    void PostProcessingGraph::Compile()
+    {
+        assert(output_ != NO_PASS);
+
+        std::vector<bool> live(passes_.size(), false);
+        AddLivePasses(output_, live);
+        FusePasses(live);
+        for (const auto& pass : passes_) if (pass.fusedPass_ != NO_PASS) live[pass.fusedPass_] = false;
+
+        executionOrder_.clear();
+        std::vector<bool> visited(passes_.size(), false);
+        for (std::size_t i = 0; i < passes_.size(); ++i) if (live[i]) OrderPasses(i, live, visited);
+
+        for (auto& resource : resources_) resource.lastUse_ = 0;
+        for (std::size_t i = 0; i < executionOrder_.size(); ++i) {
+            for (auto input : passes_[executionOrder_[i]].inputs_) resources_[Resolve(input)].lastUse_ = i;
+        }
+        dirty_ = false;
+    }
+
+    /** Returns the resource a pass writes, this is the resource of the fused pass if any. */
+    PostProcessingGraph::ResourceId PostProcessingGraph::GetWrittenResource(std::size_t pass) const
+    {
+        const auto& p = passes_[pass];
+        return p.fusedPass_ == NO_PASS ? p.output_ : passes_[p.fusedPass_].output_;
+    }
+
+    gl::GLuint PostProcessingGraph::GetTexture(ResourceId resource) const
+    {
+        const auto& r = resources_[resource];
+        return r.producer_ == NO_PASS ? r.texture_ : r.target_->GetTextures()[0];
+    }
+
+    /**
+     *  Executes the passes, the intermediate resources have the size of the target.
+     *  @param targetFBO the frame buffer the output is written to.
+     *  @param drawBufferIndex the draw buffer of the frame buffer the output is written to.
+     */
+    void PostProcessingGraph::Execute(const FrameBuffer* targetFBO, std::size_t drawBufferIndex)
+    {
+        if (dirty_) Compile();
+
+        auto finalResource = Resolve(output_);
+        if (resources_[finalResource].producer_ == NO_PASS) {
+            CopyInput(resources_[finalResource].texture_, targetFBO, drawBufferIndex);
+            return;
+        }
+
+        auto pool = app_->GetRenderTargetPool();
+        glm::uvec2 size{ targetFBO->GetWidth(), targetFBO->GetHeight() };
+        std::vector<gl::GLuint> inputTextures;
+        for (std::size_t i = 0; i < executionOrder_.size(); ++i) {
+            const auto& pass = passes_[executionOrder_[i]];
+            inputTextures.clear();
+            for (auto input : pass.inputs_) inputTextures.push_back(GetTexture(Resolve(input)));
+
+            auto writtenResource = GetWrittenResource(executionOrder_[i]);
+            const auto& tonemappingPass = pass.fusedPass_ == NO_PASS ? pass : passes_[pass.fusedPass_];
+            if (tonemappingPass.autoExposure_) tonemappingPass.autoExposure_->Update(inputTextures[0]);
+            if (pass.fusedPass_ != NO_PASS) pass.bloom_->SetTonemapping(passes_[pass.fusedPass_].tonemapping_);
+            if (writtenResource == finalResource) pass.execute_(inputTextures, targetFBO, drawBufferIndex);
+            else {
+                auto& written = resources_[writtenResource];
+                written.target_ = pool->Acquire(size, { written.format_ });
+                pass.execute_(inputTextures, written.target_, 0);
+            }
+            if (pass.fusedPass_ != NO_PASS) pass.bloom_->SetTonemapping(nullptr);
+
+            for (auto input : pass.inputs_) {
+                auto& resource = resources_[Resolve(input)];
+                if (resource.target_ && resource.lastUse_ == i) {
+                    pool->Release(resource.target_);
+                    resource.target_ = nullptr;
+                }
+            }
+        }
+    }
+
+    /** Returns the names of the passes executed in order, fused passes are listed as "bloom+tonemapping". */
+    std::vector<std::string> PostProcessingGraph::GetExecutedPasses() const
+    {
+        std::vector<std::string> names;
+        for (auto pass : executionOrder_) {
+            names.push_back(passes_[pass].name_);
+            if (passes_[pass].fusedPass_ != NO_PASS) names.back() += "+" + passes_[passes_[pass].fusedPass_].name_;
+        }
+        return names;
+    }
+
+    /** Copies an input to the target if all passes are disabled. */
+    void PostProcessingGraph::CopyInput(gl::GLuint texture, const FrameBuffer* targetFBO, std::size_t drawBufferIndex)
+    {
+        if (!copyQuad_) {
+            copyQuad_ = std::make_unique<ScreenQuad>("copyTexture.frag", app_);
+            copyUniformIds_ = copyQuad_->GetProgram()->GetUniformLocations({ "sourceTex" });
+        }
+
+        targetFBO->DrawToFBO(std::vector<std::size_t>{ drawBufferIndex }, [this, texture]() {
+            stateCache_->InvalidateExternalState();
+            stateCache_->UseProgram(copyQuad_->GetProgram()->GetProgramId());
+            stateCache_->BindTexture(0, gl::GL_TEXTURE_2D, texture);
+            gl::glUniform1i(copyUniformIds_[0], 0);
+            copyQuad_->Draw();
+        });
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * @file   PostProcessingGraph.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of a graph of post-processing passes.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glbinding/gl/gl.h>
+
+namespace viscom {
+    class CameraHelper;
+    class FrameBuffer;
+}
+
+namespace viscom::enh {
+
+    class ApplicationNodeBase;
+    class AutoExposure;
+    class BloomEffect;
+    class DepthOfField;
+    class FilmicTMOperator;
+    class ScreenQuad;
+    class GLStateCache;
+
+    /**
+     * @brief  Orders, culls and fuses post-processing passes declared by their inputs and outputs.
+     *
+     *  Each pass reads a list of resources and writes a new one. The external textures (e.g. the rendered color and
+     *  depth) are inputs set each frame and one resource is the output written to the target frame buffer. On
+     *  Compile() the passes are ordered by their dependencies, disabled passes forward their first input and passes
+     *  the output does not depend on are culled. A bloom pass only consumed by a tone-mapping pass is fused with it
+     *  (see BloomEffect::SetTonemapping()), an automatic exposure of the tone-mapping is then metered on the input of
+     *  the bloom. Intermediate resources are acquired from the render target pool and released after their last
+     *  consumer, so they share memory with other passes.
+     */
+    class PostProcessingGraph
+    {
+    public:
+        /** Identifies a resource of the graph. */
+        using ResourceId = std::size_t;
+        /**
+         *  Executes a pass.
+         *  @param inputs the textures of the input resources.
+         *  @param fbo the frame buffer to write to.
+         *  @param drawBufferIndex the draw buffer of the frame buffer to write to.
+         */
+        using ExecuteFunction = std::function<void(const std::vector<gl::GLuint>& inputs, const FrameBuffer* fbo, std::size_t drawBufferIndex)>;
+
+        explicit PostProcessingGraph(ApplicationNodeBase* app);
+        PostProcessingGraph(const PostProcessingGraph&) = delete;
+        PostProcessingGraph& operator=(const PostProcessingGraph&) = delete;
+        ~PostProcessingGraph();
+
+        ResourceId AddInput(const std::string& name);
+        void SetInput(ResourceId input, gl::GLuint texture);
+        ResourceId AddPass(const std::string& name, const std::vector<ResourceId>& inputs, ExecuteFunction execute, gl::GLenum outputFormat = gl::GL_RGBA32F);
+        ResourceId AddDepthOfField(const std::string& name, DepthOfField* dof, const CameraHelper* camera, ResourceId color, ResourceId depth);
+        ResourceId AddBloom(const std::string& name, BloomEffect* bloom, ResourceId source);
+        ResourceId AddTonemapping(const std::string& name, FilmicTMOperator* tonemapping, ResourceId source, AutoExposure* autoExposure = nullptr);
+        void SetOutput(ResourceId output);
+        void SetPassEnabled(const std::string& name, bool enabled);
+        bool IsPassEnabled(const std::string& name) const;
+
+        void Compile();
+        void Execute(const FrameBuffer* targetFBO, std::size_t drawBufferIndex = 0);
+        std::vector<std::string> GetExecutedPasses() const;
+
+    private:
+        /** The effects the graph knows how to fuse. */
+        enum class PassType
+        {
+            CUSTOM,
+            BLOOM,
+            TONEMAPPING
+        };
+
+        /** A resource, either an input or the output of a pass. */
+        struct Resource
+        {
+            /** Holds the name of the resource. */
+            std::string name_;
+            /** Holds the index of the pass writing the resource (NO_PASS for inputs). */
+            std::size_t producer_;
+            /** Holds the format of intermediate targets. */
+            gl::GLenum format_;
+            /** Holds the texture of an input. */
+            gl::GLuint texture_ = 0;
+            /** Holds the target of the current frame while it is acquired. */
+            const FrameBuffer* target_ = nullptr;
+            /** Holds the position in the execution order after which the target is released. */
+            std::size_t lastUse_ = 0;
+        };
+
+        /** A pass of the graph. */
+        struct Pass
+        {
+            /** Holds the name of the pass. */
+            std::string name_;
+            /** Holds the type of the pass. */
+            PassType type_;
+            /** Holds the resources read. */
+            std::vector<ResourceId> inputs_;
+            /** Holds the resource written. */
+            ResourceId output_;
+            /** Holds the function executing the pass. */
+            ExecuteFunction execute_;
+            /** Holds whether the pass is enabled. */
+            bool enabled_ = true;
+            /** Holds the bloom effect of a bloom pass. */
+            BloomEffect* bloom_ = nullptr;
+            /** Holds the tone-mapping of a tone-mapping pass. */
+            FilmicTMOperator* tonemapping_ = nullptr;
+            /** Holds the automatic exposure updated before a tone-mapping pass (may be nullptr). */
+            AutoExposure* autoExposure_ = nullptr;
+            /** Holds the pass fused into this one (NO_PASS if none). */
+            std::size_t fusedPass_ = NO_PASS;
+        };
+
+        /** Marks inputs and passes not fused. */
+        static constexpr std::size_t NO_PASS = static_cast<std::size_t>(-1);
+
+        ResourceId Resolve(ResourceId resource) const;
+        void AddLivePasses(ResourceId resource, std::vector<bool>& live) const;
+        void FusePasses(const std::vector<bool>& live);
+        void OrderPasses(std::size_t pass, const std::vector<bool>& live, std::vector<bool>& visited);
+        ResourceId GetWrittenResource(std::size_t pass) const;
+        gl::GLuint GetTexture(ResourceId resource) const;
+        void CopyInput(gl::GLuint texture, const FrameBuffer* targetFBO, std::size_t drawBufferIndex);
+
+        /** Holds the base application object. */
+        ApplicationNodeBase* app_;
+        /** Holds the OpenGL state cache. */
+        GLStateCache* stateCache_;
+        /** Holds the resources. */
+        std::vector<Resource> resources_;
+        /** Holds the passes in the order they were added. */
+        std::vector<Pass> passes_;
+        /** Holds the output resource. */
+        ResourceId output_ = NO_PASS;
+        /** Holds the passes to execute in order. */
+        std::vector<std::size_t> executionOrder_;
+        /** Holds whether the graph needs to be compiled before executing. */
+        bool dirty_ = true;
+        /** Holds the quad copying an input to the target if no pass is executed, created on first use. */
+        std::unique_ptr<ScreenQuad> copyQuad_;
+        /** Holds the copy program uniform ids. */
+        std::vector<gl::GLint> copyUniformIds_;
+    };
+}
@@ -0,0 +1,21 @@
+/**
+ * @file   RenderTargetPrecision.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the precision setting for post processing render targets.
+ */
+
+#pragma once
+
+namespace viscom::enh {
+
+    /** The precision of the intermediate render targets of post processing effects. */
+    enum class RenderTargetPrecision
+    {
+        /** 32 bit floating point targets. */
+        FULL,
+        /** Smallest floating point format suitable for each target (R11G11B10F for colors, RG16F for CoC values). */
+        REDUCED
+    };
+}
@@ -0,0 +1,69 @@
+/**
+ * @file   SeparableKernel.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of symmetric separable filter kernels sampled with bilinear taps.
+ */
+
+#include "SeparableKernel.h"
+#include "core/main.h"
+#include <cmath>
+#include <numeric>
+
+namespace viscom::enh {
+
+    /**
+     *  Creates the bilinear taps of a filter from the weights of its discrete texels.
+     *  @param texelWeights the weights of the center texel and the texels of one side, they are normalized so the whole
+     *  filter sums up to one.
+     */
+    SeparableKernel::SeparableKernel(const std::vector<float>& texelWeights)
+    {
+        if (texelWeights.empty() || texelWeights.size() > MAX_RADIUS + 1) {
+            LOG(FATAL) << "Separable kernels need 1 to " << MAX_RADIUS + 1 << " texel weights.";
+            throw std::runtime_error("Separable kernels need 1 to " + std::to_string(MAX_RADIUS + 1) + " texel weights.");
+        }
+
+        radius_ = texelWeights.size() - 1;
+        numTaps_ = GetNumTaps(radius_);
+        auto sum = 2.0f * std::accumulate(texelWeights.begin(), texelWeights.end(), 0.0f) - texelWeights[0];
+
+        for (std::size_t i = 0; i < numTaps_; ++i) {
+            // both sides sample the center, so each one gets half of it.
+            auto first = (i == 0 ? 0.5f : 1.0f) * texelWeights[2 * i] / sum;
+            auto second = 2 * i + 1 <= radius_ ? texelWeights[2 * i + 1] / sum : 0.0f;
+            auto weight = first + second;
+            auto offset = weight > 0.0f ? static_cast<float>(2 * i) + second / weight : static_cast<float>(2 * i);
+            taps_[i] = glm::vec4(weight, offset, 0.0f, 0.0f);
+        }
+    }
+
+    /**
+     *  Creates a Gaussian filter, the texel weights are the integrals of the Gaussian over each texel. The filter is
+     *  cut off at three standard deviations (at MAX_RADIUS at the latest).
+     *  @param sigma the standard deviation in texels (0 returns the identity).
+     */
+    SeparableKernel SeparableKernel::Gaussian(float sigma)
+    {
+        if (sigma <= 0.0f) return SeparableKernel{ std::vector<float>{ 1.0f } };
+
+        auto radius = std::min(static_cast<std::size_t>(std::ceil(3.0f * sigma)), MAX_RADIUS);
+        auto scale = 1.0f / (std::sqrt(2.0f) * sigma);
+        std::vector<float> texelWeights(radius + 1);
+        for (std::size_t i = 0; i <= radius; ++i) {
+            auto x = static_cast<float>(i);
+            texelWeights[i] = 0.5f * (std::erf((x + 0.5f) * scale) - std::erf((x - 0.5f) * scale));
+        }
+        return SeparableKernel{ texelWeights };
+    }
+
+    /**
+     *  Creates a box filter averaging 2 * radius + 1 texels.
+     *  @param radius the radius in texels.
+     */
+    SeparableKernel SeparableKernel::Box(std::size_t radius)
+    {
+        return SeparableKernel{ std::vector<float>(radius + 1, 1.0f) };
+    }
+}
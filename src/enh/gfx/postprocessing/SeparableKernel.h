@@ -0,0 +1,60 @@
+/**
+ * @file   SeparableKernel.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of symmetric separable filter kernels sampled with bilinear taps.
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <glm/vec4.hpp>
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Weights and offsets of a symmetric separable filter sampled with bilinear taps.
+     *
+     *  Each tap is sampled at +offset and -offset texels from the center and combines two neighboring texels by
+     *  linear filtering, the center texel is split between the first taps of both sides. A filter with a radius of r
+     *  texels therefore needs r / 2 + 1 taps per side instead of r + 1 fetches. The taps are stored as (weight,
+     *  offset, 0, 0) so they can be uploaded to a std140 uniform buffer (see gaussian_blur.glsl), the number of taps
+     *  selects the shader permutation.
+     */
+    class SeparableKernel
+    {
+    public:
+        /** The maximum number of taps per side. */
+        static constexpr std::size_t MAX_TAPS = 8;
+        /** The maximum radius in texels. */
+        static constexpr std::size_t MAX_RADIUS = 2 * MAX_TAPS - 1;
+
+        explicit SeparableKernel(const std::vector<float>& texelWeights);
+
+        static SeparableKernel Gaussian(float sigma);
+        static SeparableKernel Box(std::size_t radius);
+        /** Returns the number of taps per side of a filter with a radius in texels. */
+        static constexpr std::size_t GetNumTaps(std::size_t radius) { return radius / 2 + 1; }
+
+        /** Returns the number of taps per side. */
+        std::size_t GetNumTaps() const { return numTaps_; }
+        /** Returns the radius of the filter in texels. */
+        std::size_t GetRadius() const { return radius_; }
+        /** Returns the weight of a tap, the weights of all taps of both sides sum up to one. */
+        float GetWeight(std::size_t tap) const { return taps_[tap].x; }
+        /** Returns the offset of a tap in texels. */
+        float GetOffset(std::size_t tap) const { return taps_[tap].y; }
+        /** Returns the taps as (weight, offset, 0, 0), only the first GetNumTaps() are used. */
+        const std::array<glm::vec4, MAX_TAPS>& GetTaps() const { return taps_; }
+
+    private:
+        /** Holds the taps. */
+        std::array<glm::vec4, MAX_TAPS> taps_ = {};
+        /** Holds the number of taps used. */
+        std::size_t numTaps_ = 0;
+        /** Holds the radius in texels. */
+        std::size_t radius_ = 0;
+    };
+}
@@ -0,0 +1,254 @@
+/**
+ * @file   PostProcessingPrecisionTest.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Image difference test of the bloom and depth of field passes with full and reduced precision targets.
+ */
+
+#include "enh/gfx/postprocessing/BloomEffect.h"
+#include "enh/gfx/postprocessing/CPUDepthOfField.h"
+#include "enh/gfx/postprocessing/CPUPostProcessing.h"
+#include "enh/gfx/postprocessing/DepthOfField.h"
+#include "enh/gfx/postprocessing/FilmicTMOperator.h"
+#include "enh/gfx/postprocessing/RenderTargetPrecision.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace viscom::enh {
+
+    namespace {
+        /** The size of the test frame. */
+        constexpr unsigned int FRAME_WIDTH = 320, FRAME_HEIGHT = 180;
+        /** The near and far plane of the test camera. */
+        constexpr float NEAR_PLANE = 0.1f, FAR_PLANE = 100.0f;
+
+        /** The largest differences accepted after tone-mapping. */
+        struct Tolerance
+        {
+            float maxError_;
+            float rmse_;
+        };
+        /** The tolerance against the stored references, Radiance HDR truncates to 8 bit mantissas (1/64 above 2). */
+        constexpr Tolerance REFERENCE_TOLERANCE{ 0.02f, 0.003f };
+        /** The tolerance of reduced precision targets against full precision targets. */
+        constexpr Tolerance PRECISION_TOLERANCE{ 0.02f, 0.002f };
+
+        /** The parameters of the effects, the defaults of the GPU effects. */
+        constexpr BloomParams BLOOM_PARAMS{ 1.0f, 0.4f };
+        constexpr FilmicTMParameters TONEMAPPING_PARAMS{ 0.15f, 0.5f, 0.1f, 0.2f, 0.02f, 0.3f, 11.2f, 2.0f };
+        const DOFParams DOF_PARAMS{ 12.0f, 0.034f, 1.6f, 1.5f, 10.0f, 7, glm::pi<float>() / 3.0f };
+
+        /**
+         *  Rounds a value to the nearest floating point value with 5 exponent bits, like the components of RG16F
+         *  (10 mantissa bits) and R11G11B10F (6 and 5 mantissa bits, no sign).
+         *  @param value the value to round.
+         *  @param mantissaBits the number of mantissa bits.
+         *  @param hasSign whether negative values can be stored, they are clamped to 0 otherwise.
+         */
+        float RoundToSmallFloat(float value, int mantissaBits, bool hasSign)
+        {
+            if (!hasSign && value < 0.0f) return 0.0f;
+            const auto maxValue = (2.0f - std::ldexp(1.0f, -mantissaBits)) * 32768.0f;
+            auto exponent = 0;
+            std::frexp(std::abs(value), &exponent);
+            // values below the smallest normal number (2^-14) are denormals with a fixed spacing.
+            auto spacing = std::ldexp(1.0f, std::max(exponent, -13) - 1 - mantissaBits);
+            return std::copysign(std::min(std::round(std::abs(value) / spacing) * spacing, maxValue), value);
+        }
+
+        /** Returns an image as stored in a R11G11B10F target, alpha reads as 1. */
+        CPUImage ToR11G11B10F(const CPUImage& image)
+        {
+            CPUImage result{ image.GetWidth(), image.GetHeight() };
+            for (unsigned int y = 0; y < image.GetHeight(); ++y) {
+                for (unsigned int x = 0; x < image.GetWidth(); ++x) {
+                    auto value = image.Get(x, y);
+                    result.Set(x, y, float4(RoundToSmallFloat(value[0], 6, false), RoundToSmallFloat(value[1], 6, false),
+                        RoundToSmallFloat(value[2], 5, false), 1.0f));
+                }
+            }
+            return result;
+        }
+
+        /** Returns an image as stored in a RG16F target, the CoC passes do not use the other channels. */
+        CPUImage ToRG16F(const CPUImage& image)
+        {
+            CPUImage result{ image.GetWidth(), image.GetHeight() };
+            for (unsigned int y = 0; y < image.GetHeight(); ++y) {
+                for (unsigned int x = 0; x < image.GetWidth(); ++x) {
+                    auto value = image.Get(x, y);
+                    result.Set(x, y, float4(RoundToSmallFloat(value[0], 10, true), RoundToSmallFloat(value[1], 10, true), value[2], value[3]));
+                }
+            }
+            return result;
+        }
+
+        /** Sets the alpha of an image to 1, the stored references have no alpha channel. */
+        CPUImage WithoutAlpha(CPUImage image)
+        {
+            for (unsigned int y = 0; y < image.GetHeight(); ++y) {
+                for (unsigned int x = 0; x < image.GetWidth(); ++x) image.Set(x, y, WithW(image.Get(x, y), float4(1.0f)));
+            }
+            return image;
+        }
+
+        /** Returns the distance of the test scene from the camera at a pixel. */
+        float GetSceneDistance(unsigned int x, unsigned int y)
+        {
+            auto u = (static_cast<float>(x) + 0.5f) / static_cast<float>(FRAME_WIDTH);
+            auto v = (static_cast<float>(y) + 0.5f) / static_cast<float>(FRAME_HEIGHT);
+            // an object in front of the focus plane, one on it and a background from near to far.
+            if ((u - 0.25f) * (u - 0.25f) * 3.16f + (v - 0.5f) * (v - 0.5f) < 0.04f) return 1.5f;
+            if (std::abs(u - 0.6f) < 0.05f && std::abs(v - 0.4f) < 0.2f) return DOF_PARAMS.focusZ_;
+            return 2.0f + 60.0f * u;
+        }
+
+        /**
+         *  Creates the color of the test frame: smooth gradients, a high frequency checker board and small light
+         *  sources well above the glare threshold.
+         */
+        CPUImage CreateColorFrame()
+        {
+            const std::array<std::pair<glm::vec2, float4>, 5> lights{ std::make_pair(glm::vec2(40.0f, 30.0f), float4(40.0f, 36.0f, 30.0f, 1.0f)),
+                std::make_pair(glm::vec2(80.0f, 90.0f), float4(12.0f, 2.0f, 1.0f, 1.0f)), std::make_pair(glm::vec2(190.0f, 70.0f), float4(4.0f, 8.0f, 20.0f, 1.0f)),
+                std::make_pair(glm::vec2(250.0f, 150.0f), float4(25.0f, 25.0f, 25.0f, 1.0f)), std::make_pair(glm::vec2(300.0f, 20.0f), float4(2.0f, 16.0f, 3.0f, 1.0f)) };
+
+            CPUImage result{ FRAME_WIDTH, FRAME_HEIGHT };
+            for (unsigned int y = 0; y < FRAME_HEIGHT; ++y) {
+                for (unsigned int x = 0; x < FRAME_WIDTH; ++x) {
+                    auto u = static_cast<float>(x) / static_cast<float>(FRAME_WIDTH), v = static_cast<float>(y) / static_cast<float>(FRAME_HEIGHT);
+                    auto color = float4(0.15f + 0.5f * u, 0.25f + 0.35f * v, 0.45f - 0.3f * u, 1.0f);
+                    if ((x / 8 + y / 8) % 2 == 0) color = color * 0.5f;
+                    for (const auto& light : lights) {
+                        auto dx = static_cast<float>(x) - light.first.x, dy = static_cast<float>(y) - light.first.y;
+                        if (dx * dx + dy * dy < 16.0f) color = light.second;
+                    }
+                    result.Set(x, y, color);
+                }
+            }
+            return result;
+        }
+
+        /** Creates the depth buffer of the test frame for a projection. */
+        CPUImage CreateDepthFrame(const glm::mat4& projection)
+        {
+            CPUImage result{ FRAME_WIDTH, FRAME_HEIGHT };
+            for (unsigned int y = 0; y < FRAME_HEIGHT; ++y) {
+                for (unsigned int x = 0; x < FRAME_WIDTH; ++x) {
+                    // the inverse of the view depth reconstruction in coc.frag.
+                    auto distance = GetSceneDistance(x, y);
+                    auto depthNDC = projection[3][2] / distance - projection[2][2];
+                    result.Set(x, y, float4(0.5f * depthNDC + 0.5f, 0.0f, 0.0f, 1.0f));
+                }
+            }
+            return result;
+        }
+
+        /**
+         *  Runs the bloom passes (glare detection, separable blurs, down sampling and the bicubic combine) with the
+         *  targets of the given precision and tone-maps the result.
+         */
+        CPUImage ApplyBloom(const CPUPostProcessing& postProcessing, const CPUImage& color, RenderTargetPrecision precision)
+        {
+            auto target = [precision](const CPUImage& image) { return precision == RenderTargetPrecision::FULL ? image : ToR11G11B10F(image); };
+            auto blur = [&postProcessing, &target](const CPUImage& image) {
+                return target(postProcessing.BlurBloom(target(postProcessing.BlurBloom(image, BLOOM_PARAMS.bloomWidth_, true)), BLOOM_PARAMS.bloomWidth_, false));
+            };
+
+            auto glare = target(postProcessing.GlareDetect(color));
+            auto blurHalf = blur(glare);
+            auto blurFourth1 = blur(target(postProcessing.DownsampleBloom(glare)));
+            auto blurFourth2 = blur(blurFourth1);
+            return WithoutAlpha(postProcessing.CombineBloom(color, { &blurHalf, &blurFourth1, &blurFourth2 }, BLOOM_PARAMS.bloomIntensity_, &TONEMAPPING_PARAMS));
+        }
+
+        /** Runs the depth of field passes with the targets of the given precision and tone-maps the result. */
+        CPUImage ApplyDepthOfField(const CPUPostProcessing& postProcessing, const CPUImage& color, const CPUImage& depth, const glm::mat4& projection,
+            RenderTargetPrecision precision)
+        {
+            auto colorTarget = [precision](const CPUImage& image) { return precision == RenderTargetPrecision::FULL ? image : ToR11G11B10F(image); };
+            auto cocTarget = [precision](const CPUImage& image) { return precision == RenderTargetPrecision::FULL ? image : ToRG16F(image); };
+            const CPUDepthOfField dof;
+
+            // the full resolution CoC target keeps 32 bit floats with both precisions.
+            auto coc = dof.CoC(depth, DepthOfField::CalculateCoCParams(DOF_PARAMS, projection, color.GetHeight()));
+            auto lowRes = dof.Downsample(color, coc);
+            auto colorHalf = colorTarget(lowRes[0]);
+            auto colorMulCoCFarHalf = colorTarget(lowRes[1]);
+            auto cocHalf = cocTarget(lowRes[2]);
+
+            auto cocTile = cocTarget(dof.TileMinMax(cocTarget(dof.TileMinMax(cocHalf, true)), false));
+            auto cocNearBlur = cocTarget(dof.NearCoCBlur(cocTarget(dof.NearCoCBlur(cocTile, true)), false));
+
+            auto fields = dof.Gather(cocHalf, cocNearBlur, colorHalf, colorMulCoCFarHalf, DepthOfField::CalculateBokehTaps(DOF_PARAMS));
+            auto filledFields = dof.Fill(cocHalf, cocNearBlur, colorTarget(fields[0]), colorTarget(fields[1]));
+            auto result = dof.Composite(color, coc, cocHalf, cocNearBlur, colorTarget(filledFields[0]), colorTarget(filledFields[1]));
+            return WithoutAlpha(postProcessing.ApplyFilmicTonemapping(result, TONEMAPPING_PARAMS));
+        }
+
+        /** Compares an image to the expected one and prints the difference. */
+        bool CheckDifference(const std::string& name, const CPUImage& image, const CPUImage& expected, const Tolerance& tolerance)
+        {
+            auto difference = image.Compare(expected);
+            auto passed = difference.maxError_ <= tolerance.maxError_ && difference.rmse_ <= tolerance.rmse_;
+            std::cout << (passed ? "[PASSED] " : "[FAILED] ") << name << ": max error " << difference.maxError_ << " (" << tolerance.maxError_
+                << "), RMSE " << difference.rmse_ << " (" << tolerance.rmse_ << ")" << std::endl;
+            return passed;
+        }
+
+        /** Compares an image to a stored reference, or stores it as the new reference. */
+        bool CheckReference(const std::string& name, const CPUImage& image, const std::string& referenceFile, bool updateReference)
+        {
+            if (updateReference) {
+                std::cout << "Writing reference " << referenceFile << "." << std::endl;
+                return image.SaveHDR(referenceFile);
+            }
+            return CheckDifference(name, image, CPUImage::Load(referenceFile), REFERENCE_TOLERANCE);
+        }
+    }
+}
+
+/**
+ *  Renders the test frame with both effects at full and reduced precision. The full precision results are compared to
+ *  the references, the reduced precision results to the full precision ones. Call with the reference directory and
+ *  --update to write new references after intended changes of the effects.
+ */
+int main(int argc, char** argv)
+{
+    using namespace viscom::enh;
+    if (argc < 2 || (argc == 3 && std::string(argv[2]) != "--update") || argc > 3) {
+        std::cout << "Usage: enh_precision_test <reference directory> [--update]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string referenceDirectory = argv[1];
+    auto updateReference = argc == 3;
+
+    try {
+        const CPUPostProcessing postProcessing;
+        auto projection = glm::perspective(glm::radians(60.0f), static_cast<float>(FRAME_WIDTH) / static_cast<float>(FRAME_HEIGHT), NEAR_PLANE, FAR_PLANE);
+        auto color = CreateColorFrame();
+        auto depth = CreateDepthFrame(projection);
+
+        auto bloom = ApplyBloom(postProcessing, color, RenderTargetPrecision::FULL);
+        auto bloomReduced = ApplyBloom(postProcessing, color, RenderTargetPrecision::REDUCED);
+        auto dof = ApplyDepthOfField(postProcessing, color, depth, projection, RenderTargetPrecision::FULL);
+        auto dofReduced = ApplyDepthOfField(postProcessing, color, depth, projection, RenderTargetPrecision::REDUCED);
+
+        auto passed = CheckReference("Bloom (full precision)", bloom, referenceDirectory + "/bloom.hdr", updateReference);
+        passed = CheckReference("Depth of Field (full precision)", dof, referenceDirectory + "/depth_of_field.hdr", updateReference) && passed;
+        passed = CheckDifference("Bloom (reduced precision)", bloomReduced, bloom, PRECISION_TOLERANCE) && passed;
+        passed = CheckDifference("Depth of Field (reduced precision)", dofReduced, dof, PRECISION_TOLERANCE) && passed;
+        return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file   CPUBenchmarks.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the benchmarks of the CPU post-processing effects.
+ */
+
+#include "CPUBenchmarks.h"
+#include "benchmark_suite.h"
+#include "enh/gfx/postprocessing/BloomEffect.h"
+#include "enh/gfx/postprocessing/CPUDepthOfField.h"
+#include "enh/gfx/postprocessing/CPUPostProcessing.h"
+#include "enh/gfx/postprocessing/DepthOfField.h"
+#include "enh/gfx/postprocessing/FilmicTMOperator.h"
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace viscom::enh {
+
+    namespace {
+        /** The resolutions benchmarked. */
+        const std::array<std::pair<const char*, glm::uvec2>, 2> RESOLUTIONS{ { { "1080p", glm::uvec2(1920, 1080) }, { "4K", glm::uvec2(3840, 2160) } } };
+        /** The near and far plane of the projection used. */
+        constexpr float NEAR_PLANE = 0.1f, FAR_PLANE = 100.0f;
+
+        /** Returns a color image with a pattern of HDR highlights, so bloom and tone-mapping have work to do. */
+        CPUImage CreateColorImage(const glm::uvec2& size)
+        {
+            CPUImage color{ size.x, size.y };
+            for (unsigned int y = 0; y < size.y; ++y) {
+                for (unsigned int x = 0; x < size.x; ++x) {
+                    auto highlight = (x % 64 < 4 && y % 64 < 4) ? 8.0f : 0.0f;
+                    color.Set(x, y, float4(static_cast<float>(x) / static_cast<float>(size.x) + highlight,
+                        static_cast<float>(y) / static_cast<float>(size.y) + highlight, 0.5f + highlight, 1.0f));
+                }
+            }
+            return color;
+        }
+
+        /** Returns a depth buffer of a plane going from the near plane to the far plane from left to right. */
+        CPUImage CreateDepthImage(const glm::uvec2& size, const glm::mat4& projection)
+        {
+            CPUImage depth{ size.x, size.y };
+            for (unsigned int x = 0; x < size.x; ++x) {
+                auto viewZ = -glm::mix(1.0f, 40.0f, static_cast<float>(x) / static_cast<float>(size.x));
+                auto clipPosition = projection * glm::vec4(0.0f, 0.0f, viewZ, 1.0f);
+                auto depthValue = 0.5f * clipPosition.z / clipPosition.w + 0.5f;
+                for (unsigned int y = 0; y < size.y; ++y) depth.Set(x, y, float4(depthValue, 0.0f, 0.0f, 0.0f));
+            }
+            return depth;
+        }
+    }
+
+    /**
+     *  Adds benchmarks of the CPU bloom, tone-mapping and depth of field at 1080p and 4K with the default parameters
+     *  of the GPU effects. The items processed are the pixels of the image.
+     *  @param suite the suite to add the benchmarks to.
+     *  @param numThreads the number of threads used by the effects (0 to use all hardware threads).
+     */
+    void AddCPUBenchmarks(BenchmarkSuite& suite, unsigned int numThreads)
+    {
+        for (const auto& [resolutionName, size] : RESOLUTIONS) {
+            const std::string resolution = resolutionName;
+            const auto imageSize = size;
+            const auto numPixels = static_cast<std::size_t>(imageSize.x) * imageSize.y;
+
+            suite.Add("CPU/Bloom/" + resolution, [imageSize, numPixels, numThreads](BenchmarkState& state) {
+                CPUPostProcessing postProcessing{ numThreads };
+                auto color = CreateColorImage(imageSize);
+                BloomParams params{ 1.0f, 0.4f };
+                while (state.KeepRunning()) postProcessing.ApplyBloom(color, params);
+                state.SetItemsProcessed(numPixels);
+            });
+
+            suite.Add("CPU/FilmicTM/" + resolution, [imageSize, numPixels, numThreads](BenchmarkState& state) {
+                CPUPostProcessing postProcessing{ numThreads };
+                auto color = CreateColorImage(imageSize);
+                FilmicTMParameters params{ 0.15f, 0.5f, 0.1f, 0.2f, 0.02f, 0.3f, 11.2f, 2.0f };
+                while (state.KeepRunning()) postProcessing.ApplyFilmicTonemapping(color, params);
+                state.SetItemsProcessed(numPixels);
+            });
+
+            suite.Add("CPU/DepthOfField/" + resolution, [imageSize, numPixels, numThreads](BenchmarkState& state) {
+                CPUDepthOfField dof{ numThreads };
+                auto aspectRatio = static_cast<float>(imageSize.x) / static_cast<float>(imageSize.y);
+                auto projection = glm::perspective(glm::radians(60.0f), aspectRatio, NEAR_PLANE, FAR_PLANE);
+                auto color = CreateColorImage(imageSize);
+                auto depth = CreateDepthImage(imageSize, projection);
+                DOFParams params{ 12.0f, 0.034f, 1.6f, 1.5f, 10.0f, 7, glm::pi<float>() / 3.0f };
+                while (state.KeepRunning()) dof.ApplyEffect(params, projection, color, depth);
+                state.SetItemsProcessed(numPixels);
+            });
+        }
+    }
+}
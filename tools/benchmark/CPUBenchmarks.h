@@ -0,0 +1,16 @@
+/**
+ * @file   CPUBenchmarks.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the benchmarks of the CPU post-processing effects.
+ */
+
+#pragma once
+
+namespace viscom::enh {
+
+    class BenchmarkSuite;
+
+    void AddCPUBenchmarks(BenchmarkSuite& suite, unsigned int numThreads = 0);
+}
@@ -0,0 +1,210 @@
+/**
+ * @file   GLBenchmarks.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of the benchmarks of the enh OpenGL classes.
+ */
+
+#include "GLBenchmarks.h"
+#include "benchmark_suite.h"
+#include "core/gfx/FrameBuffer.h"
+#include "enh/ApplicationNodeBase.h"
+#include "enh/gfx/gl/GLBuffer.h"
+#include "enh/gfx/gl/GLTexture.h"
+#include "enh/gfx/mesh/SimpleMeshRenderer.h"
+#include "enh/gfx/postprocessing/BloomEffect.h"
+#include "enh/gfx/postprocessing/DepthOfField.h"
+#include "enh/gfx/postprocessing/FilmicTMOperator.h"
+#include <array>
+#include <cmath>
+#include <string>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace viscom::enh {
+
+    namespace {
+        /** The size of the benchmarked textures. */
+        constexpr unsigned int TEXTURE_SIZE = 2048;
+        /** The size of the benchmarked buffers. */
+        constexpr std::size_t BUFFER_SIZE = 16 * 1024 * 1024;
+        /** The numbers of meshes drawn by the draw submission benchmarks. */
+        constexpr std::array<std::size_t, 3> MESH_COUNTS{ 1000, 10000, 100000 };
+        /** The size of the cube the meshes are distributed in. */
+        constexpr float MESH_GRID_EXTENT = 10.0f;
+        /** The size of the render targets of the effects. */
+        const glm::uvec2 RENDER_TARGET_SIZE{ 1920, 1080 };
+
+        void AddTextureBenchmarks(BenchmarkSuite& suite, const std::string& name, const TextureDescriptor& descriptor)
+        {
+            auto dataSize = static_cast<std::size_t>(TEXTURE_SIZE) * TEXTURE_SIZE * descriptor.bytesPP_;
+
+            suite.Add("Texture/Upload/" + name, [descriptor, dataSize](BenchmarkState& state) {
+                GLTexture texture{ TEXTURE_SIZE, TEXTURE_SIZE, descriptor, nullptr };
+                std::vector<std::uint8_t> data(dataSize, 0x40);
+                while (state.KeepRunning()) texture.SetData(data.data());
+                state.SetBytesProcessed(dataSize);
+            }, true);
+
+            suite.Add("Texture/Download/" + name, [descriptor, dataSize](BenchmarkState& state) {
+                GLTexture texture{ TEXTURE_SIZE, TEXTURE_SIZE, descriptor, nullptr };
+                std::vector<std::uint8_t> data;
+                while (state.KeepRunning()) texture.DownloadData(data);
+                state.SetBytesProcessed(dataSize);
+            }, true);
+        }
+
+        /**
+         *  Returns the model matrices of a grid of meshes in front of the camera, the grid keeps its size so more
+         *  meshes are smaller.
+         *  @param meshCount the number of meshes, the last layer of the grid is filled partially.
+         */
+        std::vector<glm::mat4> GetMeshGrid(std::size_t meshCount)
+        {
+            auto gridSize = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(meshCount)) - 1e-6));
+            auto spacing = MESH_GRID_EXTENT / static_cast<float>(gridSize);
+            auto gridOrigin = glm::vec3(-0.5f * MESH_GRID_EXTENT, -0.5f * MESH_GRID_EXTENT, -20.0f - 0.5f * MESH_GRID_EXTENT) + glm::vec3(0.5f * spacing);
+
+            std::vector<glm::mat4> modelMatrices;
+            modelMatrices.reserve(meshCount);
+            for (std::size_t i = 0; i < meshCount; ++i) {
+                auto position = gridOrigin + spacing * glm::vec3(i % gridSize, (i / gridSize) % gridSize, i / (gridSize * gridSize));
+                modelMatrices.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(0.3f * spacing)));
+            }
+            return modelMatrices;
+        }
+
+        /** Returns a view projection matrix looking at the mesh grid. */
+        glm::mat4 GetViewProjection()
+        {
+            auto aspectRatio = static_cast<float>(RENDER_TARGET_SIZE.x) / static_cast<float>(RENDER_TARGET_SIZE.y);
+            return glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 100.0f);
+        }
+
+        void AddDrawBenchmarks(BenchmarkSuite& suite, ApplicationNodeBase* app, std::size_t meshCount)
+        {
+            const glm::vec4 color{ 0.8f, 0.4f, 0.2f, 1.0f };
+            const auto countName = "/" + std::to_string(meshCount);
+
+            suite.Add("Draw/SimpleMeshes/Immediate" + countName, [app, color, meshCount](BenchmarkState& state) {
+                auto target = app->GetRenderTargetPool()->Acquire(RENDER_TARGET_SIZE, { gl::GL_RGBA8 });
+                auto modelMatrices = GetMeshGrid(meshCount);
+                auto viewProjection = GetViewProjection();
+                const auto* meshes = app->GetSimpleMeshes();
+                while (state.KeepRunning()) {
+                    target->DrawToFBO([&]() {
+                        for (const auto& modelMatrix : modelMatrices) meshes->DrawCube(viewProjection, modelMatrix, color);
+                    });
+                }
+                state.SetItemsProcessed(modelMatrices.size());
+                app->GetRenderTargetPool()->Release(target);
+            }, true);
+
+            auto addBatchedBenchmark = [&suite, app, color, meshCount, &countName](const std::string& name, SimpleMeshRenderer::BatchMode batchMode) {
+                suite.Add("Draw/SimpleMeshes/" + name + countName, [app, color, meshCount, batchMode](BenchmarkState& state) {
+                    auto target = app->GetRenderTargetPool()->Acquire(RENDER_TARGET_SIZE, { gl::GL_RGBA8 });
+                    auto modelMatrices = GetMeshGrid(meshCount);
+                    auto viewProjection = GetViewProjection();
+                    auto meshes = app->GetSimpleMeshes();
+                    auto previousBatchMode = meshes->GetBatchMode();
+                    meshes->SetBatchMode(batchMode);
+                    while (state.KeepRunning()) {
+                        target->DrawToFBO([&]() {
+                            for (const auto& modelMatrix : modelMatrices) meshes->Submit(SimpleMeshRenderer::Shape::CUBE, modelMatrix, color);
+                            meshes->Flush(viewProjection);
+                        });
+                    }
+                    state.SetItemsProcessed(modelMatrices.size());
+                    meshes->SetBatchMode(previousBatchMode);
+                    app->GetRenderTargetPool()->Release(target);
+                }, true);
+            };
+            addBatchedBenchmark("Instanced", SimpleMeshRenderer::BatchMode::INSTANCED);
+            addBatchedBenchmark("MultiDrawIndirect", SimpleMeshRenderer::BatchMode::MULTI_DRAW_INDIRECT);
+        }
+
+        /** Acquires a render target of the effect size and fills it with a constant. */
+        const FrameBuffer* AcquireFilledTarget(ApplicationNodeBase* app, gl::GLenum format, const glm::vec4& value)
+        {
+            auto target = app->GetRenderTargetPool()->Acquire(RENDER_TARGET_SIZE, { format });
+            gl::glClearTexImage(target->GetTextures()[0], 0, gl::GL_RGBA, gl::GL_FLOAT, &value);
+            return target;
+        }
+
+        void AddEffectBenchmarks(BenchmarkSuite& suite, ApplicationNodeBase* app, const CameraHelper* camera)
+        {
+            auto addBloomBenchmark = [&suite, app](const std::string& name, BloomPipeline pipeline) {
+                suite.Add("Effect/Bloom/" + name, [app, pipeline](BenchmarkState& state) {
+                    BloomEffect bloom{ app };
+                    bloom.SetPipeline(pipeline);
+                    auto source = AcquireFilledTarget(app, gl::GL_RGBA32F, glm::vec4(2.0f));
+                    auto target = app->GetRenderTargetPool()->Acquire(RENDER_TARGET_SIZE, { gl::GL_RGBA32F });
+                    while (state.KeepRunning()) bloom.ApplyEffect(source->GetTextures()[0], target);
+                    app->GetRenderTargetPool()->Release(target);
+                    app->GetRenderTargetPool()->Release(source);
+                }, true);
+            };
+            addBloomBenchmark("Fragment", BloomPipeline::FRAGMENT);
+            addBloomBenchmark("Compute", BloomPipeline::COMPUTE);
+            addBloomBenchmark("DualFilter", BloomPipeline::DUAL_FILTER);
+
+            suite.Add("Effect/FilmicTM", [app](BenchmarkState& state) {
+                FilmicTMOperator tonemapping{ app };
+                auto source = AcquireFilledTarget(app, gl::GL_RGBA32F, glm::vec4(2.0f));
+                auto target = app->GetRenderTargetPool()->Acquire(RENDER_TARGET_SIZE, { gl::GL_RGBA8 });
+                while (state.KeepRunning()) tonemapping.ApplyTonemapping(source->GetTextures()[0], target);
+                app->GetRenderTargetPool()->Release(target);
+                app->GetRenderTargetPool()->Release(source);
+            }, true);
+
+            if (!camera) return;
+            suite.Add("Effect/DepthOfField", [app, camera](BenchmarkState& state) {
+                DepthOfField dof{ app };
+                auto color = AcquireFilledTarget(app, gl::GL_RGBA32F, glm::vec4(2.0f));
+                auto depth = AcquireFilledTarget(app, gl::GL_R32F, glm::vec4(0.5f));
+                auto target = app->GetRenderTargetPool()->Acquire(RENDER_TARGET_SIZE, { gl::GL_RGBA32F });
+                while (state.KeepRunning()) dof.ApplyEffect(*camera, color->GetTextures()[0], depth->GetTextures()[0], target);
+                app->GetRenderTargetPool()->Release(target);
+                app->GetRenderTargetPool()->Release(depth);
+                app->GetRenderTargetPool()->Release(color);
+            }, true);
+        }
+    }
+
+    /**
+     *  Adds benchmarks of texture and buffer transfers, mesh draw submission and the post-processing effects. The
+     *  effect benchmarks report the CPU time of an effect as CPU time and the time until the GPU finished as real time.
+     *  Mesh submission is measured for 1k, 10k and 100k meshes drawn one by one, instanced and with indirect draws;
+     *  with the GL call statistics the results contain the GL calls per iteration to compare the submission paths.
+     *  @param suite the suite to add the benchmarks to.
+     *  @param app the application node providing the context, the shared meshes and the render target pool.
+     *  @param camera the camera used for depth of field, the benchmark is skipped without one.
+     */
+    void AddGLBenchmarks(BenchmarkSuite& suite, ApplicationNodeBase* app, const CameraHelper* camera)
+    {
+        suite.SetContext("gl_renderer", reinterpret_cast<const char*>(gl::glGetString(gl::GL_RENDERER)));
+        suite.SetContext("gl_version", reinterpret_cast<const char*>(gl::glGetString(gl::GL_VERSION)));
+
+        AddTextureBenchmarks(suite, "RGBA8", TextureDescriptor{ 4, gl::GL_RGBA8, gl::GL_RGBA, gl::GL_UNSIGNED_BYTE });
+        AddTextureBenchmarks(suite, "RGBA32F", TextureDescriptor{ 16, gl::GL_RGBA32F, gl::GL_RGBA, gl::GL_FLOAT });
+
+        suite.Add("Buffer/Upload", [](BenchmarkState& state) {
+            GLBuffer buffer{ gl::GL_STREAM_DRAW };
+            std::vector<std::uint8_t> data(BUFFER_SIZE, 0x40);
+            buffer.InitializeData(data);
+            while (state.KeepRunning()) buffer.UploadData(0, data);
+            state.SetBytesProcessed(data.size());
+        }, true);
+
+        suite.Add("Buffer/Download", [](BenchmarkState& state) {
+            GLBuffer buffer{ gl::GL_STREAM_READ };
+            std::vector<std::uint8_t> data(BUFFER_SIZE, 0x40);
+            buffer.InitializeData(data);
+            while (state.KeepRunning()) buffer.DownloadData(data);
+            state.SetBytesProcessed(data.size());
+        }, true);
+
+        for (auto meshCount : MESH_COUNTS) AddDrawBenchmarks(suite, app, meshCount);
+        AddEffectBenchmarks(suite, app, camera);
+    }
+}
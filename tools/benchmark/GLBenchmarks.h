@@ -0,0 +1,21 @@
+/**
+ * @file   GLBenchmarks.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of the benchmarks of the enh OpenGL classes.
+ */
+
+#pragma once
+
+namespace viscom {
+    class CameraHelper;
+}
+
+namespace viscom::enh {
+
+    class ApplicationNodeBase;
+    class BenchmarkSuite;
+
+    void AddGLBenchmarks(BenchmarkSuite& suite, ApplicationNodeBase* app, const CameraHelper* camera = nullptr);
+}
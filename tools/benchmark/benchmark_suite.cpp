@@ -0,0 +1,150 @@
+/**
+ * @file   benchmark_suite.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of a small benchmark runner writing JSON results.
+ */
+
+#include "benchmark_suite.h"
+#include "enh/core/json_helper.h"
+#include "enh/gfx/gl/GLCallStatistics.h"
+#include "core/main.h"
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <glbinding/gl/gl.h>
+
+namespace viscom::enh {
+
+    namespace {
+        /** Returns the number of GL calls made so far, always 0 without the GL call statistics. */
+        std::uint64_t GetNumGLCalls()
+        {
+#ifdef ENABLE_GL_CALL_STATISTICS
+            return GLCallStatistics::Get().GetNumCalls();
+#else
+            return 0;
+#endif
+        }
+    }
+
+    /**
+     *  Ends the last iteration and decides whether to run another one.
+     *  @return whether the measured code should be run again.
+     */
+    bool BenchmarkState::KeepRunning()
+    {
+        if (started_) {
+            auto submitted = std::chrono::steady_clock::now();
+            // the synchronization is not counted as a call of the benchmark.
+            auto submittedGLCalls = GetNumGLCalls();
+            auto finished = submitted;
+            if (syncGPU_) {
+                gl::glFinish();
+                finished = std::chrono::steady_clock::now();
+            }
+
+            if (warmUp_) warmUp_ = false;
+            else {
+                iterations_ += 1;
+                cpuTime_ += submitted - iterationStart_;
+                realTime_ += finished - iterationStart_;
+                glCalls_ += submittedGLCalls - iterationStartGLCalls_;
+                if (realTime_ >= minTime_ || iterations_ >= maxIterations_) return false;
+            }
+        }
+        else if (syncGPU_) gl::glFinish();
+
+        started_ = true;
+        iterationStartGLCalls_ = GetNumGLCalls();
+        iterationStart_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    /**
+     *  Registers a benchmark.
+     *  @param name the name, use '/' to group benchmarks (e.g. "Texture/Upload/RGBA8").
+     *  @param function the benchmark looping over BenchmarkState::KeepRunning().
+     *  @param syncGPU whether the GPU is synchronized after each iteration.
+     */
+    void BenchmarkSuite::Add(const std::string& name, BenchmarkFunction function, bool syncGPU)
+    {
+        benchmarks_.push_back(Benchmark{ name, std::move(function), syncGPU });
+    }
+
+    /**
+     *  Runs the benchmarks.
+     *  @param filter only benchmarks whose name contains the filter are run.
+     */
+    const std::vector<BenchmarkSuite::Result>& BenchmarkSuite::Run(const std::string& filter)
+    {
+        results_.clear();
+        for (const auto& benchmark : benchmarks_) {
+            if (benchmark.name_.find(filter) == std::string::npos) continue;
+
+            BenchmarkState state{ benchmark.syncGPU_, minTime_, MAX_ITERATIONS };
+            benchmark.function_(state);
+            if (state.GetIterations() == 0) {
+                LOG(WARNING) << "Benchmark " << benchmark.name_ << " did not run any iterations.";
+                continue;
+            }
+
+            auto iterations = static_cast<double>(state.GetIterations());
+            auto realTime = state.GetRealTime().count();
+            Result result{ benchmark.name_, state.GetIterations(), state.GetCPUTime().count() / iterations * 1e9, realTime / iterations * 1e9,
+                realTime > 0.0 ? static_cast<double>(state.GetBytesProcessed()) * iterations / realTime : 0.0,
+                realTime > 0.0 ? static_cast<double>(state.GetItemsProcessed()) * iterations / realTime : 0.0, -1.0 };
+#ifdef ENABLE_GL_CALL_STATISTICS
+            if (benchmark.syncGPU_) result.glCalls_ = static_cast<double>(state.GetGLCalls()) / iterations;
+#endif
+            LOG(INFO) << "Benchmark " << result.name_ << ": " << result.realTime_ << " ns (CPU " << result.cpuTime_ << " ns), "
+                << result.iterations_ << " iterations.";
+            if (result.glCalls_ >= 0.0) LOG(INFO) << "    " << result.glCalls_ << " GL calls per iteration.";
+            results_.push_back(result);
+        }
+        return results_;
+    }
+
+    /**
+     *  Writes the results of the last run in the JSON format of Google Benchmark.
+     *  @param filename the file to write.
+     *  @return whether the file was written.
+     */
+    bool BenchmarkSuite::WriteJSON(const std::string& filename) const
+    {
+        std::ofstream jsonFile(filename);
+        if (!jsonFile) {
+            LOG(WARNING) << "Could not write benchmark results to " << filename << ".";
+            return false;
+        }
+
+        auto time = std::time(nullptr);
+        jsonFile << "{\n  \"context\": {\n    \"date\": ";
+        jsonFile << '"' << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S") << '"';
+        for (const auto& [key, value] : context_) {
+            jsonFile << ",\n    ";
+            WriteJSONString(jsonFile, key);
+            jsonFile << ": ";
+            WriteJSONString(jsonFile, value);
+        }
+        jsonFile << "\n  },\n  \"benchmarks\": [";
+
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const auto& result = results_[i];
+            jsonFile << (i == 0 ? "\n" : ",\n") << "    {\n      \"name\": ";
+            WriteJSONString(jsonFile, result.name_);
+            jsonFile << ",\n      \"run_name\": ";
+            WriteJSONString(jsonFile, result.name_);
+            jsonFile << ",\n      \"run_type\": \"iteration\",\n      \"iterations\": " << result.iterations_
+                << ",\n      \"real_time\": " << result.realTime_ << ",\n      \"cpu_time\": " << result.cpuTime_
+                << ",\n      \"time_unit\": \"ns\"";
+            if (result.bytesPerSecond_ > 0.0) jsonFile << ",\n      \"bytes_per_second\": " << result.bytesPerSecond_;
+            if (result.itemsPerSecond_ > 0.0) jsonFile << ",\n      \"items_per_second\": " << result.itemsPerSecond_;
+            if (result.glCalls_ >= 0.0) jsonFile << ",\n      \"gl_calls\": " << result.glCalls_;
+            jsonFile << "\n    }";
+        }
+        jsonFile << "\n  ]\n}\n";
+        return true;
+    }
+}
@@ -0,0 +1,142 @@
+/**
+ * @file   benchmark_suite.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of a small benchmark runner writing JSON results.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace viscom::enh {
+
+    /**
+     * @brief  The state passed to a benchmark, the measured code runs in a loop over KeepRunning().
+     *
+     *  The first iteration is a warm up and not measured. Iterations run until the minimum time is reached. For GPU
+     *  benchmarks glFinish() is called after each iteration: the CPU time is the time until the commands were
+     *  submitted, the real time the time until the GPU finished them. With the GL call statistics
+     *  (ENABLE_GL_CALL_STATISTICS) the GL calls of the measured iterations are counted as well.
+     */
+    class BenchmarkState
+    {
+    public:
+        BenchmarkState(bool syncGPU, std::chrono::duration<double> minTime, std::size_t maxIterations) :
+            syncGPU_{ syncGPU }, minTime_{ minTime }, maxIterations_{ maxIterations } {}
+
+        bool KeepRunning();
+        /** Sets the bytes processed per iteration for computing the bandwidth. */
+        void SetBytesProcessed(std::size_t bytes) { bytesProcessed_ = bytes; }
+        /** Sets the items processed per iteration for computing the throughput. */
+        void SetItemsProcessed(std::size_t items) { itemsProcessed_ = items; }
+
+        std::size_t GetIterations() const { return iterations_; }
+        std::chrono::duration<double> GetCPUTime() const { return cpuTime_; }
+        std::chrono::duration<double> GetRealTime() const { return realTime_; }
+        std::size_t GetBytesProcessed() const { return bytesProcessed_; }
+        std::size_t GetItemsProcessed() const { return itemsProcessed_; }
+        /** Returns the GL calls of the measured iterations, 0 without the GL call statistics. */
+        std::uint64_t GetGLCalls() const { return glCalls_; }
+
+    private:
+        /** Holds whether the GPU is synchronized after each iteration. */
+        bool syncGPU_;
+        /** Holds the minimum time to run. */
+        std::chrono::duration<double> minTime_;
+        /** Holds the maximum number of iterations. */
+        std::size_t maxIterations_;
+        /** Holds whether the loop started. */
+        bool started_ = false;
+        /** Holds whether the current iteration is the warm up. */
+        bool warmUp_ = true;
+        /** Holds the start of the current iteration. */
+        std::chrono::steady_clock::time_point iterationStart_;
+        /** Holds the number of measured iterations. */
+        std::size_t iterations_ = 0;
+        /** Holds the CPU time of the measured iterations. */
+        std::chrono::duration<double> cpuTime_{ 0.0 };
+        /** Holds the real time of the measured iterations. */
+        std::chrono::duration<double> realTime_{ 0.0 };
+        /** Holds the bytes processed per iteration. */
+        std::size_t bytesProcessed_ = 0;
+        /** Holds the items processed per iteration. */
+        std::size_t itemsProcessed_ = 0;
+        /** Holds the number of GL calls made before the current iteration. */
+        std::uint64_t iterationStartGLCalls_ = 0;
+        /** Holds the GL calls of the measured iterations. */
+        std::uint64_t glCalls_ = 0;
+    };
+
+    /**
+     * @brief  Runs registered benchmarks and writes the results as JSON.
+     *
+     *  The JSON follows the format of Google Benchmark, so its compare tools can be used for regression tracking.
+     *  Benchmarks using OpenGL need a current context, the suite does not create one: it runs inside an application
+     *  node or in the headless benchmark tool (enh_benchmark), which makes a surfaceless EGL context current.
+     */
+    class BenchmarkSuite
+    {
+    public:
+        using BenchmarkFunction = std::function<void(BenchmarkState&)>;
+
+        /** The result of a benchmark, times are per iteration. */
+        struct Result
+        {
+            /** Holds the name of the benchmark. */
+            std::string name_;
+            /** Holds the number of measured iterations. */
+            std::size_t iterations_;
+            /** Holds the CPU time in nanoseconds. */
+            double cpuTime_;
+            /** Holds the real time in nanoseconds. */
+            double realTime_;
+            /** Holds the bytes processed per second (real time) or 0. */
+            double bytesPerSecond_;
+            /** Holds the items processed per second (real time) or 0. */
+            double itemsPerSecond_;
+            /** Holds the GL calls per iteration, negative if they were not counted. */
+            double glCalls_;
+        };
+
+        void Add(const std::string& name, BenchmarkFunction function, bool syncGPU = false);
+        /** Sets the minimum time each benchmark runs. */
+        void SetMinTime(std::chrono::duration<double> minTime) { minTime_ = minTime; }
+        /** Adds information on the environment written to the results (e.g. the GL renderer). */
+        void SetContext(const std::string& key, const std::string& value) { context_.emplace_back(key, value); }
+
+        const std::vector<Result>& Run(const std::string& filter = "");
+        const std::vector<Result>& GetResults() const { return results_; }
+        bool WriteJSON(const std::string& filename) const;
+
+    private:
+        /** A registered benchmark. */
+        struct Benchmark
+        {
+            /** Holds the name. */
+            std::string name_;
+            /** Holds the function. */
+            BenchmarkFunction function_;
+            /** Holds whether the GPU is synchronized after each iteration. */
+            bool syncGPU_;
+        };
+
+        /** The maximum number of iterations of a benchmark. */
+        static constexpr std::size_t MAX_ITERATIONS = 1000000;
+
+        /** Holds the benchmarks. */
+        std::vector<Benchmark> benchmarks_;
+        /** Holds the results of the last run. */
+        std::vector<Result> results_;
+        /** Holds the context information. */
+        std::vector<std::pair<std::string, std::string>> context_;
+        /** Holds the minimum time each benchmark runs. */
+        std::chrono::duration<double> minTime_{ 0.5 };
+    };
+}
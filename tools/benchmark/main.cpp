@@ -0,0 +1,82 @@
+/**
+ * @file   main.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Runs the benchmark suite of the enh classes without a window.
+ */
+
+#include "CPUBenchmarks.h"
+#include "GLBenchmarks.h"
+#include "HeadlessGLContext.h"
+#include "benchmark_suite.h"
+#include "core/main.h"
+#include "enh/ApplicationNodeBase.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Stands in for the application node, the enh classes only need its OpenGL resources.
+     *
+     *  There is no core node behind it, so the simple meshes are generated and UpdateFrame() must not be called.
+     */
+    class BenchmarkNode final : public ApplicationNodeBase
+    {
+    public:
+        BenchmarkNode() : ApplicationNodeBase{ nullptr, true } {}
+    };
+}
+
+namespace {
+
+    void PrintUsage()
+    {
+        std::cout << "Usage: enh_benchmark [--out <file>] [--filter <name>] [--min-time <seconds>] [--threads <n>]\n"
+            << "  --out       the JSON file to write (default: enh_benchmark.json)\n"
+            << "  --filter    only run benchmarks whose name contains the filter\n"
+            << "  --min-time  the minimum time each benchmark runs (default: 0.5)\n"
+            << "  --threads   the threads used by the CPU effects (default: 0, all hardware threads)\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string outputFile = "enh_benchmark.json", filter;
+    auto minTime = 0.5;
+    unsigned int numThreads = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--help" || i + 1 == argc) {
+            PrintUsage();
+            return argument == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+        if (argument == "--out") outputFile = value;
+        else if (argument == "--filter") filter = value;
+        else if (argument == "--min-time") minTime = std::stod(value);
+        else if (argument == "--threads") numThreads = static_cast<unsigned int>(std::stoul(value));
+        else {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        viscom::enh::HeadlessGLContext context;
+        viscom::enh::BenchmarkNode node;
+
+        viscom::enh::BenchmarkSuite suite;
+        suite.SetMinTime(std::chrono::duration<double>{ minTime });
+        // there is no camera without the core, so depth of field is only benchmarked on the CPU.
+        viscom::enh::AddGLBenchmarks(suite, &node);
+        viscom::enh::AddCPUBenchmarks(suite, numThreads);
+        suite.Run(filter);
+        return suite.WriteJSON(outputFile) ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
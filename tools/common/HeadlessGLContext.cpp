@@ -0,0 +1,68 @@
+/**
+ * @file   HeadlessGLContext.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Implementation of an OpenGL context without a window for the command line tools.
+ */
+
+#include "HeadlessGLContext.h"
+#include "core/main.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace viscom::enh {
+
+    namespace {
+
+        /** Returns the surfaceless display of Mesa or the default display if the platform is not supported. */
+        EGLDisplay GetHeadlessDisplay()
+        {
+            auto clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+            if (clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+                auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+                if (getPlatformDisplay) return getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+            return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+    }
+
+    /**
+     *  Creates the context and makes it current.
+     *  @param majorVersion the major OpenGL version requested.
+     *  @param minorVersion the minor OpenGL version requested.
+     */
+    HeadlessGLContext::HeadlessGLContext(int majorVersion, int minorVersion)
+    {
+        auto display = GetHeadlessDisplay();
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+            LOG(FATAL) << "Could not initialize an EGL display (error 0x" << std::hex << eglGetError() << ").";
+            throw std::runtime_error("Could not initialize an EGL display.");
+        }
+        display_ = display;
+
+        // a context without a config needs EGL_KHR_no_config_context, surfaceless rendering EGL_KHR_surfaceless_context.
+        std::array<EGLint, 7> contextAttributes{ EGL_CONTEXT_MAJOR_VERSION, majorVersion, EGL_CONTEXT_MINOR_VERSION, minorVersion,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+        EGLContext context = EGL_NO_CONTEXT;
+        if (eglBindAPI(EGL_OPENGL_API)) context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes.data());
+        if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+            LOG(FATAL) << "Could not create an OpenGL " << majorVersion << "." << minorVersion << " context without a surface (error 0x"
+                << std::hex << eglGetError() << ").";
+            if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+            eglTerminate(display);
+            throw std::runtime_error("Could not create a headless OpenGL context.");
+        }
+        context_ = context;
+    }
+
+    HeadlessGLContext::~HeadlessGLContext()
+    {
+        eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display_, context_);
+        eglTerminate(display_);
+    }
+}
@@ -0,0 +1,34 @@
+/**
+ * @file   HeadlessGLContext.h
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Declaration of an OpenGL context without a window for the command line tools.
+ */
+
+#pragma once
+
+namespace viscom::enh {
+
+    /**
+     * @brief  Creates an OpenGL core profile context with EGL and makes it current, no window or display is needed.
+     *
+     *  The Mesa surfaceless platform (EGL_MESA_platform_surfaceless) is used when available, otherwise the default
+     *  display. The context has no default framebuffer, so everything is rendered into framebuffer objects. It stays
+     *  current on the creating thread until it is destroyed.
+     */
+    class HeadlessGLContext final
+    {
+    public:
+        explicit HeadlessGLContext(int majorVersion = 4, int minorVersion = 5);
+        HeadlessGLContext(const HeadlessGLContext&) = delete;
+        HeadlessGLContext& operator=(const HeadlessGLContext&) = delete;
+        ~HeadlessGLContext();
+
+    private:
+        /** Holds the EGL display. */
+        void* display_ = nullptr;
+        /** Holds the EGL context. */
+        void* context_ = nullptr;
+    };
+}
@@ -0,0 +1,82 @@
+/**
+ * @file   main.cpp
+ * @author Sebastian Maisch <sebastian.maisch@uni-ulm.de>
+ * @date   2026.10.19
+ *
+ * @brief  Replays a capture of GLCommandCapture without a window and reports its timings.
+ */
+
+#include "HeadlessGLContext.h"
+#include "core/main.h"
+#include "enh/main.h"
+#include "enh/gfx/gl/GLCommandCapture.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <glbinding/Binding.h>
+
+namespace {
+
+    void PrintUsage()
+    {
+        std::cout << "Usage: enh_replay <capture> [--iterations <n>] [--width <pixels>] [--height <pixels>]\n"
+            << "  --iterations  the number of measured replays (default: 100)\n"
+            << "  --width       the width of the frame buffer replacing the window (default: 1920)\n"
+            << "  --height      the height of the frame buffer replacing the window (default: 1080)\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || std::string(argv[1]) == "--help") {
+        PrintUsage();
+        return argc < 2 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    std::string captureFile = argv[1];
+    std::size_t iterations = 100;
+    gl::GLsizei width = 1920, height = 1080;
+    for (int i = 2; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (i + 1 == argc) {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+        if (argument == "--iterations") iterations = std::stoul(value);
+        else if (argument == "--width") width = std::stoi(value);
+        else if (argument == "--height") height = std::stoi(value);
+        else {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        viscom::enh::HeadlessGLContext context;
+        glbinding::Binding::initialize();
+
+        // the context has no window, the capture draws to this frame buffer instead.
+        viscom::enh::FramebufferRAII framebuffer;
+        viscom::enh::RenderbufferRAII colorBuffer, depthStencilBuffer;
+        gl::glBindRenderbuffer(gl::GL_RENDERBUFFER, colorBuffer);
+        gl::glRenderbufferStorage(gl::GL_RENDERBUFFER, gl::GL_RGBA8, width, height);
+        gl::glBindRenderbuffer(gl::GL_RENDERBUFFER, depthStencilBuffer);
+        gl::glRenderbufferStorage(gl::GL_RENDERBUFFER, gl::GL_DEPTH24_STENCIL8, width, height);
+        gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, framebuffer);
+        gl::glFramebufferRenderbuffer(gl::GL_FRAMEBUFFER, gl::GL_COLOR_ATTACHMENT0, gl::GL_RENDERBUFFER, colorBuffer);
+        gl::glFramebufferRenderbuffer(gl::GL_FRAMEBUFFER, gl::GL_DEPTH_STENCIL_ATTACHMENT, gl::GL_RENDERBUFFER, depthStencilBuffer);
+        gl::glViewport(0, 0, width, height);
+
+        viscom::enh::GLCommandReplay replay{ captureFile };
+        replay.SetDefaultFramebuffer(framebuffer);
+        auto result = replay.Benchmark(iterations);
+        std::cout << captureFile << ": " << replay.GetNumCommands() << " commands, " << iterations << " iterations\n"
+            << "  CPU time:   " << result.cpuTime_.count() << " ms\n"
+            << "  total time: " << result.totalTime_.count() << " ms" << std::endl;
+        return EXIT_SUCCESS;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}